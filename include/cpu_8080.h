@@ -12,20 +12,23 @@
 #include <inttypes.h>
 #include "memory_8080.h"
 
+// Only the interpreter's accessors count, the other engines' direct
+// window accesses would leave the dump near empty
+#if defined(MEM_HEAT) && (defined(ENGINE_THREADED) || defined(ENGINE_BLOCK) || defined(ENGINE_JIT) || defined(ENGINE_AOT))
+#error "MEM_HEAT=1 needs ENGINE=interp"
+#endif
+
 /** GCC header for unused variables Werror bypass */ 
 #define UNUSED __attribute__((unused))
 
-/**
- * @brief program_status_word: An exdended PSW for easy checks and
- * sets of PSW without flagging. 
- */
-typedef struct {
-    uint8_t carry;  /**< Status of the `carry` bit in PSW */
-    uint8_t aux;    /**< Status of the `auxiliary carry` bit in PSW */
-    uint8_t sign;   /**< Status of the `sign` bit in PSW (1 if -ve) */
-    uint8_t zero;   /**< Status of the `zero` bit in PSW (1 if 0) */
-    uint8_t parity; /**< Status of the `parity` bit in PSW (1 if num of 1 even) */
-} program_status_word;
+#define CPU_CLOCK_HZ        2000000     /** 8080 clock, 2MHz as in invaders */
+#define FRAME_RATE          60          /** Display refresh rate in Hz */
+/** Clock cycles in one display frame */
+#define CYCLES_PER_FRAME    (CPU_CLOCK_HZ / FRAME_RATE)
+/** Extra cycles a conditional CALL takes when the call is made */
+#define CCON_TAKEN_CYCLES   6
+/** Extra cycles a conditional RET takes when the return is made */
+#define RCON_TAKEN_CYCLES   6
 
 /**
  * @brief ENUMS for PSW_FLAGS
@@ -40,6 +43,103 @@ typedef enum {
 } flag_bits;
 /** @brief All but the aux flag options */
 # define ALL_BUT_AUX_FLAG (SIGN_FLAG | ZERO_FLAG | PARITY_FLAG | CARRY_FLAG)
+/** @brief Flags which are derived from the result byte */
+# define SZP_FLAGS (SIGN_FLAG | ZERO_FLAG | PARITY_FLAG)
+/** @brief szp_res marker, the low bits hold explicit SZP_FLAGS (POP PSW) */
+# define SZP_EXPLICIT 0x100
+
+/**
+ * @brief program_status_word: A lazily evaluated PSW. Instead of
+ * the flags, ALU ops record the result and operands they were derived
+ * from, and the psw_* accessors work a flag out only when it's read.
+ * Use the accessors, the fields are an implementation detail.
+ */
+typedef struct {
+    uint16_t szp_res;   /**< Result byte S, Z and P come from, or SZP_EXPLICIT | flags */
+    uint16_t cy_res;    /**< Result whose bit 8 is the `carry` bit */
+    uint8_t aux_a;      /**< `auxiliary carry` is the carry out of bit 3 */
+    uint8_t aux_b;      /**< of aux_a + aux_b */
+} program_status_word;
+
+/** S, Z and P flags for every szp_res, defined in cpu_8080.c */
+extern const uint8_t szp_flag_lookup[0x200];
+
+///@{
+/** daa_lookup index and entry bits above the A byte */
+#define DAA_CARRY   0x100
+#define DAA_AUX     0x200
+///@}
+/** DAA for every A | DAA_CARRY | DAA_AUX going in: the adjusted A, and
+ * DAA_CARRY, DAA_AUX for the flags coming out. Defined in cpu_8080.c */
+extern const uint16_t daa_lookup[0x400];
+
+///@{
+/** Lazy flag reads, 1 if the flag is set */
+static inline uint8_t psw_carry(const program_status_word* psw){
+    return (psw->cy_res >> 8) & 1;
+}
+static inline uint8_t psw_aux(const program_status_word* psw){
+    return ((psw->aux_a ^ psw->aux_b ^ (uint8_t)(psw->aux_a + psw->aux_b)) >> 4) & 1;
+}
+static inline uint8_t psw_sign(const program_status_word* psw){
+    return szp_flag_lookup[psw->szp_res & 0x1FF] & SIGN_FLAG ? 1 : 0;
+}
+static inline uint8_t psw_zero(const program_status_word* psw){
+    return szp_flag_lookup[psw->szp_res & 0x1FF] & ZERO_FLAG ? 1 : 0;
+}
+static inline uint8_t psw_parity(const program_status_word* psw){
+    return szp_flag_lookup[psw->szp_res & 0x1FF] & PARITY_FLAG ? 1 : 0;
+}
+///@}
+
+///@{
+/** Flag writes, these only record state, nothing is worked out here */
+static inline void psw_set_szp(program_status_word* psw, uint8_t result){
+    psw->szp_res = result;
+}
+static inline void psw_set_cy_res(program_status_word* psw, uint16_t result){
+    psw->cy_res = result;
+}
+static inline void psw_set_carry(program_status_word* psw, uint8_t carry){
+    psw->cy_res = carry ? 0x100 : 0;
+}
+/** aux carry as set by base + diff, see aux_flag_set_add */
+static inline void psw_set_aux_add(program_status_word* psw, uint8_t base, uint8_t diff){
+    psw->aux_a = base;
+    psw->aux_b = diff;
+}
+static inline void psw_set_aux(program_status_word* psw, uint8_t aux){
+    psw->aux_a = psw->aux_b = aux ? 0x08 : 0;
+}
+///@}
+
+/**
+ * @brief Compress program_status_word into a uint8_t as per
+ * flag_bits
+ * 
+ * @param psw 
+ * @return uint8_t 
+ */
+static inline uint8_t compress_PSW(program_status_word psw){
+    return szp_flag_lookup[psw.szp_res & 0x1FF] |
+           (psw_carry(&psw) << 7) |     // CARRY_FLAG
+           (psw_aux(&psw) << 3);        // AUX_FLAG
+}
+
+/**
+ * @brief Inflate the uint8_t into a program_status_word by using
+ * flag_bits as the mapping
+ * 
+ * @param status 
+ * @return program_status_word 
+ */
+static inline program_status_word decompress_PSW(uint8_t status){
+    program_status_word new_status;
+    new_status.szp_res = SZP_EXPLICIT | (status & SZP_FLAGS);
+    psw_set_carry(&new_status, status & CARRY_FLAG);
+    psw_set_aux(&new_status, status & AUX_FLAG);
+    return new_status;
+}
 
 /**
  * @brief different condition checks for JMP, conditional OPS
@@ -56,14 +156,24 @@ typedef enum {
     M_check     = 0x7, /**< minus(Sign = 1) */
 } condition_flags;
 
+///@{
+/** Slots of cpu_state.reg. Pairs keep their low byte first, so the slot
+ * is the 8080 register code with its low bit flipped */
+#define REG_SLOT(code)  ((code) ^ 1)
+typedef enum {
+    SLOT_C, SLOT_B, SLOT_E, SLOT_D, SLOT_L, SLOT_H, SLOT_A, SLOT_M,
+} reg_slot;
+///@}
+
 /**
  * @brief cpu_state: This structure keeps runtime state of all the
  * registers in the CPU.
  */
 typedef struct {
     ///@{
-    /** General Purpose Registers in CPU */
+    /** General Purpose Registers in CPU, a flat register file */
     union{
+        uint8_t reg[8];     /**< Registers by REG_SLOT of their DDD/SSS code */
         struct {
             uint8_t C;      /**< Register 1, Pair B */
             uint8_t B;      /**< Register 0, Pair B */
@@ -71,7 +181,10 @@ typedef struct {
             uint8_t D;      /**< Register 2, Pair D */
             uint8_t L;      /**< Register 5, Pair H */
             uint8_t H;      /**< Register 4, Pair H */
+            uint8_t ACC;    /**< Register 7 */
+            uint8_t M_SLOT; /**< Register 6, where cpu_reg_read stages the byte at HL when reading M */
         };
+        uint16_t pair[3];   /**< Register pairs by their RP code, B, D and H */
         struct {
             uint16_t BC;    /**< Extended Reg Pair BC */
             uint16_t DE;    /**< Extended Reg Pair DE */
@@ -79,8 +192,6 @@ typedef struct {
         };
     };
     ///@}
-    // TODO: Add The memory ref reg 6!?
-    uint8_t ACC;                /**< Register 7 */
     program_status_word PSW;    /**< Program Status Word */
 
     ///@{
@@ -88,7 +199,9 @@ typedef struct {
     uint16_t SP;    /**< Stack Pointer */
     uint16_t PC;    /**< Program Counter */
     uint8_t intt;   /**< Interrupt status Reg */ //(Don't know if works)
-    uint8_t pend_intt; /**< Pending Interrupts */
+    /** Pending Interrupts. Only raised between run_cycles slices, the
+     * engines take them at a slice's start or right after an EI */
+    uint8_t pend_intt;
     ///@}
 
     ///@{
@@ -102,9 +215,59 @@ typedef struct {
     v_memory mem; /**< mem pointer, points to vMemeory chunck */
     uint16_t rom_size; /**< Size of the ROM currenlty loaded */
     uint8_t halt; /**< the cpu is halted */
+    uint64_t cycles; /**< Clock cycles executed since init */
+    uint64_t instructions; /**< Instructions executed since init */
+    /** Of instructions, the ones charged without being run one by one:
+     * idle_skip and loop_skip passes and hle_call routines */
+    uint64_t skipped_instructions;
+    void* engine_state; /**< Engine private state (e.g. block cache), NULL until used */
+    void* lockstep_state; /**< `make LOCKSTEP=1` builds: the interpreter shadowing this cpu, NULL until used */
     ///@}
+
+    ///@{
+    /** Idle loop fast forwarding, see idle_skip */
+    uint64_t idle_cycles; /**< Of cycles, the ones charged for skipped idle loop passes */
+    uint32_t idle_reject; /**< 0x10000 | the last loop head found not to idle */
+    uint16_t idle_head; /**< Loop head idle_misses counts at */
+    uint8_t idle_misses; /**< Passes at idle_head which changed the registers */
+    ///@}
+
+    ///@{
+    /** High level emulation of ROM routines, see hle_enable */
+    uint8_t hle_mask; /**< HLE_* routines run natively, 0 until hle_enable */
+    uint64_t hle_cycles; /**< Of cycles, the ones charged for routines run natively */
+    ///@}
+
+    /** Of cycles, the ones charged for loop idiom passes done in bulk, see loop_skip */
+    uint64_t loop_cycles;
 } cpu_state;
 
+///@{
+/**
+ * @brief Register file access by 8080 register code (0 B .. 5 L, 6 M,
+ * 7 A). Reading M stages the byte at HL in the M slot, so every code
+ * ends in the same indexed load; only M touches memory. Writes to M go
+ * to memory.
+ */
+static inline uint8_t cpu_reg_read(cpu_state* cpu, uint8_t code){
+    if(code == 6){
+        cpu->M_SLOT = mem_read(&cpu->mem, cpu->HL);
+    }
+    return cpu->reg[REG_SLOT(code)];
+}
+static inline void cpu_reg_write(cpu_state* cpu, uint8_t code, uint8_t val){
+    if(code == 6){
+        mem_write(&cpu->mem, cpu->HL, val);
+    } else {
+        cpu->reg[REG_SLOT(code)] = val;
+    }
+}
+/** Pairs by RP code (0 BC, 1 DE, 2 HL, 3 SP) */
+static inline uint16_t cpu_pair_read(const cpu_state* cpu, uint8_t rp){
+    return rp == 3 ? cpu->SP : cpu->pair[rp];
+}
+///@}
+
 /**
  * 
  * @brief Initialize a new cpu_8080 instance structure. Everything is initialized to 0.
@@ -116,19 +279,122 @@ typedef struct {
  * @return cpu_state* Pointer to the Malloced CPU state.
  * @note 
  * - the user is responsible for freeing the memory (for the CPU) once it's done
- * - expects base to be initialized by the user to a 64KB aligned memory
+ * - expects mem to be set up by the user, with mem_init or mem_map_flat
  * @return cpu_state* 
  */
 cpu_state* init_cpu_8080(uint16_t pc, uint8_t (*in_cb)(uint8_t), void (*out_cb)(uint8_t, uint8_t));
 
+/**
+ * @brief Frees a cpu from init_cpu_8080 along with any engine state.
+ * The memory behind mem is the user's and is left alone, see mem_free.
+ * 
+ * @param cpu 
+ */
+void free_cpu_8080(cpu_state* cpu);
+
+///@{
+/** Invaders ROM routines hle_enable can run natively, by entry point */
+#define HLE_DRAW_SHIFTED    0x01    /**< 0x1400 DrawShiftedSprite */
+#define HLE_ERASE_SIMPLE    0x02    /**< 0x1424 EraseSimpleSprite */
+#define HLE_DRAW_SIMPLE     0x04    /**< 0x1439 DrawSimpleSprite */
+#define HLE_ERASE_SHIFTED   0x08    /**< 0x1452 EraseShifted */
+#define HLE_DRAW_COLLIDE    0x10    /**< 0x1491 DrawSprCollision */
+#define HLE_CLEAR_SMALL     0x20    /**< 0x14CB ClearSmallSprite */
+#define HLE_BLOCK_COPY      0x40    /**< 0x1A32 BlockCopy */
+#define HLE_CLEAR_SCREEN    0x80    /**< 0x1A5C ClearScreen */
+#define HLE_ALL             0xFF
+///@}
+
+/**
+ * @brief Has calls into the routines in mask run as native C with the
+ * same memory writes, IO, registers, flags, cycles and instruction
+ * counts, if guest memory holds the invaders ROM it was written against
+ * (checked by hash). Only builds with `make HLE=1` look at it. Call once
+ * the ROM is loaded.
+ * 
+ * @param cpu 
+ * @param mask HLE_* routines to enable
+ * @return uint8_t the routines enabled, 0 if the ROM isn't the one
+ */
+uint8_t hle_enable(cpu_state* cpu, uint8_t mask);
+
+#ifdef MEM_HASH
+/**
+ * @brief O(1) fingerprint of the machine's state between instructions:
+ * the registers, flags, interrupt state and mem_hash. Equal states,
+ * whatever their history, fingerprint the same; the cycle and
+ * instruction counts aren't part of it.
+ *
+ * @param cpu
+ * @return uint64_t
+ */
+uint64_t cpu_fingerprint(cpu_state* cpu);
+#endif
+
+/**
+ * @brief Drops anything the engine decoded out of guest memory, and
+ * the memory hash (see mem_hash). Writes through
+ * mem_write/short_mem_write are tracked, this is for memory changed
+ * behind the cpu's back (e.g. reloading a ROM image).
+ * 
+ * @param cpu 
+ */
+void flush_code_cache(cpu_state* cpu);
+
 /**
  * @brief Executes the instruction pc is pointing to after incrementing it.
+ * The clock cycles it took are charged to cpu->cycles.
  * 
  * @param cpu 
- * @return int 
+ * @return int 1 of success, -1 if fail
  */
 int exec_inst(cpu_state* cpu);
 
+/**
+ * @brief Executes instructions until at least budget clock cycles have
+ * been charged. The last instruction may overshoot the budget, callers
+ * keeping a fixed timeline should compute the budget off cpu->cycles.
+ * 
+ * @param cpu 
+ * @param budget clock cycles to run for
+ * @return int 1 if the budget was used up, 0 if the cpu halted, -1 if fail
+ */
+int run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief Name of the execution engine backing run_cycles, as
+ * picked at build time.
+ * 
+ * @return const char* 
+ */
+const char* engine_name();
+
+/**
+ * @brief Executes one display frame worth (CYCLES_PER_FRAME) of cycles.
+ * 
+ * @param cpu 
+ * @return int same as run_cycles
+ */
+int run_frame(cpu_state* cpu);
+
+/**
+ * @brief Number of clock cycles an opcode takes to complete, as
+ * listed in the opcode lookup table.
+ * 
+ * @param op_code 
+ * @return uint8_t cycle count
+ */
+uint8_t opcode_cycles(uint8_t op_code);
+
+/**
+ * @brief Size of an opcode in bytes [1,3], as listed in the
+ * opcode lookup table.
+ * 
+ * @param op_code 
+ * @return uint8_t instruction length
+ */
+uint8_t opcode_size(uint8_t op_code);
+
 /**
  * @brief Recompile mode.
  * 
@@ -159,6 +425,6 @@ uint8_t io_machine_IN(uint8_t port);
  * 
  * @param cpu 
  */
-void print_state(const cpu_state cpu);
+void print_state(cpu_state cpu);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,336 @@
+/**
+ * @file engine_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Alternative execution engines which can back run_cycles. The
+ * engine is picked at build time, `make ENGINE=<name>`, the default being
+ * the opcode_lookup interpreter in cpu_8080.c.
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ */
+#ifndef ENGINE_8080_H
+#define ENGINE_8080_H
+
+#include <stddef.h>
+#include <inttypes.h>
+#include "cpu_8080.h"
+
+/**
+ * @brief An opcode_lookup handler, called as (cpu, base_PC, op_code)
+ * with cpu->PC already past the instruction and its cycles charged.
+ */
+typedef int (*opcode_handler)(cpu_state* cpu, uint16_t base_PC, uint8_t op_code);
+
+/**
+ * @brief The opcode_lookup handler of an opcode, for engines which
+ * fall back to the interpreter for some instructions.
+ * 
+ * @param op_code 
+ * @return opcode_handler 
+ */
+opcode_handler opcode_func(uint8_t op_code);
+
+/**
+ * @brief Whether an opcode can leave straight line code (jumps, calls,
+ * returns, RST, HLT). IO and EI count too, interrupts are checked after
+ * them. Engines working in blocks end one at such an opcode.
+ * 
+ * @param op_code 
+ * @return uint8_t 1 if a block ends after op_code
+ */
+uint8_t opcode_ends_block(uint8_t op_code);
+
+/** pair_profile's previous opcode when there is none */
+#define PAIR_NONE   0x100
+
+/**
+ * @brief Writes the opcode pair counts the interpreter collected, built
+ * with `make PROFILE_PAIRS=1`, one "first second count" line per pair
+ * (hex opcodes) most frequent first. fuse_8080 picks the fused ops off it.
+ * 
+ * @param path file to write
+ * @return int 0 on success, -1 on failure or when not profiling
+ */
+int pair_profile_dump(const char* path);
+
+/**
+ * @brief Clears the collected opcode pair counts
+ */
+void pair_profile_reset();
+
+/**
+ * @brief The reference engine, exec_inst's step over opcode_lookup in a
+ * loop. Always built, `ENGINE=interp`.
+ * 
+ * @param cpu 
+ * @param budget clock cycles to run for
+ * @return int 1 if the budget was used up, 0 if the cpu halted, -1 if fail
+ */
+int interp_run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief The engine picked at build time, which run_cycles runs unless
+ * a `LOCKSTEP=1` build checks it against the interpreter
+ * 
+ * @param cpu 
+ * @param budget clock cycles to run for
+ * @return int as run_cycles
+ */
+int engine_run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief Threaded (computed goto) engine, `ENGINE=threaded`.
+ * Same contract as run_cycles.
+ * 
+ * @param cpu 
+ * @param budget clock cycles to run for
+ * @return int 1 if the budget was used up, 0 if the cpu halted, -1 if fail
+ */
+int threaded_run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief Block cache engine, `ENGINE=block`. Runs predecoded straight
+ * line blocks, kept in cpu->engine_state. Same contract as run_cycles.
+ * 
+ * @param cpu 
+ * @param budget clock cycles to run for
+ * @return int 1 if the budget was used up, 0 if the cpu halted, -1 if fail
+ */
+int block_run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief Drops every cached block of the cpu, see flush_code_cache
+ * 
+ * @param cpu 
+ */
+void block_cache_flush(cpu_state* cpu);
+
+/**
+ * @brief Releases the cpu's block cache and unhooks it from memory
+ * 
+ * @param cpu 
+ */
+void block_cache_free(cpu_state* cpu);
+
+/**
+ * @brief Version of the block engine's code cache records, along with
+ * the decode rules and fused pairs they depend on, see pcache_8080.h
+ * 
+ * @return uint64_t 
+ */
+uint64_t block_cache_key();
+
+/**
+ * @brief Writes the cpu's live blocks lying below code_end as code cache
+ * records, handlers stored by index
+ * 
+ * @param cpu 
+ * @param out where to write, NULL to only size them
+ * @param code_end first address past the ROM
+ * @param count records written
+ * @return size_t bytes written
+ */
+size_t block_cache_save(cpu_state* cpu, uint8_t* out, uint32_t code_end, uint32_t* count);
+
+/**
+ * @brief Puts the blocks of block_cache_save's records back into the
+ * cpu's cache, ready to run
+ * 
+ * @param cpu 
+ * @param in records
+ * @param size bytes of records
+ * @param count records
+ * @return uint8_t 1 if all were taken, 0 if they don't add up (some may
+ * be cached already)
+ */
+uint8_t block_cache_load(cpu_state* cpu, const uint8_t* in, size_t size, uint32_t count);
+
+/**
+ * @brief x86-64 dynamic recompiler, `ENGINE=jit`. Hot blocks are
+ * translated into host code kept in cpu->engine_state, cold code runs on
+ * exec_inst. Other hosts get interp_run_cycles. Same contract as
+ * run_cycles.
+ * 
+ * @param cpu 
+ * @param budget clock cycles to run for
+ * @return int 1 if the budget was used up, 0 if the cpu halted, -1 if fail
+ */
+int jit_run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief Drops every translated block of the cpu, see flush_code_cache
+ * 
+ * @param cpu 
+ */
+void jit_cache_flush(cpu_state* cpu);
+
+/**
+ * @brief Releases the cpu's translation cache and unhooks it from memory
+ * 
+ * @param cpu 
+ */
+void jit_cache_free(cpu_state* cpu);
+
+/**
+ * @brief Version of the JIT's code cache records and the block
+ * boundaries they depend on, see pcache_8080.h
+ * 
+ * @return uint64_t 
+ */
+uint64_t jit_cache_key();
+
+/**
+ * @brief Writes the guest start of each live translated block lying
+ * below code_end as a code cache record. Host code holds absolute
+ * addresses, the blocks are translated again on load.
+ * 
+ * @param cpu 
+ * @param out where to write, NULL to only size them
+ * @param code_end first address past the ROM
+ * @param count records written
+ * @return size_t bytes written
+ */
+size_t jit_cache_save(cpu_state* cpu, uint8_t* out, uint32_t code_end, uint32_t* count);
+
+/**
+ * @brief Translates the blocks of jit_cache_save's records straight
+ * away, rather than after JIT_HOT_RUNS runs through the dispatcher
+ * 
+ * @param cpu 
+ * @param in records
+ * @param size bytes of records
+ * @param count records
+ * @return uint8_t 1 if all were taken (or the code buffer filled up), 0
+ * if they don't add up
+ */
+uint8_t jit_cache_load(cpu_state* cpu, const uint8_t* in, size_t size, uint32_t count);
+
+/** Furthest a jump may go back and still be tried as an idle loop */
+#define IDLE_MAX_BYTES  16
+
+/**
+ * @brief Whether an opcode only touches registers, flags and PC: no
+ * stores, stack, IO or interrupt state. Idle loops are made of these.
+ * 
+ * @param op_code 
+ * @return uint8_t non zero if pure
+ */
+uint8_t idle_op_pure(uint8_t op_code);
+
+/**
+ * @brief Called with cpu->PC just jumped back to a loop head. If one pass
+ * of the loop is pure and leaves the cpu as it was, nothing but an
+ * interrupt can get it out, so the whole passes left before target are
+ * charged to cycles, instructions and idle_cycles without running them.
+ * Heads which didn't pan out are remembered in idle_reject, callers skip
+ * the call for it.
+ * 
+ * @param cpu 
+ * @param branch address of the jump that came back
+ * @param target cycle count the running slice ends at
+ */
+void idle_skip(cpu_state* cpu, uint16_t branch, uint64_t target);
+
+/**
+ * @brief Called by idle_skip with cpu->PC just jumped back to a loop
+ * head. If the loop is a block copy, fill or compare (see loop_8080.c)
+ * the passes that fit before target, less the one dropping out, are
+ * done as one host memmove/memset/scan and the last of them is stepped
+ * on the cpu, so registers, flags, memory, cycles and instructions come
+ * out as if every pass had run. Stores which would land on the loop or
+ * on watched code pages are left to the guest code.
+ * 
+ * @param cpu 
+ * @param branch address of the jump that came back
+ * @param target cycle count the running slice ends at
+ * @return int 1 if the loop is an idiom, whether or not any pass could
+ * be skipped, 0 if it isn't
+ */
+int loop_skip(cpu_state* cpu, uint16_t branch, uint64_t target);
+
+///@{
+/** hle_call only knows routines with entries in this range */
+#define HLE_FIRST   0x1400
+#define HLE_LAST    0x1A5C
+///@}
+
+/**
+ * @brief Cheap filter for hle_call, whether pc may be the entry of a
+ * routine hle_enable turned on
+ * 
+ * @param cpu 
+ * @param pc 
+ * @return uint8_t non zero if worth calling hle_call
+ */
+static inline uint8_t hle_hit(const cpu_state* cpu, uint16_t pc){
+    return cpu->hle_mask && (uint16_t)(pc - HLE_FIRST) <= HLE_LAST - HLE_FIRST;
+}
+
+/**
+ * @brief Called with cpu->PC on a routine entry, reached by a CALL or a
+ * tail JMP, and the return address on the stack. Runs the routine natively through to its RET, or as many of
+ * its loop passes as finish before target with PC left on the loop head
+ * for the guest code to go on from. Declines routines not enabled, whose
+ * code was overwritten, or whose set up doesn't fit before target. Any
+ * other way in is fine too, the routine is run from whatever state the
+ * cpu is in.
+ * Built with HLE_VERIFY, the guest code runs too and has to agree.
+ * 
+ * @param cpu 
+ * @param target cycle count the running slice ends at
+ * @return int 1 if it ran, 0 if declined
+ */
+int hle_call(cpu_state* cpu, uint64_t target);
+
+/**
+ * @brief Ahead of time engine, `ENGINE=aot`. Runs aot_exec while guest
+ * memory holds the ROM it was generated from, exec_inst otherwise. Same
+ * contract as run_cycles.
+ * 
+ * @param cpu 
+ * @param budget clock cycles to run for
+ * @return int 1 if the budget was used up, 0 if the cpu halted, -1 if fail
+ */
+int aot_run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief Has the next aot_run_cycles compare guest memory with the
+ * translated ROM again, see flush_code_cache
+ * 
+ * @param cpu 
+ */
+void aot_cache_flush(cpu_state* cpu);
+
+/**
+ * @brief Releases the cpu's aot state and unhooks it from memory
+ * 
+ * @param cpu 
+ */
+void aot_cache_free(cpu_state* cpu);
+
+/**
+ * @brief Why aot_exec handed the cpu back
+ */
+typedef enum {
+    AOT_LEAVE,          /**< Budget, HLT, an intt or code it has no translation for */
+    AOT_ROM_WRITTEN,    /**< The guest wrote into the translated ROM */
+} aot_status;
+
+///@{
+/** The ROM image aot_exec was generated from, by aot_8080 */
+extern const uint32_t aot_rom_size;
+extern const uint8_t aot_rom_image[];
+///@}
+
+/**
+ * @brief Generated by aot_8080, runs translated blocks from cpu->PC until
+ * it reaches one it has no translation for, or one which may not finish
+ * before target. Only valid while memory holds aot_rom_image.
+ * 
+ * @param cpu 
+ * @param target cycle count to stop at
+ * @return int an aot_status
+ */
+int aot_exec(cpu_state* cpu, uint64_t target);
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file fused_ops_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Generated by fuse_8080 (`make fuse`), do not edit. The most
+ * frequent opcode pairs of the profiled run, which the block engine
+ * runs as one superinstruction.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef FUSED_OPS_8080_H
+#define FUSED_OPS_8080_H
+
+/**
+ * @brief X-macro over the fused pairs, X(first, second, first body,
+ * second body) with the bodies as in OPCODE_BODIES. The trailing count
+ * is how often the pair ran in the profile.
+ */
+#define FUSED_OPS(X)                                                            \
+    X(A7, C2, ANA(GET_A); NEXT(1), JCON(NZ_COND))        /*      2607775 */ \
+    X(3A, A7, LDA(), ANA(GET_A); NEXT(1))                /*      2385144 */ \
+    X(3D, C2, DCR(A), JCON(NZ_COND))                     /*      2330708 */ \
+    X(3A, 3D, LDA(), DCR(A))                             /*      2329585 */ \
+    X(05, C2, DCR(B), JCON(NZ_COND))                     /*       763590 */ \
+    X(7E, A7, MOV(A, M), ANA(GET_A); NEXT(1))            /*       616903 */ \
+    X(23, 05, INX(HL), DCR(B))                           /*       593335 */ \
+    X(A7, CA, ANA(GET_A); NEXT(1), JCON(Z_COND))         /*       349792 */ \
+
+#endif
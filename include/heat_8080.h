@@ -0,0 +1,82 @@
+/**
+ * @file heat_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Guest memory access heatmap for `make MEM_HEAT=1` builds. The
+ * interpreter's mem_read/mem_write family counts every read, write and
+ * instruction byte fetched per guest address into a heat_map set on
+ * v_memory, and heat_frame appends the frame's counts to a dump which
+ * heatmap_8080 renders. Other builds carry none of it.
+ *
+ * The dump is little endian: "HEAT8080", a u32 version, a u32 frame
+ * count, then per frame a u32 record count and the records, each a u16
+ * address, a u8 mask of the HEAT_ kinds counted and one LEB128 count per
+ * kind in the mask. Only the addresses touched in the frame have one.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef HEAT_8080_H
+#define HEAT_8080_H
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#define HEAT_READ       0           /** Data read */
+#define HEAT_WRITE      1           /** Data written */
+#define HEAT_EXEC       2           /** Fetched as an opcode or its operands */
+#define HEAT_KINDS      3
+#define HEAT_ADDRS      0x10000
+#define HEAT_MAGIC      "HEAT8080"
+#define HEAT_VERSION    1
+
+/**
+ * @brief Counts of the frame under way, and where they go
+ */
+typedef struct {
+    uint32_t counts[HEAT_ADDRS][HEAT_KINDS];
+    uint16_t touched[HEAT_ADDRS];   /**< Addresses counted this frame, in first touch order */
+    uint32_t touched_count;
+    uint32_t frames;                /**< Frames written */
+    FILE* out;
+} heat_map;
+
+/**
+ * @brief Counts an access
+ *
+ * @param heat
+ * @param addr guest address
+ * @param kind HEAT_READ, HEAT_WRITE or HEAT_EXEC
+ */
+static inline void heat_hit(heat_map* heat, uint16_t addr, uint8_t kind){
+    uint32_t* counts = heat->counts[addr];
+    if(!(counts[HEAT_READ] | counts[HEAT_WRITE] | counts[HEAT_EXEC])){
+        heat->touched[heat->touched_count++] = addr;
+    }
+    counts[kind]++;
+}
+
+/**
+ * @brief Starts a dump at path
+ *
+ * @param path
+ * @return heat_map* NULL if it can't be written or out of memory
+ */
+heat_map* heat_open(const char* path);
+
+/**
+ * @brief Appends the frame's counts to the dump and starts the next
+ *
+ * @param heat
+ */
+void heat_frame(heat_map* heat);
+
+/**
+ * @brief Appends what's left as a last frame, finishes the dump and
+ * frees heat
+ *
+ * @param heat
+ * @return int 0 on success, -1 if the dump couldn't be written
+ */
+int heat_close(heat_map* heat);
+
+#endif
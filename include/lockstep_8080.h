@@ -0,0 +1,53 @@
+/**
+ * @file lockstep_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Lockstep validation of the fast paths. `make LOCKSTEP=1` builds
+ * route run_cycles through lockstep_run_cycles, which runs the engine
+ * and, on a shadow copy of the cpu and its memory, the plain exec_inst
+ * interpreter (no idle skipping, loop idioms nor HLE) over the same
+ * cycles, feeding it the engine's IN results. The two are compared at
+ * the end of every run_cycles slice, or every LOCKSTEP_CYCLES if set,
+ * and the first difference is reported with the interpreter's last
+ * instructions.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef LOCKSTEP_8080_H
+#define LOCKSTEP_8080_H
+
+#include <inttypes.h>
+#include "cpu_8080.h"
+
+#ifndef LOCKSTEP_CYCLES
+/** Longest stretch run between checks, 0 to only check where run_cycles returns */
+#define LOCKSTEP_CYCLES 0
+#endif
+
+/**
+ * @brief run_cycles with the check. The shadow is made off the cpu on
+ * the first call.
+ *
+ * @param cpu
+ * @param budget clock cycles to run for
+ * @return int as run_cycles, -1 as well if the engine and the
+ * interpreter parted ways (reported on stderr)
+ */
+int lockstep_run_cycles(cpu_state* cpu, uint32_t budget);
+
+/**
+ * @brief Copies the cpu and its memory into its shadow again, for
+ * changes made behind the cpu's back (flush_code_cache calls it)
+ *
+ * @param cpu
+ */
+void lockstep_sync(cpu_state* cpu);
+
+/**
+ * @brief Releases the cpu's shadow, if any
+ *
+ * @param cpu
+ */
+void lockstep_free(cpu_state* cpu);
+
+#endif
@@ -1,73 +1,438 @@
 /**
  * @file memory_8080.h
  * @author Pranay Garg (pranayga@andrew.cmu.edu)
- * @brief Memory abstraction for 8080 cpu.
+ * @brief Memory abstraction for 8080 cpu. Guest memory is a 64KB
+ * window of host memory, seen through a table of 256 pages. Each entry
+ * is the host address of the page's 256 bytes with MEM_ flags in the
+ * low bits: ROM pages drop writes, mirrors show another page's bytes
+ * and MMIO pages call the machine's handlers. Ordinary RAM and ROM
+ * pages take one table load on the inline fast paths below.
  * @version 0.1
  * @date 2020-12-24
- * 
+ *
  */
 #ifndef MEMORY_8080_H
 #define MEMORY_8080_H
 
 #include <inttypes.h>
+#include "heat_8080.h"
+
+#define MEM_SIZE        0x10000     /** Guest address space */
+#define MEM_PAGES       0x100       /** Pages of MEM_PAGE_SIZE in it */
+#define MEM_PAGE_SIZE   0x100
+
+///@{
+/** Page flags, kept in the low bits of the page table's entries */
+#define MEM_RO          0x01    /** Writes are dropped */
+#define MEM_MMIO        0x02    /** Reads and writes go to mmio_read/mmio_write */
+#define MEM_MIRROR      0x04    /** The host bytes are another page's */
+#define MEM_UNALIASED   0x08    /** A mirror the window couldn't alias, base | offset isn't it */
+#ifdef MEM_HASH
+#define MEM_HASHED      0x10    /** Every page of `make MEM_HASH=1` builds, stores go through mem_write_slow */
+#else
+#define MEM_HASHED      0x00
+#endif
+#define MEM_WATCH       0x20    /** watch_pages flags the page, kept in step by mem_watch_set/mem_watch_sync */
+#define MEM_FLAGS       0xFF
+#define MEM_STORE_TRAP  (MEM_RO | MEM_MMIO | MEM_HASHED)
+#define MEM_WRITE_TRAP  (MEM_STORE_TRAP | MEM_WATCH)
+///@}
 
 /**
  * @brief Memory wrapper
- * 
+ *
  */
 typedef struct {
-    void* base; /**< Base virtual memory, 64KB aligned */
+    void* base; /**< Base virtual memory, the 64KB aligned window */
+    uintptr_t pages[MEM_PAGES]; /**< Host address of each page | its MEM_ flags */
+    /** 1 while base | offset reaches what the page table does for
+     * every page, none of them MMIO. The engines addressing the window
+     * directly need it, and check MEM_WRITE_TRAP before storing, or
+     * MEM_STORE_TRAP if they look after the watch themselves. */
+    uint8_t direct;
+    int fd; /**< memfd behind a mem_init window, -1 for a caller's block */
+    ///@{
+    /** File shown read only from page file_first, see mem_map_file */
+    int file_fd;
+    uint8_t file_first;
+    uint16_t file_pages;
+    ///@}
+    ///@{
+    /** MMIO page handlers, for pages mapped MEM_MMIO */
+    uint8_t (*mmio_read)(void* ctx, uint16_t offset);
+    void (*mmio_write)(void* ctx, uint16_t offset, uint8_t val);
+    void* mmio_ctx;
+    ///@}
+    ///@{
+    /** Optional write watch, engines caching decoded code use it to
+     * hear about writes into code. Set with mem_watch_set. */
+    const uint8_t* watch_pages;                     /**< 256 flags, non zero if the 256 byte page is watched */
+    void (*watch_hit)(void* ctx, uint16_t offset);  /**< Called after a write into a watched page */
+    void* watch_ctx;                                /**< Passed back to watch_hit */
+    ///@}
+#ifdef MEM_HASH
+    ///@{
+    /** `make MEM_HASH=1` builds: XOR of mem_mix(address, byte) over the
+     * memory, the address a page's bytes are keyed by being its home
+     * page's so mirrors don't count twice. Stores keep it up to date,
+     * see mem_hash. */
+    uint64_t hash;
+    uint8_t hash_stale;         /**< hash needs a full recompute */
+    uint8_t home[MEM_PAGES];    /**< Page whose addresses key each page's bytes */
+    ///@}
+#endif
+#ifdef MEM_HEAT
+    heat_map* heat;             /**< `make MEM_HEAT=1` builds: accesses are counted into it, if set */
+#endif
 } v_memory;
 
+/**
+ * @brief Maps a fresh zeroed 64KB window at mem->base, backed by a
+ * memfd so mirrors can alias their pages in it, flat (every page its
+ * own RAM). The byte after the window aliases address 0, so 16 bit
+ * accesses at 0xFFFF wrap like the 8080's.
+ *
+ * @param mem
+ * @return uint8_t 1 on success, 0 if out of memory
+ */
+uint8_t mem_init(v_memory* mem);
+
+/**
+ * @brief Unmaps a mem_init window
+ *
+ * @param mem
+ */
+void mem_free(v_memory* mem);
+
+/**
+ * @brief Maps the caller's 64KB aligned block flat at mem->base. Its
+ * mirrors can't be aliased in the window, so they get MEM_UNALIASED.
+ *
+ * @param mem
+ * @param base
+ */
+void mem_map_flat(v_memory* mem, void* base);
+
+/**
+ * @brief Sets mem up without a window of its own, for running many
+ * small machines: every page reads as 0 and drops writes until
+ * mem_map_host points it somewhere. The pages are MEM_UNALIASED, so the
+ * engines leave it to the interpreter. Builds shadowing the window
+ * (`make LOCKSTEP=1`, `HLE_VERIFY=1`) need mem_init instead.
+ *
+ * @param mem
+ */
+void mem_init_compact(v_memory* mem);
+
+/**
+ * @brief Points count pages from first at the caller's count * 256
+ * bytes, with flags. Bytes shared between several mems (a ROM image)
+ * should be mapped MEM_RO. Mirrors of the pages are mapped the usual
+ * way, with mem_map_mirror.
+ *
+ * @param mem set up by mem_init_compact
+ * @param first page
+ * @param count pages
+ * @param bytes aligned to MEM_PAGE_SIZE, the flags go in the low bits
+ * @param flags MEM_RO, MEM_MMIO or 0 for plain RAM
+ */
+void mem_map_host(v_memory* mem, uint8_t first, uint16_t count, uint8_t* bytes, uint8_t flags);
+
+/**
+ * @brief Maps size bytes of the file at page first of a mem_init
+ * window, read only and shared: every process mapping the same file
+ * shares one copy of those pages in the page cache. The pages are
+ * MEM_RO for good, and mirrors of them alias the file too. The fd is
+ * duplicated, the caller keeps its own.
+ *
+ * @param mem
+ * @param first page, on a host page
+ * @param fd
+ * @param size bytes, whole host pages
+ * @return uint8_t 1 if mapped, 0 if it can't be (copy the file in instead)
+ */
+uint8_t mem_map_file(v_memory* mem, uint8_t first, int fd, uint32_t size);
+
+/**
+ * @brief Sets the MEM_RO and MEM_MMIO flags of count pages from first.
+ * Map before running, or call flush_code_cache after.
+ *
+ * @param mem
+ * @param first page
+ * @param count pages
+ * @param flags MEM_RO, MEM_MMIO or 0 for plain RAM
+ */
+void mem_map_flags(v_memory* mem, uint8_t first, uint16_t count, uint8_t flags);
+
+/**
+ * @brief Maps count pages from first as mirrors of the ones from
+ * target, with their flags. On a mem_init window, runs aligned to host
+ * pages are aliased in the window too so base | offset stays coherent.
+ * Map before running, or call flush_code_cache after.
+ *
+ * @param mem
+ * @param first page
+ * @param count pages
+ * @param target page mirrored by first
+ */
+void mem_map_mirror(v_memory* mem, uint8_t first, uint16_t count, uint8_t target);
+
+/**
+ * @brief Gives dst's window the layout of src's: the same flags,
+ * mirrors and MMIO handlers. The bytes aren't copied.
+ *
+ * @param dst
+ * @param src
+ */
+void mem_map_copy(v_memory* dst, const v_memory* src);
+
+/**
+ * @brief Whether none of count bytes from offset are on pages with any
+ * of flags, and their host bytes are contiguous so mem_ref can be used
+ * in bulk (pass MEM_MIRROR | MEM_MMIO at least for that).
+ *
+ * @param mem
+ * @param offset
+ * @param count bytes, not wrapping past 0xFFFF
+ * @param flags MEM_ flags
+ * @return uint8_t 1 if so
+ */
+uint8_t mem_plain(const v_memory* mem, uint16_t offset, uint32_t count, uint8_t flags);
+
+///@{
+/** Slow paths of the accessors below, for flagged pages and 16 bit
+ * accesses straddling two pages */
+uint8_t mem_read_slow(v_memory* mem, uint16_t offset);
+uint16_t short_mem_read_slow(v_memory* mem, uint16_t offset);
+void mem_write_slow(v_memory* mem, uint16_t offset, uint8_t val);
+void short_mem_write_slow(v_memory* mem, uint16_t offset, uint16_t val);
+///@}
+
+/**
+ * @brief Hooks a write watch up to mem, marking the pages it flags
+ * MEM_WATCH, or unhooks it
+ *
+ * @param mem
+ * @param pages 256 flags, NULL to unhook
+ * @param hit called after a write into a flagged page
+ * @param ctx passed back to hit
+ */
+void mem_watch_set(v_memory* mem, const uint8_t* pages, void (*hit)(void* ctx, uint16_t offset), void* ctx);
+
+/**
+ * @brief Brings MEM_WATCH of count pages from first in line with
+ * watch_pages, after the watcher changed them
+ *
+ * @param mem
+ * @param first
+ * @param count
+ */
+void mem_watch_sync(v_memory* mem, uint8_t first, uint16_t count);
+
+#ifdef MEM_HASH
+/**
+ * @brief Mixes 64 bits into 64 well spread ones (splitmix64's output step)
+ *
+ * @param x
+ * @return uint64_t
+ */
+static inline uint64_t mem_mix(uint64_t x){
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Hash of the memory, kept up to date by the stores so O(1)
+ * unless something was mapped or changed behind mem_write's back since
+ * the last call. `make MEM_HASH_VERIFY=1` builds check it against
+ * mem_hash_full and abort if it's off.
+ *
+ * @param mem
+ * @return uint64_t
+ */
+uint64_t mem_hash(v_memory* mem);
+
+/**
+ * @brief mem_hash worked out from scratch, over every byte
+ *
+ * @param mem
+ * @return uint64_t
+ */
+uint64_t mem_hash_full(const v_memory* mem);
+
+/**
+ * @brief Has the next mem_hash recompute the hash, for bytes changed
+ * behind mem_write's back (memcpy into the window, reading a file in)
+ *
+ * @param mem
+ */
+static inline void mem_hash_reset(v_memory* mem){
+    mem->hash_stale = 1;
+}
+#else
+static inline void mem_hash_reset(v_memory* mem){
+    (void)mem;
+}
+#endif
+
+/**
+ * @brief Counts an access to offset into the heat map, in `make
+ * MEM_HEAT=1` builds which have one set
+ *
+ * @param mem
+ * @param offset
+ * @param kind HEAT_READ, HEAT_WRITE or HEAT_EXEC
+ */
+static inline void mem_heat(v_memory* mem, uint16_t offset, uint8_t kind){
+#ifdef MEM_HEAT
+    if(mem->heat){
+        heat_hit(mem->heat, offset, kind);
+    }
+#else
+    (void)mem;
+    (void)offset;
+    (void)kind;
+#endif
+}
+
+/**
+ * @brief Host address of a page table entry's bytes
+ */
+static inline uint8_t* mem_host(uintptr_t page){
+    return (uint8_t *)(page & ~(uintptr_t)MEM_FLAGS);
+}
+
 /**
  * @brief plain reference to the memory location
- * 
+ *
  * @param offset from the base ptr in bytes
  * @param mem cpu's memeory context under exec
  * @return void*, memory reference to the target location
  */
-void* mem_ref(v_memory* mem, uint16_t offset);
+static inline void* mem_ref(v_memory* mem, uint16_t offset){
+    return mem_host(mem->pages[offset >> 8]) + (offset & 0xFF);
+}
+
+/**
+ * @brief Tells the watcher about a write to offset, if any
+ *
+ * @param mem
+ * @param offset written to
+ */
+static inline void mem_watch(v_memory* mem, uint16_t offset){
+    if(mem->watch_pages && mem->watch_pages[offset >> 8]){
+        mem->watch_hit(mem->watch_ctx, offset);
+    }
+}
 
 /**
- * @brief Lowest level memory read access abstraction. Typecasts
- * the offset to void* + base to get the actual pointer. Return the value
- * 
+ * @brief Lowest level memory read access abstraction. Looks the
+ * offset's page up and reads the byte off its host bytes. Return the value
+ *
  * @param offset from the base ptr in bytes
  * @param mem cpu's memeory context under exec
  * @return uint8_t, byte read from the memory
  */
-uint8_t mem_read(v_memory* mem, uint16_t offset);
+static inline uint8_t mem_read(v_memory* mem, uint16_t offset){
+    mem_heat(mem, offset, HEAT_READ);
+    uintptr_t page = mem->pages[offset >> 8];
+    if(__builtin_expect(page & MEM_MMIO, 0)){
+        return mem_read_slow(mem, offset);
+    }
+    return mem_host(page)[offset & 0xFF];
+}
 
 /**
- * @brief Wrapper over memory access primitives to read a byte off
- * the base offset void* + base. Returns the value
- * 
+ * @brief Wrapper over memory access primitives to read a short off
+ * offset, low byte first. Returns the value
+ *
  * @param offset from the base ptr in bytes
  * @param mem cpu's memeory context under exec
  * @return uint16_t, short read from the memory
  */
-uint16_t short_mem_read(v_memory* mem, uint16_t offset);
+static inline uint16_t short_mem_read(v_memory* mem, uint16_t offset){
+    mem_heat(mem, offset, HEAT_READ);
+    mem_heat(mem, offset + 1, HEAT_READ);
+    uintptr_t page = mem->pages[offset >> 8];
+    if(__builtin_expect((page & MEM_MMIO) || (offset & 0xFF) == 0xFF, 0)){
+        return short_mem_read_slow(mem, offset);
+    }
+    return *(uint16_t *)(mem_host(page) + (offset & 0xFF));
+}
+
+/**
+ * @brief Reads an instruction byte, opcode or operand. The same as
+ * mem_read, but not counted as a data read, step_op counts the whole
+ * instruction as fetched.
+ *
+ * @param mem
+ * @param offset
+ * @return uint8_t
+ */
+static inline uint8_t mem_fetch(v_memory* mem, uint16_t offset){
+    uintptr_t page = mem->pages[offset >> 8];
+    if(__builtin_expect(page & MEM_MMIO, 0)){
+        return mem_read_slow(mem, offset);
+    }
+    return mem_host(page)[offset & 0xFF];
+}
+
+/**
+ * @brief Reads a 16 bit operand, low byte first, see mem_fetch
+ *
+ * @param mem
+ * @param offset
+ * @return uint16_t
+ */
+static inline uint16_t short_mem_fetch(v_memory* mem, uint16_t offset){
+    uintptr_t page = mem->pages[offset >> 8];
+    if(__builtin_expect((page & MEM_MMIO) || (offset & 0xFF) == 0xFF, 0)){
+        return short_mem_read_slow(mem, offset);
+    }
+    return *(uint16_t *)(mem_host(page) + (offset & 0xFF));
+}
 
 /**
- * @brief Lowest level memory write access abstraction. Typecasts
- * the offset to void* + base to get the actual pointer. Populates from
- * val into the memory.
- * 
+ * @brief Lowest level memory write access abstraction. Looks the
+ * offset's page up and populates from val into its host bytes, unless
+ * it's ROM. Watched pages are MEM_WATCH, mem_write_slow reports the
+ * write.
+ *
  * @param offset from the base ptr in bytes
  * @param val to write onto memory
  * @param mem cpu's memeory context under exec
  */
-void mem_write(v_memory* mem, uint16_t offset, uint8_t val);
+static inline void mem_write(v_memory* mem, uint16_t offset, uint8_t val){
+    mem_heat(mem, offset, HEAT_WRITE);
+    uintptr_t page = mem->pages[offset >> 8];
+    if(__builtin_expect(page & MEM_WRITE_TRAP, 0)){
+        mem_write_slow(mem, offset, val);
+        return;
+    }
+    mem_host(page)[offset & 0xFF] = val;
+}
 
 /**
- * @brief Wrapper over memory access primitives to read a byte off
- * the base offset void* + base. Populates from
- * val into the memory.
- * 
+ * @brief Wrapper over memory access primitives to write a short at
+ * offset, low byte first. Populates from
+ * val into the memory. Writes touching a watched page are reported by
+ * short_mem_write_slow.
+ *
  * @param offset from the base ptr in bytes
  * @param val to write onto memory
  * @param mem cpu's memeory context under exec
  */
-void short_mem_write(v_memory* mem, uint16_t offset, uint16_t val);
+static inline void short_mem_write(v_memory* mem, uint16_t offset, uint16_t val){
+    mem_heat(mem, offset, HEAT_WRITE);
+    mem_heat(mem, offset + 1, HEAT_WRITE);
+    uintptr_t page = mem->pages[offset >> 8];
+    if(__builtin_expect((page & MEM_WRITE_TRAP) || (offset & 0xFF) == 0xFF, 0)){
+        short_mem_write_slow(mem, offset, val);
+        return;
+    }
+    *(uint16_t *)(mem_host(page) + (offset & 0xFF)) = val;
+}
 
-#endif
\ No newline at end of file
+#endif
@@ -32,155 +32,81 @@ typedef struct {
     uint8_t size;           /**< Instruction size in bytes */
 } instt_8080_op;
 
-/**
- * @brief The bit pattern designating one of the registers 
- * A,B,C,D,E,H,L (DDD=destination, SSS=source)
- * 111 -> ACC, 000---101 -> B,C,D,E,H,L.
- * This function returns a reference to the bytes which helps
- * simulate the register
- * @param cpu 
- * @param reg_identifier 
- * @return uint8_t* (uint8_t*)-1 if illegal or address otherwise 
- */
-uint8_t* ref_byte_reg(cpu_state* cpu ,uint8_t reg_identifier){
-    switch (reg_identifier)
-    {
-    case 0x0:
-        return &cpu->B;
-    case 0x01:
-        return &cpu->C;
-    case 0x02:
-        return &cpu->D;
-    case 0x03:
-        return &cpu->E;
-    case 0x04:
-        return &cpu->H;
-    case 0x05:
-        return &cpu->L;
-    case 0x06:
-        return (uint8_t *)mem_ref(&cpu->mem, cpu->HL);
-    case 0x07:
-        return &cpu->ACC;
-    default:
-        ILLEGAL_OP; // Will never reach here now.
-        return (uint8_t*)-1;
-    }
-}
-
-/**
- * @brief The bit pattern designating one of the 
- * register pairs B,D,H,SP
- * 00---11 -> B,D,H,SP.
- * This function returns a reference to the short which helps
- * simulate the register
- * @param cpu 
- * @param reg_identifier 
- * @return uint16_t* (uint16_t*)-1 if illegal or address otherwise
- */
-uint16_t* ref_short_reg(cpu_state* cpu ,uint8_t reg_identifier){
-    switch (reg_identifier)
-    {
-    case 0x0:
-        return &cpu->BC;
-    case 0x01:
-        return &cpu->DE;
-    case 0x02:
-        return &cpu->HL;
-    case 0x03:
-        return &cpu->SP;
-    default:
-        return (uint16_t*)-1;
-    }
-}
-
-/**
- * @brief perform condition check on the cpu register state
- * 
- * @param cpu 
- * @param condition_identifier different condition checks for JMP, conditional OPS
- * @return uint8_t 1 if the condition is true, 0 if false
- */
-uint8_t condition_check(cpu_state* cpu, condition_flags condition_identifier){
-    switch (condition_identifier)
-    {
-    case NZ_check:
-        if(!cpu->PSW.zero){
-            return 1;
-        }
-        return 0;
-    case Z_check:
-        if(cpu->PSW.zero){
-            return 1;
-        }
-        return 0;
-    case NC_check:
-        if(!cpu->PSW.carry){
-            return 1;
-        }
-        return 0;
-    case C_check:
-        if(cpu->PSW.carry){
-            return 1;
-        }
-        return 0;
-    case PO_check:
-        if(!cpu->PSW.parity){
-            return 1;
-        }
-        return 0;
-    case PE_check:
-        if(cpu->PSW.parity){
-            return 1;
-        }
-        return 0;
-    case P_check:
-        if(!cpu->PSW.sign){
-            return 1;
-        }
-        return 0;
-    case M_check:
-        if(cpu->PSW.sign){
-            return 1;
-        }
-        return 0;
-    default:
-        DEBUG_PRINT("%s\n", "Unknow Condition Code.");
-        ILLEGAL_OP;
-        exit(-2);
-    }
-}
-
-/**
- * @brief Set the flags PSW status
+///@{
+/**
+ * @brief Operand accessors, one per register field encoding so the
+ * generated handlers below resolve their operands at compile time.
+ * The byte registers follow the DDD/SSS field order
+ * 000---101 -> B,C,D,E,H,L, 110 -> M (*HL), 111 -> ACC.
+ */
+#define READ_B(cpu)         ((cpu)->reg[SLOT_B])
+#define READ_C(cpu)         ((cpu)->reg[SLOT_C])
+#define READ_D(cpu)         ((cpu)->reg[SLOT_D])
+#define READ_E(cpu)         ((cpu)->reg[SLOT_E])
+#define READ_H(cpu)         ((cpu)->reg[SLOT_H])
+#define READ_L(cpu)         ((cpu)->reg[SLOT_L])
+#define READ_M(cpu)         mem_read(&(cpu)->mem, (cpu)->HL)
+#define READ_A(cpu)         ((cpu)->reg[SLOT_A])
+#define WRITE_B(cpu, val)   ((cpu)->reg[SLOT_B] = (val))
+#define WRITE_C(cpu, val)   ((cpu)->reg[SLOT_C] = (val))
+#define WRITE_D(cpu, val)   ((cpu)->reg[SLOT_D] = (val))
+#define WRITE_E(cpu, val)   ((cpu)->reg[SLOT_E] = (val))
+#define WRITE_H(cpu, val)   ((cpu)->reg[SLOT_H] = (val))
+#define WRITE_L(cpu, val)   ((cpu)->reg[SLOT_L] = (val))
+#define WRITE_M(cpu, val)   mem_write(&(cpu)->mem, (cpu)->HL, (val))
+#define WRITE_A(cpu, val)   ((cpu)->reg[SLOT_A] = (val))
+///@}
+
+///@{
+/** Register pairs in RP field order 00---11 -> BC,DE,HL,SP */
+#define PAIR_BC(cpu)        ((cpu)->BC)
+#define PAIR_DE(cpu)        ((cpu)->DE)
+#define PAIR_HL(cpu)        ((cpu)->HL)
+#define PAIR_SP(cpu)        ((cpu)->SP)
+///@}
+
+///@{
+/** Condition checks in CCC field order, see condition_flags */
+#define COND_NZ(cpu)        (!psw_zero(&(cpu)->PSW))
+#define COND_Z(cpu)         (psw_zero(&(cpu)->PSW))
+#define COND_NC(cpu)        (!psw_carry(&(cpu)->PSW))
+#define COND_C(cpu)         (psw_carry(&(cpu)->PSW))
+#define COND_PO(cpu)        (!psw_parity(&(cpu)->PSW))
+#define COND_PE(cpu)        (psw_parity(&(cpu)->PSW))
+#define COND_P(cpu)         (!psw_sign(&(cpu)->PSW))
+#define COND_M(cpu)         (psw_sign(&(cpu)->PSW))
+///@}
+
+///@{
+/** X-macro lists to stamp out one handler per operand */
+#define BYTE_OPERANDS(X)    X(B) X(C) X(D) X(E) X(H) X(L) X(M) X(A)
+#define WORD_OPERANDS(X)    X(BC) X(DE) X(HL) X(SP)
+#define CONDITIONS(X)       X(NZ) X(Z) X(NC) X(C) X(PO) X(PE) X(P) X(M)
+#define RST_VECTORS(X)      X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7)
+///@}
+
+/** Declares a handler with the OP_WRAP signature */
+#define OP_HANDLER(name)    int name(UNUSED cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code)
+
+/**
+ * @brief Set the flags PSW status. Flags are evaluated lazily, this
+ * only records the result they are derived from.
  * 
  * @param cpu 
  * @param final_state the final value
  * @param flags to be set
  */
 void set_flags(cpu_state* cpu ,uint32_t final_state, uint8_t flags){
-    if(flags & SIGN_FLAG){
-        cpu->PSW.sign = (final_state & 0x80) ? 1:0;
-    } 
-    if (flags & ZERO_FLAG){
-        cpu->PSW.zero = (final_state & 0xFF) == 0 ? 1:0;
+    if(flags & SZP_FLAGS){
+        // S, Z and P are always set together off the same byte
+        psw_set_szp(&cpu->PSW, final_state & 0xFF);
     }
     if (flags & AUX_FLAG){
         DEBUG_PRINT("%s\n", "AUX Flag is very specific to operation");
         ILLEGAL_OP;
     }
-    if (flags & PARITY_FLAG){
-        uint8_t pf = 1;
-        // checking only for the fist 8 bytes
-        uint8_t rr = final_state & 0xFF;
-        // using xor to toggle the parity flag
-        while(rr){
-            pf ^= (rr&1);
-            rr >>= 1;
-        }
-        cpu->PSW.parity = pf;
-    }
     if (flags & CARRY_FLAG){
-        cpu->PSW.carry = (final_state & 0x100) ? 1 : 0;
+        psw_set_cy_res(&cpu->PSW, final_state);
     }
     return;
 }
@@ -189,7 +115,8 @@ void set_flags(cpu_state* cpu ,uint32_t final_state, uint8_t flags){
  * @brief sets the aux flag for all operations. Must convert all ops to a 
  * addition operation (compressed).
  * Does base_val + diff to recalc the result.
- * So for -ve bass -ve num's 2 complement. 
+ * So for -ve bass -ve num's 2 complement. Only the low nibbles matter,
+ * the flag itself is worked out on demand by psw_aux.
  * 
  * @todo not sure if this is correct.
  * @param cpu 
@@ -197,60 +124,7 @@ void set_flags(cpu_state* cpu ,uint32_t final_state, uint8_t flags){
  * @param diff the value to be added to the base
  */
 void aux_flag_set_add(cpu_state* cpu, uint32_t base_val, uint32_t diff){
-    uint8_t xor = (base_val ^ diff) & 0x10; // basically if 0|1 -> 1 else 0
-    uint8_t summ = (base_val + diff) & 0x10; // xor + propagate
-    if( xor != summ ){
-        cpu->PSW.aux = 1;
-    } else {
-        cpu->PSW.aux = 0;
-    }
-}
-
-/**
- * @brief Compress program_status_word into a uint8_t as per
- * flag_bits
- * 
- * @param psw 
- * @return uint8_t 
- */
-uint8_t compress_PSW(program_status_word psw){
-    uint8_t status = 0;
-    status |= psw.carry ? CARRY_FLAG : 0;
-    status |= psw.aux ? AUX_FLAG : 0;
-    status |= psw.sign ? SIGN_FLAG : 0;
-    status |= psw.zero ? ZERO_FLAG : 0;
-    status |= psw.parity ? PARITY_FLAG : 0;
-    return status;
-}
-
-/**
- * @brief Inflate the uint8_t into a program_status_word by using
- * flag_bits as the mapping
- * 
- * @param status 
- * @return program_status_word 
- */
-program_status_word decompress_PSW(uint8_t status){
-    program_status_word new_status;
-    new_status.carry = status & CARRY_FLAG ? 1 : 0;
-    new_status.aux = status & AUX_FLAG ? 1 : 0;
-    new_status.sign = status & SIGN_FLAG ? 1 : 0;
-    new_status.zero = status & ZERO_FLAG ? 1 : 0;
-    new_status.parity = status & PARITY_FLAG ? 1 : 0;
-    return new_status;
-}
-
-/**
- * @brief Undefined OPCODE Functor 
- * 
- * @param cpu Cpu State
- * @param base_PC pointer to the location of the instruction start
- * @param op_code of the instruction under execution
- * @return int 1 of success, 0 if fail
- */
-int UNDEFINED_OP_WRAP(UNUSED cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    DECOMPILE_PRINT(base_PC, "(%x)This Opcode has not been initialized.\n", op_code);
-    return -1;
+    psw_set_aux_add(&cpu->PSW, base_val, diff);
 }
 
 /**
@@ -269,19 +143,15 @@ int NOP_WRAP(UNUSED cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_c
 /**
  * @brief Load register pair immediate
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param rp register pair the handler is generated for
  */
-int LXI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (0x30 & op_code) >> 4;
-    uint16_t imm_data = short_mem_read(&cpu->mem, base_PC+1);
-    uint16_t* target_dest = ref_short_reg(cpu, reg_patt);
-    *target_dest = imm_data;
-    DECOMPILE_PRINT(base_PC, "LXI REGP(%x), %x\n", reg_patt, imm_data);
-    return 1;
+#define DEFINE_LXI(rp)                                                          \
+OP_HANDLER(LXI_##rp##_WRAP){                                                    \
+    PAIR_##rp(cpu) = short_mem_fetch(&cpu->mem, base_PC+1);                     \
+    DECOMPILE_PRINT(base_PC, "LXI %s, %x\n", #rp, PAIR_##rp(cpu));              \
+    return 1;                                                                   \
 }
+WORD_OPERANDS(DEFINE_LXI)
 
 /**
  * @brief (PC) (byte 3) (byte 2) -- 
@@ -293,40 +163,39 @@ int LXI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * @param op_code 
  * @return int 
  */
-int JMP_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    switch (op_code)
-    {
-    case 0xC3:
-        cpu->PC = short_mem_read(&cpu->mem, base_PC+1);
-        DECOMPILE_PRINT(base_PC, "JMP %x\n", cpu->PC);
-        break;
-    case 0xCB:
-        DEBUG_PRINT("%s\n", "UNINIMPLEMENTED.");
-        ILLEGAL_OP;
-        exit(-3);
-    default:
-        ILLEGAL_OP;
-        exit(-2);
-    }
+int JMP_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    cpu->PC = short_mem_fetch(&cpu->mem, base_PC+1);
+    DECOMPILE_PRINT(base_PC, "JMP %x\n", cpu->PC);
     return 1;
 }
 
 /**
- * @brief Move Immediate
+ * @brief Undocumented JMP at 0xCB, not supported
  * 
  * @param cpu 
  * @param base_PC 
  * @param op_code 
  * @return int 
  */
-int MVI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (0x38 & op_code) >> 3;
-    uint8_t imm_data = mem_read(&cpu->mem, base_PC+1);
-    uint8_t* target_dest = ref_byte_reg(cpu, reg_patt);
-    *target_dest = imm_data;
-    DECOMPILE_PRINT(base_PC, "MVI REG(%x), %x\n", reg_patt, imm_data);
-    return 1;
+int JMP_UNDOC_WRAP(UNUSED cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    DEBUG_PRINT("%s\n", "UNINIMPLEMENTED.");
+    ILLEGAL_OP;
+    exit(-3);
+}
+
+/**
+ * @brief Move Immediate
+ * 
+ * @param reg destination the handler is generated for
+ */
+#define DEFINE_MVI(reg)                                                         \
+OP_HANDLER(MVI_##reg##_WRAP){                                                   \
+    uint8_t imm_data = mem_fetch(&cpu->mem, base_PC+1);                          \
+    WRITE_##reg(cpu, imm_data);                                                 \
+    DECOMPILE_PRINT(base_PC, "MVI %s, %x\n", #reg, imm_data);                   \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_MVI)
 
 /**
  * @brief The current PC (pointer to next instruction) is move to the top
@@ -338,69 +207,74 @@ int MVI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * @param op_code 
  * @return int 
  */
-int CALL_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    switch (op_code)
-    {
-    case 0xCD:
-        cpu->SP -= 2;
-        short_mem_write(&cpu->mem, cpu->SP, cpu->PC);       // Saving Return Addr
-        cpu->PC = short_mem_read(&cpu->mem, base_PC+1);     // Reading the new PC
-        DECOMPILE_PRINT(base_PC, "CALL %x\n", cpu->PC );    // Logging
-        break;
-    default:
-        // There was CALL at 0x[D-F]D which didn't have stuff
-        // in the manual
-        ILLEGAL_OP;
-        break;
-    }
+int CALL_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    cpu->SP -= 2;
+    short_mem_write(&cpu->mem, cpu->SP, cpu->PC);       // Saving Return Addr
+    cpu->PC = short_mem_fetch(&cpu->mem, base_PC+1);     // Reading the new PC
+    DECOMPILE_PRINT(base_PC, "CALL %x\n", cpu->PC );    // Logging
     return 1;
 }
 
 /**
- * @brief Load accumulator indirect: The content of the memory location, whose address
- * is in the register pair rp, is moved to register A
+ * @brief There was CALL at 0x[D-F]D which didn't have stuff
+ * in the manual, treated as a 3 byte no op.
  * 
  * @param cpu 
  * @param base_PC 
  * @param op_code 
  * @return int 
+ */
+int CALL_UNDOC_WRAP(UNUSED cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    ILLEGAL_OP;
+    return 1;
+}
+
+/**
+ * @brief Load accumulator indirect: The content of the memory location, whose address
+ * is in the register pair rp, is moved to register A
+ * 
+ * @param rp register pair the handler is generated for
  * @note only register pairs rp=B (registers B and C·) or rp=D
  * (registers D and E) may be specified
  */
-int LDAX_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (0x30 & op_code) >> 4;
-    if(reg_patt < 2){
-        uint16_t* target_dest = ref_short_reg(cpu, reg_patt);
-        cpu->ACC = mem_read(&cpu->mem, *target_dest);
-        DECOMPILE_PRINT(base_PC, "LDAX REGP(%x), %x\n", reg_patt, cpu->ACC);
-    } else {
-        ILLEGAL_OP;
-        exit(-2);
-    }
-    return 1;
+#define DEFINE_LDAX(rp)                                                         \
+OP_HANDLER(LDAX_##rp##_WRAP){                                                   \
+    cpu->ACC = mem_read(&cpu->mem, PAIR_##rp(cpu));                             \
+    DECOMPILE_PRINT(base_PC, "LDAX %s, %x\n", #rp, cpu->ACC);                   \
+    return 1;                                                                   \
 }
+DEFINE_LDAX(BC)
+DEFINE_LDAX(DE)
 
 /**
  * @brief All different kinds of move operations:
  * - Move Register
  * - Move from Memory (*HL -> Reg)
  * - Move to memory (Reg -> *HL)
- * The immediate versions are in the `MVI_WRAP` function
+ * The immediate versions are in the `MVI_WRAP` handlers
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
- */
-int MOV_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t dest_reg_patt = (0x38 & op_code) >> 3;
-    uint8_t src_reg_patt = (0x07 & op_code);
-    uint8_t *dest_reg = ref_byte_reg(cpu, dest_reg_patt);
-    uint8_t *src_reg = ref_byte_reg(cpu, src_reg_patt);
-    *dest_reg = *src_reg;
-    DECOMPILE_PRINT(base_PC, "MOV REGDest(%x), REGSrc(%x)\n", dest_reg_patt, src_reg_patt);
-    return 1;
-}
+ * @param dst destination the handler is generated for
+ * @param src source the handler is generated for
+ */
+#define DEFINE_MOV(dst, src)                                                    \
+OP_HANDLER(MOV_##dst##_##src##_WRAP){                                           \
+    WRITE_##dst(cpu, READ_##src(cpu));                                          \
+    DECOMPILE_PRINT(base_PC, "MOV %s, %s\n", #dst, #src);                       \
+    return 1;                                                                   \
+}
+/** One MOV per source for a destination, MOV M,M is HLT */
+#define DEFINE_MOV_ROW(dst)                                                     \
+    DEFINE_MOV(dst, B) DEFINE_MOV(dst, C) DEFINE_MOV(dst, D) DEFINE_MOV(dst, E) \
+    DEFINE_MOV(dst, H) DEFINE_MOV(dst, L) DEFINE_MOV(dst, M) DEFINE_MOV(dst, A)
+DEFINE_MOV_ROW(B)
+DEFINE_MOV_ROW(C)
+DEFINE_MOV_ROW(D)
+DEFINE_MOV_ROW(E)
+DEFINE_MOV_ROW(H)
+DEFINE_MOV_ROW(L)
+DEFINE_MOV(M, B) DEFINE_MOV(M, C) DEFINE_MOV(M, D) DEFINE_MOV(M, E)
+DEFINE_MOV(M, H) DEFINE_MOV(M, L) DEFINE_MOV(M, A)
+DEFINE_MOV_ROW(A)
 
 /**
  * @brief The processor is stopped. The registers and flags are
@@ -422,58 +296,49 @@ int HLT_WRAP(UNUSED cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_c
  * The content of the register pair rp is incremented by one. 
  * @note No condition flags are affected.
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param rp register pair the handler is generated for
  */
-int INX_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (0x30 & op_code) >> 4;
-    uint16_t* target_dest = ref_short_reg(cpu, reg_patt);
-    *target_dest += 1;
-    DECOMPILE_PRINT(base_PC, "INX REGP(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_INX(rp)                                                          \
+OP_HANDLER(INX_##rp##_WRAP){                                                    \
+    PAIR_##rp(cpu) += 1;                                                        \
+    DECOMPILE_PRINT(base_PC, "INX %s\n", #rp);                                  \
+    return 1;                                                                   \
 }
+WORD_OPERANDS(DEFINE_INX)
 
 /**
  * @brief (Decrement Register) The content of register r is decremented by one.
  * @note All condition flag except CY are affected.
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int DCR_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t target_reg = (op_code & 0x38) >> 3;
-    uint16_t target_data = *(ref_byte_reg(cpu, target_reg));
-    uint16_t base_data = target_data;
-    // Update The data
-    target_data -= 1;
-    *(ref_byte_reg(cpu, target_reg)) = (uint8_t)target_data;
-    // Update Flags
-    set_flags(cpu, target_data, SIGN_FLAG | ZERO_FLAG | PARITY_FLAG );
-    aux_flag_set_add(cpu, base_data, -1);
-    DECOMPILE_PRINT(base_PC, "DCR REG(%x)\n", target_reg);
-    return 1;
+#define DEFINE_DCR(reg)                                                         \
+OP_HANDLER(DCR_##reg##_WRAP){                                                   \
+    uint16_t base_data = READ_##reg(cpu);                                       \
+    uint16_t target_data = base_data - 1;                                       \
+    WRITE_##reg(cpu, (uint8_t)target_data);                                     \
+    set_flags(cpu, target_data, SIGN_FLAG | ZERO_FLAG | PARITY_FLAG );          \
+    aux_flag_set_add(cpu, base_data, -1);                                       \
+    DECOMPILE_PRINT(base_PC, "DCR %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_DCR)
 
 /**
  * @brief Conditional JMP statements
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param cond condition the handler is generated for
  */
-int JCon_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    if(condition_check(cpu, (0x38 & op_code)>>3)){
-        cpu->PC = short_mem_read(&cpu->mem, base_PC+1);
-    }
-    DECOMPILE_PRINT(base_PC, "JMP Con(%x) %x\n", (0x38 & op_code)>>3, 
-        short_mem_read(&cpu->mem, base_PC+1));
-    return 1;
+#define DEFINE_JCON(cond)                                                       \
+OP_HANDLER(J##cond##_WRAP){                                                     \
+    if(COND_##cond(cpu)){                                                       \
+        cpu->PC = short_mem_fetch(&cpu->mem, base_PC+1);                        \
+    }                                                                           \
+    DECOMPILE_PRINT(base_PC, "J%s %x\n", #cond,                                 \
+        short_mem_fetch(&cpu->mem, base_PC+1));                                 \
+    return 1;                                                                   \
 }
+CONDITIONS(DEFINE_JCON)
 
 /**
  * @brief (Return) 
@@ -489,54 +354,59 @@ int JCon_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * @param op_code 
  * @return int 
  */
-int RET_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    if(op_code == 0xC9){
-        cpu->PC = short_mem_read(&cpu->mem, cpu->SP);
-        cpu->SP += 2;
-        DECOMPILE_PRINT(base_PC, "%s\n", "RET");
-    } else {
-        ILLEGAL_OP;
-        exit(-2);
-    }
+int RET_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    cpu->PC = short_mem_read(&cpu->mem, cpu->SP);
+    cpu->SP += 2;
+    DECOMPILE_PRINT(base_PC, "%s\n", "RET");
     return 1;
 }
 
 /**
- * @brief Conditional version of `RET_WRAP`
+ * @brief Undocumented RET at 0xD9, not supported
  * 
  * @param cpu 
  * @param base_PC 
  * @param op_code 
  * @return int 
  */
-int RCon_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    DECOMPILE_PRINT(base_PC, "RET Cond(%x)\n", (op_code & 0x38) >> 3);
-    if(condition_check(cpu, (op_code & 0x38) >> 3)){
-        cpu->PC = short_mem_read(&cpu->mem, cpu->SP);
-        cpu->SP += 2;
-    }
-    return 1;
+int RET_UNDOC_WRAP(UNUSED cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    ILLEGAL_OP;
+    exit(-2);
 }
 
+/**
+ * @brief Conditional version of `RET_WRAP`
+ * 
+ * @param cond condition the handler is generated for
+ */
+#define DEFINE_RCON(cond)                                                       \
+OP_HANDLER(R##cond##_WRAP){                                                     \
+    DECOMPILE_PRINT(base_PC, "R%s\n", #cond);                                   \
+    if(COND_##cond(cpu)){                                                       \
+        cpu->PC = short_mem_read(&cpu->mem, cpu->SP);                           \
+        cpu->SP += 2;                                                           \
+        cpu->cycles += RCON_TAKEN_CYCLES;                                       \
+    }                                                                           \
+    return 1;                                                                   \
+}
+CONDITIONS(DEFINE_RCON)
+
 /**
  * @brief Comparison operation
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int CMP_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint16_t acc_reg = cpu->ACC;
-    uint16_t compare_src = *(ref_byte_reg(cpu, (op_code & 0x07)));
-    // Perform Comparison
-    uint16_t diff = acc_reg - compare_src;
-    // Update Flags
-    set_flags(cpu, diff, SIGN_FLAG | ZERO_FLAG | PARITY_FLAG | CARRY_FLAG);
-    aux_flag_set_add(cpu, acc_reg, -compare_src);
-    DECOMPILE_PRINT(base_PC, "CMP REG(%x)\n", (op_code & 0x07));
-    return 1;
+#define DEFINE_CMP(reg)                                                         \
+OP_HANDLER(CMP_##reg##_WRAP){                                                   \
+    uint16_t acc_reg = cpu->ACC;                                                \
+    uint16_t compare_src = READ_##reg(cpu);                                     \
+    uint16_t diff = acc_reg - compare_src;                                      \
+    set_flags(cpu, diff, SIGN_FLAG | ZERO_FLAG | PARITY_FLAG | CARRY_FLAG);     \
+    aux_flag_set_add(cpu, acc_reg, -compare_src);                               \
+    DECOMPILE_PRINT(base_PC, "CMP %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_CMP)
 
 /**
  * @brief Compare A with(-) (byte 2)
@@ -548,7 +418,7 @@ int CMP_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  */
 int CPI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
     uint16_t acc_reg = cpu->ACC;
-    uint16_t compare_src = mem_read(&cpu->mem, base_PC+1);
+    uint16_t compare_src = mem_fetch(&cpu->mem, base_PC+1);
     // Perform Comparison
     uint16_t diff = acc_reg - compare_src;
     // Update Flags
@@ -560,55 +430,67 @@ int CPI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
 
 /**
  * @brief The content of content register, is moved into the memory 
- * whose address is specified by the SP. Note: for RP-11b
- * it transforms into PUSH PSW
+ * whose address is specified by the SP.
+ * 
+ * @param rp register pair the handler is generated for
+ */
+#define DEFINE_PUSH(rp)                                                         \
+OP_HANDLER(PUSH_##rp##_WRAP){                                                   \
+    cpu->SP -= 2;                                                               \
+    short_mem_write(&cpu->mem, cpu->SP, PAIR_##rp(cpu));                        \
+    DECOMPILE_PRINT(base_PC, "PUSH %s\n", #rp);                                 \
+    return 1;                                                                   \
+}
+DEFINE_PUSH(BC)
+DEFINE_PUSH(DE)
+DEFINE_PUSH(HL)
+
+/**
+ * @brief PUSH with RP-11b, pushes ACC and the compressed PSW
  * 
  * @param cpu 
  * @param base_PC 
  * @param op_code 
  * @return int 
  */
-int PUSH_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t reg_patt = (0x30 & op_code) >> 4;
-    // Swap out SP for PSW.
-    if(reg_patt == 0x3){
-        cpu->SP -= 2;
-        mem_write(&cpu->mem, cpu->SP, compress_PSW(cpu->PSW));
-        mem_write(&cpu->mem, cpu->SP+1, cpu->ACC);
-        DECOMPILE_PRINT(base_PC, "%s\n", "PUSH PSW");
-    } else {
-        uint16_t* target_dest = ref_short_reg(cpu, reg_patt);
-        cpu->SP -= 2;
-        short_mem_write(&cpu->mem, cpu->SP, *target_dest);
-        DECOMPILE_PRINT(base_PC, "PUSH REGP(%x)\n", reg_patt);
-    }
+int PUSH_PSW_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    cpu->SP -= 2;
+    mem_write(&cpu->mem, cpu->SP, compress_PSW(cpu->PSW));
+    mem_write(&cpu->mem, cpu->SP+1, cpu->ACC);
+    DECOMPILE_PRINT(base_PC, "%s\n", "PUSH PSW");
     return 1;
 }
 
 /**
  * @brief The content of the memory location, whose address
- * is specified by the SP is pused into content Reg. Note: for RP-11b
- * it transforms into POP PSW
+ * is specified by the SP is pused into content Reg.
+ * 
+ * @param rp register pair the handler is generated for
+ */
+#define DEFINE_POP(rp)                                                          \
+OP_HANDLER(POP_##rp##_WRAP){                                                    \
+    PAIR_##rp(cpu) = short_mem_read(&cpu->mem, cpu->SP);                        \
+    cpu->SP += 2;                                                               \
+    DECOMPILE_PRINT(base_PC, "POP %s\n", #rp);                                  \
+    return 1;                                                                   \
+}
+DEFINE_POP(BC)
+DEFINE_POP(DE)
+DEFINE_POP(HL)
+
+/**
+ * @brief POP with RP-11b, pops the PSW and ACC
  * 
  * @param cpu 
  * @param base_PC 
  * @param op_code 
  * @return int 
  */
-int POP_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t reg_patt = (0x30 & op_code) >> 4;
-    // Swap out SP for PSW.
-    if(reg_patt == 0x3){
-        cpu->PSW = decompress_PSW(mem_read(&cpu->mem, cpu->SP));
-        cpu->ACC = mem_read(&cpu->mem, cpu->SP+1);
-        cpu->SP += 2;
-        DECOMPILE_PRINT(base_PC, "%s\n", "POP PSW");
-    } else {
-        uint16_t* target_dest = ref_short_reg(cpu, reg_patt);
-        *target_dest = short_mem_read(&cpu->mem, cpu->SP);
-        cpu->SP += 2;
-        DECOMPILE_PRINT(base_PC, "POP REGP(%x)\n", reg_patt);
-    }
+int POP_PSW_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
+    cpu->PSW = decompress_PSW(mem_read(&cpu->mem, cpu->SP));
+    cpu->ACC = mem_read(&cpu->mem, cpu->SP+1);
+    cpu->SP += 2;
+    DECOMPILE_PRINT(base_PC, "%s\n", "POP PSW");
     return 1;
 }
 
@@ -619,23 +501,18 @@ int POP_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * placed in the register pair Hand L. 
  * @note: Only the CY flag is affected.
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param rp register pair the handler is generated for
  */
-int DAD_WRAP(cpu_state* cpu, UNUSED  uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (0x30 & op_code) >> 4;
-    uint16_t* target_dest = ref_short_reg(cpu, reg_patt);
-    uint32_t temp = cpu->HL;
-    temp += *target_dest;
-    // Update HL
-    cpu->HL = temp & 0xFFFF;
-    // Set Carry Flag
-    cpu->PSW.carry = (cpu->HL < temp) ? 1 : 0;
-    DECOMPILE_PRINT(base_PC, "DAD REG(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_DAD(rp)                                                          \
+OP_HANDLER(DAD_##rp##_WRAP){                                                    \
+    uint32_t temp = cpu->HL;                                                    \
+    temp += PAIR_##rp(cpu);                                                     \
+    cpu->HL = temp & 0xFFFF;                                                    \
+    psw_set_carry(&cpu->PSW, (cpu->HL < temp) ? 1 : 0);                         \
+    DECOMPILE_PRINT(base_PC, "DAD %s\n", #rp);                                  \
+    return 1;                                                                   \
 }
+WORD_OPERANDS(DEFINE_DAD)
 
 /**
  * @brief Xchanges HL <--> DE
@@ -662,7 +539,7 @@ int XCHG_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int OUT_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t port = mem_read(&cpu->mem, base_PC+1);
+    uint8_t port = mem_fetch(&cpu->mem, base_PC+1);
     cpu->OUT_Func(port, cpu->ACC);
     DECOMPILE_PRINT(base_PC, "OUT %x\n", port);
     return 1;
@@ -678,7 +555,7 @@ int OUT_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int IN_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t port = mem_read(&cpu->mem, base_PC+1);
+    uint8_t port = mem_fetch(&cpu->mem, base_PC+1);
     cpu->ACC = cpu->IN_Func(port);
     DECOMPILE_PRINT(op_code, "IN %x\n", port);
     return 1;
@@ -687,23 +564,16 @@ int IN_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
 /**
  * @brief Store *(RP) <- A
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param rp register pair the handler is generated for
  */
-int STAX_WRAP(cpu_state* cpu, UNUSED UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (0x30 & op_code) >> 4;
-    if(reg_patt < 2){
-        uint16_t* target_ref = ref_short_reg(cpu, reg_patt);
-        mem_write(&cpu->mem, *target_ref, cpu->ACC);
-        DECOMPILE_PRINT(base_PC, "STAX *(REGP(%x)), A\n", reg_patt);
-    } else {
-        ILLEGAL_OP;
-        exit(-2);
-    }
-    return 1;
+#define DEFINE_STAX(rp)                                                         \
+OP_HANDLER(STAX_##rp##_WRAP){                                                   \
+    mem_write(&cpu->mem, PAIR_##rp(cpu), cpu->ACC);                             \
+    DECOMPILE_PRINT(base_PC, "STAX *(%s), A\n", #rp);                           \
+    return 1;                                                                   \
 }
+DEFINE_STAX(BC)
+DEFINE_STAX(DE)
 
 /**
  * @brief (A) = (A) /\ (r)
@@ -711,25 +581,19 @@ int STAX_WRAP(cpu_state* cpu, UNUSED UNUSED uint16_t base_PC, uint8_t op_code){
  * content of the accumulator. The result is placed in
  * the accumulator. The CY flag is cleared
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int ANA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (0x07 & op_code);
-    uint8_t *target_reg = ref_byte_reg(cpu, reg_patt);
-    // Perform AND
-    uint8_t base_val = cpu->ACC;
-    uint8_t base_target = *target_reg;
-    cpu->ACC &= (*target_reg);
-    // Update Flags
-    set_flags(cpu, cpu->ACC, ALL_BUT_AUX_FLAG);
-    // https://www.quora.com/What-is-the-auxiliary-carry-set-when-ANA-R-instruction-is-executed-in-an-8085-CPU
-    cpu->PSW.aux = ((base_val | base_target) & 0x08) ? 1 : 0;
-    DECOMPILE_PRINT(base_PC, "ANA REG(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_ANA(reg)                                                         \
+OP_HANDLER(ANA_##reg##_WRAP){                                                   \
+    uint8_t base_val = cpu->ACC;                                                \
+    uint8_t base_target = READ_##reg(cpu);                                      \
+    cpu->ACC &= base_target;                                                    \
+    set_flags(cpu, cpu->ACC, ALL_BUT_AUX_FLAG);                                 \
+    psw_set_aux(&cpu->PSW, (base_val | base_target) & 0x08);                    \
+    DECOMPILE_PRINT(base_PC, "ANA %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_ANA)
 
 /**
  * @brief (L) <-- ((byte 3)(byte 2))
@@ -741,7 +605,7 @@ int ANA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * @return int 
  */
 int LHLD_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint16_t target_addr = short_mem_read(&cpu->mem, base_PC+1);
+    uint16_t target_addr = short_mem_fetch(&cpu->mem, base_PC+1);
     cpu->HL = short_mem_read(&cpu->mem, target_addr);
     DECOMPILE_PRINT(base_PC, "LHLD %x\n", target_addr);
     return 1;
@@ -757,12 +621,12 @@ int LHLD_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int ANI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t target_data = mem_read(&cpu->mem, base_PC+1);
+    uint8_t target_data = mem_fetch(&cpu->mem, base_PC+1);
     uint8_t base_val = cpu->ACC;
     cpu->ACC &= target_data;
     set_flags(cpu, cpu->ACC, ALL_BUT_AUX_FLAG);
     // https://www.quora.com/What-is-the-auxiliary-carry-set-when-ANA-R-instruction-is-executed-in-an-8085-CPU
-    cpu->PSW.aux = ((base_val | target_data) & 0x08) ? 1 : 0;
+    psw_set_aux(&cpu->PSW, (base_val | target_data) & 0x08);
     DECOMPILE_PRINT(base_PC, "ANI %x\n", target_data);
     return 1;
 }
@@ -776,7 +640,7 @@ int ANI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int STA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint16_t target_loc = short_mem_read(&cpu->mem, base_PC+1); 
+    uint16_t target_loc = short_mem_fetch(&cpu->mem, base_PC+1); 
     mem_write(&cpu->mem, target_loc, cpu->ACC);
     DECOMPILE_PRINT(base_PC, "STA %x\n", target_loc);
     return 1;
@@ -785,24 +649,19 @@ int STA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
 /**
  * @brief (increment Reg) (r) <- (r) + 1
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int INR_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x38) >> 3;
-    uint16_t target_data = *(ref_byte_reg(cpu, reg_patt));
-    uint16_t base_data = target_data;
-    // Update The data
-    target_data += 1;
-    *(ref_byte_reg(cpu, reg_patt)) = (uint8_t)target_data;
-    // Update Flags
-    set_flags(cpu, target_data, SIGN_FLAG | ZERO_FLAG | PARITY_FLAG );
-    aux_flag_set_add(cpu, base_data, +1);
-    DECOMPILE_PRINT(base_PC, "INR Reg(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_INR(reg)                                                         \
+OP_HANDLER(INR_##reg##_WRAP){                                                   \
+    uint16_t base_data = READ_##reg(cpu);                                       \
+    uint16_t target_data = base_data + 1;                                       \
+    WRITE_##reg(cpu, (uint8_t)target_data);                                     \
+    set_flags(cpu, target_data, SIGN_FLAG | ZERO_FLAG | PARITY_FLAG );          \
+    aux_flag_set_add(cpu, base_data, +1);                                       \
+    DECOMPILE_PRINT(base_PC, "INR %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_INR)
 
 /**
  * @brief (Rotate Right)
@@ -819,9 +678,9 @@ int RRC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
     cpu->ACC >>= 1;
     if(lsb){
         cpu->ACC |= 0x80;
-        cpu->PSW.carry = 1;
+        psw_set_carry(&cpu->PSW, 1);
     } else {
-        cpu->PSW.carry = 0;
+        psw_set_carry(&cpu->PSW, 0);
     }
     DECOMPILE_PRINT(base_PC, "%s\n", "RRC");
     return 1;
@@ -837,8 +696,8 @@ int RRC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int LDA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint16_t target_addr = short_mem_read(&cpu->mem, base_PC+1);
-    cpu->ACC = short_mem_read(&cpu->mem, target_addr);
+    uint16_t target_addr = short_mem_fetch(&cpu->mem, base_PC+1);
+    cpu->ACC = mem_read(&cpu->mem, target_addr);
     DECOMPILE_PRINT(base_PC, "LDA %x\n", target_addr);
     return 1;
 }
@@ -847,22 +706,17 @@ int LDA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @brief (Exclusive OR Register)
  * (A) = (A) ^ (r)
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int XRA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x07);
-    uint8_t *target_reg = ref_byte_reg(cpu, reg_patt);
-    uint16_t temp = (*target_reg) ^ cpu->ACC;
-    cpu->ACC = temp;
-    // Setting flags
-    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    cpu->PSW.aux = 0;
-    DECOMPILE_PRINT(base_PC, "XRA Reg(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_XRA(reg)                                                         \
+OP_HANDLER(XRA_##reg##_WRAP){                                                   \
+    cpu->ACC ^= READ_##reg(cpu);                                                \
+    set_flags(cpu, cpu->ACC, ALL_BUT_AUX_FLAG);                                 \
+    psw_set_aux(&cpu->PSW, 0);                                                  \
+    DECOMPILE_PRINT(base_PC, "XRA %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_XRA)
 
 /**
  * @brief Enable Interrupts
@@ -902,7 +756,7 @@ int DI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int SHLD_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint16_t target_addr = short_mem_read(&cpu->mem, base_PC+1);
+    uint16_t target_addr = short_mem_fetch(&cpu->mem, base_PC+1);
     short_mem_write(&cpu->mem, target_addr, cpu->HL);
     DECOMPILE_PRINT(base_PC, "SHLD %x\n", target_addr);
     return 1;
@@ -911,18 +765,15 @@ int SHLD_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
 /**
  * @brief (reg pair) = (reg pair) - 1
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param rp register pair the handler is generated for
  */
-int DCX_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x30) >> 4;
-    uint16_t* target_reg = ref_short_reg(cpu, reg_patt);
-    (*target_reg)--;
-    DECOMPILE_PRINT(base_PC, "DCX REGP(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_DCX(rp)                                                          \
+OP_HANDLER(DCX_##rp##_WRAP){                                                    \
+    PAIR_##rp(cpu) -= 1;                                                        \
+    DECOMPILE_PRINT(base_PC, "DCX %s\n", #rp);                                  \
+    return 1;                                                                   \
 }
+WORD_OPERANDS(DEFINE_DCX)
 
 /**
  * @brief (Rotate left)
@@ -938,9 +789,9 @@ int RLC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
     cpu->ACC <<= 1;
     if(msb){
         cpu->ACC |= msb;
-        cpu->PSW.carry = 1;
+        psw_set_carry(&cpu->PSW, 1);
     } else {
-        cpu->PSW.carry = 0;
+        psw_set_carry(&cpu->PSW, 0);
     }
     DECOMPILE_PRINT(base_PC, "%s\n", "RLC");
     return 1;
@@ -957,11 +808,11 @@ int RLC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  */
 int RAL_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
     uint8_t msb = (cpu->ACC & 0x80) ? 1 : 0;
-    cpu->ACC = (cpu->ACC << 1) | cpu->PSW.carry;
+    cpu->ACC = (cpu->ACC << 1) | psw_carry(&cpu->PSW);
     if(msb){
-        cpu->PSW.carry = 1;
+        psw_set_carry(&cpu->PSW, 1);
     } else {
-        cpu->PSW.carry = 0;
+        psw_set_carry(&cpu->PSW, 0);
     }
     DECOMPILE_PRINT(base_PC, "%s\n", "RAL");
     return 1;
@@ -978,11 +829,11 @@ int RAL_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  */
 int RAR_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
     uint8_t lsb = cpu->ACC & 0x01;
-    cpu->ACC = (cpu->ACC >> 1) | (cpu->PSW.carry ? 0x80 : 0x0);
+    cpu->ACC = (cpu->ACC >> 1) | (psw_carry(&cpu->PSW) ? 0x80 : 0x0);
     if(lsb){
-        cpu->PSW.carry = 1;
+        psw_set_carry(&cpu->PSW, 1);
     } else {
-        cpu->PSW.carry = 0;
+        psw_set_carry(&cpu->PSW, 0);
     }
     DECOMPILE_PRINT(base_PC, "%s\n", "RAR");
     return 1;
@@ -996,21 +847,21 @@ int RAR_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * (SP) (SP) - 2
  * (PC) (byte 3) (byte 2)
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param cond condition the handler is generated for
  */
-int CCon_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    if(condition_check(cpu, (0x38 & op_code)>>3)){
-        cpu->SP -= 2;
-        short_mem_write(&cpu->mem, cpu->SP, cpu->PC);       // Saving Return Addr
-        cpu->PC = short_mem_read(&cpu->mem, base_PC+1);     // Reading the new PC
-    }
-    DECOMPILE_PRINT(base_PC, "CALL Con(%x) %x\n", (0x38 & op_code)>>3, 
-        short_mem_read(&cpu->mem, base_PC+1));
-    return 1;
+#define DEFINE_CCON(cond)                                                       \
+OP_HANDLER(C##cond##_WRAP){                                                     \
+    if(COND_##cond(cpu)){                                                       \
+        cpu->SP -= 2;                                                           \
+        short_mem_write(&cpu->mem, cpu->SP, cpu->PC);                           \
+        cpu->PC = short_mem_fetch(&cpu->mem, base_PC+1);                        \
+        cpu->cycles += CCON_TAKEN_CYCLES;                                       \
+    }                                                                           \
+    DECOMPILE_PRINT(base_PC, "C%s %x\n", #cond,                                 \
+        short_mem_fetch(&cpu->mem, base_PC+1));                                 \
+    return 1;                                                                   \
 }
+CONDITIONS(DEFINE_CCON)
 
 /**
  * @brief (Subtract immediate with borrow)
@@ -1026,12 +877,12 @@ int CCon_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * @return int 
  */
 int SBI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t target_data = mem_read(&cpu->mem, base_PC+1);
+    uint8_t target_data = mem_fetch(&cpu->mem, base_PC+1);
     uint16_t temp =  cpu->ACC;
-    temp = temp - target_data - cpu->PSW.carry;
+    temp = temp - target_data - psw_carry(&cpu->PSW);
     // Set flags
     set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, -target_data - cpu->PSW.carry);
+    aux_flag_set_add(cpu, cpu->ACC, -target_data - psw_carry(&cpu->PSW));
     cpu->ACC = temp;
     DECOMPILE_PRINT(base_PC, "SBI %x\n", target_data);
     return 1;
@@ -1043,22 +894,19 @@ int SBI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * The content of register r is added to the content of the
  * accumulator. The result is placed in the accumulator.
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int ADD_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x07);
-    uint16_t temp = *(ref_byte_reg(cpu, reg_patt));
-    temp += cpu->ACC;
-    // Set Flags
-    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, *(ref_byte_reg(cpu, reg_patt)));
-    cpu->ACC = temp;
-    DECOMPILE_PRINT(base_PC, "ADD REG(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_ADD(reg)                                                         \
+OP_HANDLER(ADD_##reg##_WRAP){                                                   \
+    uint8_t src = READ_##reg(cpu);                                              \
+    uint16_t temp = cpu->ACC + src;                                             \
+    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);                                     \
+    aux_flag_set_add(cpu, cpu->ACC, src);                                       \
+    cpu->ACC = temp;                                                            \
+    DECOMPILE_PRINT(base_PC, "ADD %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_ADD)
 
 /**
  * @brief (Add Immediate)
@@ -1073,13 +921,13 @@ int ADD_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * @return int 
  */
 int ADI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint16_t temp = mem_read(&cpu->mem, base_PC+1);
+    uint16_t temp = mem_fetch(&cpu->mem, base_PC+1);
     temp += cpu->ACC;
     // Set Flags
     set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, mem_read(&cpu->mem, base_PC+1));
+    aux_flag_set_add(cpu, cpu->ACC, mem_fetch(&cpu->mem, base_PC+1));
     cpu->ACC = temp;
-    DECOMPILE_PRINT(base_PC, "ADI %x\n", mem_read(&cpu->mem, base_PC+1));
+    DECOMPILE_PRINT(base_PC, "ADI %x\n", mem_fetch(&cpu->mem, base_PC+1));
     return 1;
 }
 
@@ -1090,22 +938,19 @@ int ADI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * bit are added to the content of the accumulator. The
  * result is placed in the accumulator
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int ADC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x07);
-    uint16_t temp = *(ref_byte_reg(cpu, reg_patt));
-    temp += cpu->ACC + cpu->PSW.carry;
-    // Set Flags
-    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, *(ref_byte_reg(cpu, reg_patt)) + cpu->PSW.carry);
-    cpu->ACC = temp;
-    DECOMPILE_PRINT(base_PC, "ADC REG(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_ADC(reg)                                                         \
+OP_HANDLER(ADC_##reg##_WRAP){                                                   \
+    uint8_t src = READ_##reg(cpu);                                              \
+    uint16_t temp = cpu->ACC + src + psw_carry(&cpu->PSW);                      \
+    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);                                     \
+    aux_flag_set_add(cpu, cpu->ACC, src + psw_carry(&cpu->PSW));                \
+    cpu->ACC = temp;                                                            \
+    DECOMPILE_PRINT(base_PC, "ADC %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_ADC)
 
 /**
  * @brief (Add immediate with carry)
@@ -1120,13 +965,13 @@ int ADC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * @return int 
  */
 int ACI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint16_t temp = mem_read(&cpu->mem, base_PC+1);
-    temp += cpu->ACC + cpu->PSW.carry;
+    uint16_t temp = mem_fetch(&cpu->mem, base_PC+1);
+    temp += cpu->ACC + psw_carry(&cpu->PSW);
     // Set Flags
     set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, mem_read(&cpu->mem, base_PC+1) + cpu->PSW.carry);
+    aux_flag_set_add(cpu, cpu->ACC, mem_fetch(&cpu->mem, base_PC+1) + psw_carry(&cpu->PSW));
     cpu->ACC = temp;
-    DECOMPILE_PRINT(base_PC, "ACI %x\n", mem_read(&cpu->mem, base_PC+1));
+    DECOMPILE_PRINT(base_PC, "ACI %x\n", mem_fetch(&cpu->mem, base_PC+1));
     return 1;
 }
 
@@ -1135,22 +980,20 @@ int ACI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * (A) <-- (A) - (r)
  * The content of register r is subtracted from the content 
  * of the accumulator. The result is placed in the accumulator.
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * 
+ * @param reg register the handler is generated for
  */
-int SUB_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x07);
-    uint16_t temp = cpu->ACC;
-    temp -= *(ref_byte_reg(cpu, reg_patt));
-    // Set Flags
-    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, - (*(ref_byte_reg(cpu, reg_patt))));
-    cpu->ACC = temp;
-    DECOMPILE_PRINT(base_PC, "SUB REG(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_SUB(reg)                                                         \
+OP_HANDLER(SUB_##reg##_WRAP){                                                   \
+    uint8_t src = READ_##reg(cpu);                                              \
+    uint16_t temp = cpu->ACC - src;                                             \
+    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);                                     \
+    aux_flag_set_add(cpu, cpu->ACC, -src);                                      \
+    cpu->ACC = temp;                                                            \
+    DECOMPILE_PRINT(base_PC, "SUB %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_SUB)
 
 /**
  * @brief (Subtract immediate)
@@ -1166,12 +1009,12 @@ int SUB_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  */
 int SUI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
     uint16_t temp = cpu->ACC;
-    temp -= mem_read(&cpu->mem, base_PC+1);
+    temp -= mem_fetch(&cpu->mem, base_PC+1);
     // Set Flags
     set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, - (mem_read(&cpu->mem, base_PC+1)));
+    aux_flag_set_add(cpu, cpu->ACC, - (mem_fetch(&cpu->mem, base_PC+1)));
     cpu->ACC = temp;
-    DECOMPILE_PRINT(base_PC, "SUI %x\n", mem_read(&cpu->mem, base_PC+1));
+    DECOMPILE_PRINT(base_PC, "SUI %x\n", mem_fetch(&cpu->mem, base_PC+1));
     return 1;
 }
 
@@ -1182,22 +1025,19 @@ int SUI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * flag are both subtracted from the accumulator. The
  * result is placed in the accumulator.
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int SBB_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x07);
-    uint16_t temp = cpu->ACC;
-    temp -= (*(ref_byte_reg(cpu, reg_patt)) + cpu->PSW.carry);
-    // Set Flags
-    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    aux_flag_set_add(cpu, cpu->ACC, - (*(ref_byte_reg(cpu, reg_patt))) - 1);
-    cpu->ACC = temp;
-    DECOMPILE_PRINT(base_PC, "SBB REG(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_SBB(reg)                                                         \
+OP_HANDLER(SBB_##reg##_WRAP){                                                   \
+    uint8_t src = READ_##reg(cpu);                                              \
+    uint16_t temp = cpu->ACC - (src + psw_carry(&cpu->PSW));                    \
+    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);                                     \
+    aux_flag_set_add(cpu, cpu->ACC, -src - 1);                                  \
+    cpu->ACC = temp;                                                            \
+    DECOMPILE_PRINT(base_PC, "SBB %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_SBB)
 
 /**
  * @brief (OR Register)
@@ -1206,22 +1046,17 @@ int SBB_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
  * content of the accumulator. The result is placed in
  * the accumulator. The CY and AC flags are cleared.
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param reg register the handler is generated for
  */
-int ORA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    uint8_t reg_patt = (op_code & 0x07);
-    uint8_t *target_reg = ref_byte_reg(cpu, reg_patt);
-    uint16_t temp = (*target_reg) | cpu->ACC;
-    cpu->ACC = temp;
-    // Setting flags
-    set_flags(cpu, temp, ALL_BUT_AUX_FLAG);
-    cpu->PSW.aux = 0;
-    DECOMPILE_PRINT(base_PC, "ORA Reg(%x)\n", reg_patt);
-    return 1;
+#define DEFINE_ORA(reg)                                                         \
+OP_HANDLER(ORA_##reg##_WRAP){                                                   \
+    cpu->ACC |= READ_##reg(cpu);                                                \
+    set_flags(cpu, cpu->ACC, ALL_BUT_AUX_FLAG);                                 \
+    psw_set_aux(&cpu->PSW, 0);                                                  \
+    DECOMPILE_PRINT(base_PC, "ORA %s\n", #reg);                                 \
+    return 1;                                                                   \
 }
+BYTE_OPERANDS(DEFINE_ORA)
 
 /**
  * @brief (Exchange stack top with Hand L)
@@ -1274,10 +1109,10 @@ int PCHL_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int ORI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-     uint8_t target_data = mem_read(&cpu->mem, base_PC+1);
+     uint8_t target_data = mem_fetch(&cpu->mem, base_PC+1);
     cpu->ACC |= target_data;
     set_flags(cpu, cpu->ACC, ALL_BUT_AUX_FLAG);
-    cpu->PSW.aux = 0;
+    psw_set_aux(&cpu->PSW, 0);
     DECOMPILE_PRINT(base_PC, "ORI %x\n", target_data);
     return 1;
 }
@@ -1296,10 +1131,10 @@ int ORI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int XRI_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    uint8_t target_data = mem_read(&cpu->mem, base_PC+1);
+    uint8_t target_data = mem_fetch(&cpu->mem, base_PC+1);
     cpu->ACC ^= target_data;
     set_flags(cpu, cpu->ACC, ALL_BUT_AUX_FLAG);
-    cpu->PSW.aux = 0;
+    psw_set_aux(&cpu->PSW, 0);
     DECOMPILE_PRINT(base_PC, "XRI %x\n", target_data);
     return 1;
 }
@@ -1327,7 +1162,7 @@ int CMA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int CMC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    cpu->PSW.carry = !(cpu->PSW.carry);
+    psw_set_carry(&cpu->PSW, !psw_carry(&cpu->PSW));
     DECOMPILE_PRINT(base_PC, "%s\n", "CMC");
     return 1;
 }
@@ -1341,7 +1176,7 @@ int CMC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int STC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    cpu->PSW.carry = 1;
+    psw_set_carry(&cpu->PSW, 1);
     DECOMPILE_PRINT(base_PC, "%s\n", "STC");
     return 1;
 }
@@ -1355,22 +1190,11 @@ int STC_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * @return int 
  */
 int DAA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
-    if((cpu->ACC & 0xF) > 0x9 || cpu->PSW.aux){
-        cpu->PSW.aux = 0;
-        if(((cpu->ACC & 0xF) + 0x06) > 0xF){
-            cpu->PSW.aux = 1;
-        }
-        if((cpu->ACC + 6) & 0x100){
-            cpu->PSW.carry = 1;
-        }
-        cpu->ACC += 0x6;
-    }
-    if((cpu->ACC & 0xF0) >> 4 > 0x9 || cpu->PSW.carry == 1){
-        if(((cpu->ACC >> 4) + 0x06) > 0xF){
-            cpu->PSW.carry = 1;
-        }
-        cpu->ACC += 0x60;
-    }
+    // Only place aux is consumed, the table works out both adjustments
+    uint16_t daa = daa_lookup[cpu->ACC | (psw_carry(&cpu->PSW) << 8) | (psw_aux(&cpu->PSW) << 9)];
+    cpu->ACC = daa;
+    psw_set_aux(&cpu->PSW, daa >> 9);               // DAA_AUX
+    psw_set_cy_res(&cpu->PSW, daa & DAA_CARRY);     // bit 8, the carry
     DECOMPILE_PRINT(base_PC, "%s\n", "DAA");
     return 1;
 }
@@ -1381,23 +1205,20 @@ int DAA_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
  * ((SP) - 2) <-- (PCl);
  * (SP) <-- (SP) - 2;
  * (PC) <-- 8* (NNN);
+ * Also used to enter interrupt handlers, through opcode_lookup.
  * 
- * @param cpu 
- * @param base_PC 
- * @param op_code 
- * @return int 
+ * @param nnn restart vector the handler is generated for
  */
-int RST_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, uint8_t op_code){
-    cpu->SP -= 2;
-    short_mem_write(&cpu->mem, cpu->SP, cpu->PC);       // Saving Return Addr
-    // Generating new position
-    uint16_t target_addr = ((op_code & 0x38) >> 3);     // Generate new target Addr
-    cpu->PC = target_addr * 8;                          // Writing New PC
-    cpu->intt = 0;                                      // Disable Interrupts when execing Intt
-    // NOTE: This will be enabled by the INTT handler function.
-    DECOMPILE_PRINT(base_PC, "RST %x\n", target_addr);  // Logging
-    return 1;
+#define DEFINE_RST(nnn)                                                         \
+OP_HANDLER(RST_##nnn##_WRAP){                                                   \
+    cpu->SP -= 2;                                                               \
+    short_mem_write(&cpu->mem, cpu->SP, cpu->PC);                               \
+    cpu->PC = (nnn) * 8;                                                        \
+    cpu->intt = 0;                                                              \
+    DECOMPILE_PRINT(base_PC, "RST %x\n", nnn);                                  \
+    return 1;                                                                   \
 }
+RST_VECTORS(DEFINE_RST)
 
 /**
  * @brief (Exchange stack top with H and L)
@@ -1425,268 +1246,270 @@ int SPHL_WRAP(cpu_state* cpu, UNUSED uint16_t base_PC, UNUSED uint8_t op_code){
 
 /**
  * @brief A jump table indexed by an Intel 8080 instruction
- * opcode, containing:
+ * opcode, with every opcode bound to its own specialised handler,
+ * containing:
  * - functor = function pointer
  * - cycle_count = number of instruction it takes 8080 to exec
+ *   (for conditional CALL/RET, the not taken count)
  * - Instruction length [1,3]
  */
-instt_8080_op opcode_lookup[0x100] = {
+const instt_8080_op opcode_lookup[0x100] = {
     [0x00] = {.target_func = NOP_WRAP, .cycle_count = 4, .size = 1},   // NOP Instruction
-    [0x01] = {LXI_WRAP, 10, 3},
-    [0x02] = {STAX_WRAP, 7, 1},
-    [0x03] = {INX_WRAP, 5, 1},
-    [0x04] = {INR_WRAP, 5, 1},
-    [0x05] = {DCR_WRAP, 5, 1},
-    [0x06] = {MVI_WRAP, 7, 2},
+    [0x01] = {LXI_BC_WRAP, 10, 3},
+    [0x02] = {STAX_BC_WRAP, 7, 1},
+    [0x03] = {INX_BC_WRAP, 5, 1},
+    [0x04] = {INR_B_WRAP, 5, 1},
+    [0x05] = {DCR_B_WRAP, 5, 1},
+    [0x06] = {MVI_B_WRAP, 7, 2},
     [0x07] = {RLC_WRAP, 7, 1},
     [0x08] = {NOP_WRAP, 4, 1},
-    [0x09] = {DAD_WRAP, 10, 1},
-    [0x0A] = {LDAX_WRAP, 7, 1},
-    [0x0B] = {DCX_WRAP, 5, 1},
-    [0x0C] = {INR_WRAP, 5, 1},
-    [0x0D] = {DCR_WRAP, 5, 1},
-    [0x0E] = {MVI_WRAP, 7, 2},
+    [0x09] = {DAD_BC_WRAP, 10, 1},
+    [0x0A] = {LDAX_BC_WRAP, 7, 1},
+    [0x0B] = {DCX_BC_WRAP, 5, 1},
+    [0x0C] = {INR_C_WRAP, 5, 1},
+    [0x0D] = {DCR_C_WRAP, 5, 1},
+    [0x0E] = {MVI_C_WRAP, 7, 2},
     [0x0F] = {RRC_WRAP, 4, 1},
     [0x10] = {NOP_WRAP, 4, 1},
-    [0x11] = {LXI_WRAP, 10, 3},
-    [0x12] = {STAX_WRAP, 7, 1},
-    [0x13] = {INX_WRAP, 5, 1},
-    [0x14] = {INR_WRAP, 5, 1},
-    [0x15] = {DCR_WRAP, 5, 1},
-    [0x16] = {MVI_WRAP, 7, 2},
+    [0x11] = {LXI_DE_WRAP, 10, 3},
+    [0x12] = {STAX_DE_WRAP, 7, 1},
+    [0x13] = {INX_DE_WRAP, 5, 1},
+    [0x14] = {INR_D_WRAP, 5, 1},
+    [0x15] = {DCR_D_WRAP, 5, 1},
+    [0x16] = {MVI_D_WRAP, 7, 2},
     [0x17] = {RAL_WRAP, 4, 1},
     [0x18] = {NOP_WRAP, 4, 1},
-    [0x19] = {DAD_WRAP, 10, 1},
-    [0x1A] = {LDAX_WRAP, 7, 1},
-    [0x1B] = {DCX_WRAP, 5, 1},
-    [0x1C] = {INR_WRAP, 5, 1},
-    [0x1D] = {DCR_WRAP, 5, 1},
-    [0x1E] = {MVI_WRAP, 7, 2},
+    [0x19] = {DAD_DE_WRAP, 10, 1},
+    [0x1A] = {LDAX_DE_WRAP, 7, 1},
+    [0x1B] = {DCX_DE_WRAP, 5, 1},
+    [0x1C] = {INR_E_WRAP, 5, 1},
+    [0x1D] = {DCR_E_WRAP, 5, 1},
+    [0x1E] = {MVI_E_WRAP, 7, 2},
     [0x1F] = {RAR_WRAP, 4, 1},
     [0x20] = {NOP_WRAP, 4, 1},
-    [0x21] = {LXI_WRAP, 10, 3},
+    [0x21] = {LXI_HL_WRAP, 10, 3},
     [0x22] = {SHLD_WRAP, 16, 3},
-    [0x23] = {INX_WRAP, 5, 1},
-    [0x24] = {INR_WRAP, 5, 1},
-    [0x25] = {DCR_WRAP, 5, 1},
-    [0x26] = {MVI_WRAP, 7, 2},
+    [0x23] = {INX_HL_WRAP, 5, 1},
+    [0x24] = {INR_H_WRAP, 5, 1},
+    [0x25] = {DCR_H_WRAP, 5, 1},
+    [0x26] = {MVI_H_WRAP, 7, 2},
     [0x27] = {DAA_WRAP, 4, 1},
     [0x28] = {NOP_WRAP, 4, 1},
-    [0x29] = {DAD_WRAP, 10, 1},
+    [0x29] = {DAD_HL_WRAP, 10, 1},
     [0x2A] = {LHLD_WRAP, 16, 3},
-    [0x2B] = {DCX_WRAP, 5, 1},
-    [0x2C] = {INR_WRAP, 5, 1},
-    [0x2D] = {DCR_WRAP, 5, 1},
-    [0x2E] = {MVI_WRAP, 7, 2},
+    [0x2B] = {DCX_HL_WRAP, 5, 1},
+    [0x2C] = {INR_L_WRAP, 5, 1},
+    [0x2D] = {DCR_L_WRAP, 5, 1},
+    [0x2E] = {MVI_L_WRAP, 7, 2},
     [0x2F] = {CMA_WRAP, 4, 1},
     [0x30] = {NOP_WRAP, 4, 1},
-    [0x31] = {LXI_WRAP, 10, 3},
+    [0x31] = {LXI_SP_WRAP, 10, 3},
     [0x32] = {STA_WRAP, 13, 3},
-    [0x33] = {INX_WRAP, 5, 1},
-    [0x34] = {INR_WRAP, 5, 1},
-    [0x35] = {DCR_WRAP, 5, 1},
-    [0x36] = {MVI_WRAP, 10, 2},
+    [0x33] = {INX_SP_WRAP, 5, 1},
+    [0x34] = {INR_M_WRAP, 5, 1},
+    [0x35] = {DCR_M_WRAP, 5, 1},
+    [0x36] = {MVI_M_WRAP, 10, 2},
     [0x37] = {STC_WRAP, 4, 1},
     [0x38] = {NOP_WRAP, 4, 1},
-    [0x39] = {DAD_WRAP, 10, 1},
+    [0x39] = {DAD_SP_WRAP, 10, 1},
     [0x3A] = {LDA_WRAP, 13, 3},
-    [0x3B] = {DCX_WRAP, 5, 1},
-    [0x3C] = {INR_WRAP, 5, 1},
-    [0x3D] = {DCR_WRAP, 5, 1},
-    [0x3E] = {MVI_WRAP, 7, 2},
+    [0x3B] = {DCX_SP_WRAP, 5, 1},
+    [0x3C] = {INR_A_WRAP, 5, 1},
+    [0x3D] = {DCR_A_WRAP, 5, 1},
+    [0x3E] = {MVI_A_WRAP, 7, 2},
     [0x3F] = {CMC_WRAP, 4, 1},
-    [0x40] = {MOV_WRAP, 5, 1},
-    [0x41] = {MOV_WRAP, 5, 1},
-    [0x42] = {MOV_WRAP, 5, 1},
-    [0x43] = {MOV_WRAP, 5, 1},
-    [0x44] = {MOV_WRAP, 5, 1},
-    [0x45] = {MOV_WRAP, 5, 1},
-    [0x46] = {MOV_WRAP, 5, 1},
-    [0x47] = {MOV_WRAP, 5, 1},
-    [0x48] = {MOV_WRAP, 5, 1},
-    [0x49] = {MOV_WRAP, 5, 1},
-    [0x4A] = {MOV_WRAP, 5, 1},
-    [0x4B] = {MOV_WRAP, 5, 1},
-    [0x4C] = {MOV_WRAP, 5, 1},
-    [0x4D] = {MOV_WRAP, 5, 1},
-    [0x4E] = {MOV_WRAP, 5, 1},
-    [0x4F] = {MOV_WRAP, 5, 1},
-    [0x50] = {MOV_WRAP, 5, 1},
-    [0x51] = {MOV_WRAP, 5, 1},
-    [0x52] = {MOV_WRAP, 5, 1},
-    [0x53] = {MOV_WRAP, 5, 1},
-    [0x54] = {MOV_WRAP, 5, 1},
-    [0x55] = {MOV_WRAP, 5, 1},
-    [0x56] = {MOV_WRAP, 5, 1},
-    [0x57] = {MOV_WRAP, 5, 1},
-    [0x58] = {MOV_WRAP, 5, 1},
-    [0x59] = {MOV_WRAP, 5, 1},
-    [0x5A] = {MOV_WRAP, 5, 1},
-    [0x5B] = {MOV_WRAP, 5, 1},
-    [0x5C] = {MOV_WRAP, 5, 1},
-    [0x5D] = {MOV_WRAP, 5, 1},
-    [0x5E] = {MOV_WRAP, 5, 1},
-    [0x5F] = {MOV_WRAP, 5, 1},
-    [0x60] = {MOV_WRAP, 5, 1},
-    [0x61] = {MOV_WRAP, 5, 1},
-    [0x62] = {MOV_WRAP, 5, 1},
-    [0x63] = {MOV_WRAP, 5, 1},
-    [0x64] = {MOV_WRAP, 5, 1},
-    [0x65] = {MOV_WRAP, 5, 1},
-    [0x66] = {MOV_WRAP, 5, 1},
-    [0x67] = {MOV_WRAP, 5, 1},
-    [0x68] = {MOV_WRAP, 5, 1},
-    [0x69] = {MOV_WRAP, 5, 1},
-    [0x6A] = {MOV_WRAP, 5, 1},
-    [0x6B] = {MOV_WRAP, 5, 1},
-    [0x6C] = {MOV_WRAP, 5, 1},
-    [0x6D] = {MOV_WRAP, 5, 1},
-    [0x6E] = {MOV_WRAP, 5, 1},
-    [0x6F] = {MOV_WRAP, 5, 1},
-    [0x70] = {MOV_WRAP, 5, 1},
-    [0x71] = {MOV_WRAP, 5, 1},
-    [0x72] = {MOV_WRAP, 5, 1},
-    [0x73] = {MOV_WRAP, 5, 1},
-    [0x74] = {MOV_WRAP, 5, 1},
-    [0x75] = {MOV_WRAP, 5, 1},
+    [0x40] = {MOV_B_B_WRAP, 5, 1},
+    [0x41] = {MOV_B_C_WRAP, 5, 1},
+    [0x42] = {MOV_B_D_WRAP, 5, 1},
+    [0x43] = {MOV_B_E_WRAP, 5, 1},
+    [0x44] = {MOV_B_H_WRAP, 5, 1},
+    [0x45] = {MOV_B_L_WRAP, 5, 1},
+    [0x46] = {MOV_B_M_WRAP, 5, 1},
+    [0x47] = {MOV_B_A_WRAP, 5, 1},
+    [0x48] = {MOV_C_B_WRAP, 5, 1},
+    [0x49] = {MOV_C_C_WRAP, 5, 1},
+    [0x4A] = {MOV_C_D_WRAP, 5, 1},
+    [0x4B] = {MOV_C_E_WRAP, 5, 1},
+    [0x4C] = {MOV_C_H_WRAP, 5, 1},
+    [0x4D] = {MOV_C_L_WRAP, 5, 1},
+    [0x4E] = {MOV_C_M_WRAP, 5, 1},
+    [0x4F] = {MOV_C_A_WRAP, 5, 1},
+    [0x50] = {MOV_D_B_WRAP, 5, 1},
+    [0x51] = {MOV_D_C_WRAP, 5, 1},
+    [0x52] = {MOV_D_D_WRAP, 5, 1},
+    [0x53] = {MOV_D_E_WRAP, 5, 1},
+    [0x54] = {MOV_D_H_WRAP, 5, 1},
+    [0x55] = {MOV_D_L_WRAP, 5, 1},
+    [0x56] = {MOV_D_M_WRAP, 5, 1},
+    [0x57] = {MOV_D_A_WRAP, 5, 1},
+    [0x58] = {MOV_E_B_WRAP, 5, 1},
+    [0x59] = {MOV_E_C_WRAP, 5, 1},
+    [0x5A] = {MOV_E_D_WRAP, 5, 1},
+    [0x5B] = {MOV_E_E_WRAP, 5, 1},
+    [0x5C] = {MOV_E_H_WRAP, 5, 1},
+    [0x5D] = {MOV_E_L_WRAP, 5, 1},
+    [0x5E] = {MOV_E_M_WRAP, 5, 1},
+    [0x5F] = {MOV_E_A_WRAP, 5, 1},
+    [0x60] = {MOV_H_B_WRAP, 5, 1},
+    [0x61] = {MOV_H_C_WRAP, 5, 1},
+    [0x62] = {MOV_H_D_WRAP, 5, 1},
+    [0x63] = {MOV_H_E_WRAP, 5, 1},
+    [0x64] = {MOV_H_H_WRAP, 5, 1},
+    [0x65] = {MOV_H_L_WRAP, 5, 1},
+    [0x66] = {MOV_H_M_WRAP, 5, 1},
+    [0x67] = {MOV_H_A_WRAP, 5, 1},
+    [0x68] = {MOV_L_B_WRAP, 5, 1},
+    [0x69] = {MOV_L_C_WRAP, 5, 1},
+    [0x6A] = {MOV_L_D_WRAP, 5, 1},
+    [0x6B] = {MOV_L_E_WRAP, 5, 1},
+    [0x6C] = {MOV_L_H_WRAP, 5, 1},
+    [0x6D] = {MOV_L_L_WRAP, 5, 1},
+    [0x6E] = {MOV_L_M_WRAP, 5, 1},
+    [0x6F] = {MOV_L_A_WRAP, 5, 1},
+    [0x70] = {MOV_M_B_WRAP, 5, 1},
+    [0x71] = {MOV_M_C_WRAP, 5, 1},
+    [0x72] = {MOV_M_D_WRAP, 5, 1},
+    [0x73] = {MOV_M_E_WRAP, 5, 1},
+    [0x74] = {MOV_M_H_WRAP, 5, 1},
+    [0x75] = {MOV_M_L_WRAP, 5, 1},
     [0x76] = {HLT_WRAP, 7, 1},
-    [0x77] = {MOV_WRAP, 5, 1},
-    [0x78] = {MOV_WRAP, 5, 1},
-    [0x79] = {MOV_WRAP, 5, 1},
-    [0x7A] = {MOV_WRAP, 5, 1},
-    [0x7B] = {MOV_WRAP, 5, 1},
-    [0x7C] = {MOV_WRAP, 5, 1},
-    [0x7D] = {MOV_WRAP, 5, 1},
-    [0x7E] = {MOV_WRAP, 5, 1},
-    [0x7F] = {MOV_WRAP, 5, 1},
-    [0x80] = {ADD_WRAP, 4, 1},
-    [0x81] = {ADD_WRAP, 4, 1},
-    [0x82] = {ADD_WRAP, 4, 1},
-    [0x83] = {ADD_WRAP, 4, 1},
-    [0x84] = {ADD_WRAP, 4, 1},
-    [0x85] = {ADD_WRAP, 4, 1},
-    [0x86] = {ADD_WRAP, 4, 1},
-    [0x87] = {ADD_WRAP, 4, 1},
-    [0x88] = {ADC_WRAP, 4, 1},
-    [0x89] = {ADC_WRAP, 4, 1},
-    [0x8A] = {ADC_WRAP, 4, 1},
-    [0x8B] = {ADC_WRAP, 4, 1},
-    [0x8C] = {ADC_WRAP, 4, 1},
-    [0x8D] = {ADC_WRAP, 4, 1},
-    [0x8E] = {ADC_WRAP, 4, 1},
-    [0x8F] = {ADC_WRAP, 4, 1},
-    [0x90] = {SUB_WRAP, 4, 1},
-    [0x91] = {SUB_WRAP, 4, 1},
-    [0x92] = {SUB_WRAP, 4, 1},
-    [0x93] = {SUB_WRAP, 4, 1},
-    [0x94] = {SUB_WRAP, 4, 1},
-    [0x95] = {SUB_WRAP, 4, 1},
-    [0x96] = {SUB_WRAP, 4, 1},
-    [0x97] = {SUB_WRAP, 4, 1},
-    [0x98] = {SBB_WRAP, 4, 1},
-    [0x99] = {SBB_WRAP, 4, 1},
-    [0x9A] = {SBB_WRAP, 4, 1},
-    [0x9B] = {SBB_WRAP, 4, 1},
-    [0x9C] = {SBB_WRAP, 4, 1},
-    [0x9D] = {SBB_WRAP, 4, 1},
-    [0x9E] = {SBB_WRAP, 4, 1},
-    [0x9F] = {SBB_WRAP, 4, 1},
-    [0xA0] = {ANA_WRAP, 4, 1},
-    [0xA1] = {ANA_WRAP, 4, 1},
-    [0xA2] = {ANA_WRAP, 4, 1},
-    [0xA3] = {ANA_WRAP, 4, 1},
-    [0xA4] = {ANA_WRAP, 4, 1},
-    [0xA5] = {ANA_WRAP, 4, 1},
-    [0xA6] = {ANA_WRAP, 4, 1},
-    [0xA7] = {ANA_WRAP, 4, 1},
-    [0xA8] = {XRA_WRAP, 4, 1},
-    [0xA9] = {XRA_WRAP, 4, 1},
-    [0xAA] = {XRA_WRAP, 4, 1},
-    [0xAB] = {XRA_WRAP, 4, 1},
-    [0xAC] = {XRA_WRAP, 4, 1},
-    [0xAD] = {XRA_WRAP, 4, 1},
-    [0xAE] = {XRA_WRAP, 4, 1},
-    [0xAF] = {XRA_WRAP, 4, 1},
-    [0xB0] = {ORA_WRAP, 4, 1},
-    [0xB1] = {ORA_WRAP, 4, 1},
-    [0xB2] = {ORA_WRAP, 4, 1},
-    [0xB3] = {ORA_WRAP, 4, 1},
-    [0xB4] = {ORA_WRAP, 4, 1},
-    [0xB5] = {ORA_WRAP, 4, 1},
-    [0xB6] = {ORA_WRAP, 4, 1},
-    [0xB7] = {ORA_WRAP, 4, 1},
-    [0xB8] = {CMP_WRAP, 4, 1},
-    [0xB9] = {CMP_WRAP, 4, 1},
-    [0xBA] = {CMP_WRAP, 4, 1},
-    [0xBB] = {CMP_WRAP, 4, 1},
-    [0xBC] = {CMP_WRAP, 4, 1},
-    [0xBD] = {CMP_WRAP, 4, 1},
-    [0xBE] = {CMP_WRAP, 4, 1},
-    [0xBF] = {CMP_WRAP, 4, 1},
-    [0xC0] = {RCon_WRAP, 11, 1},
-    [0xC1] = {POP_WRAP, 10, 1},
-    [0xC2] = {JCon_WRAP, 10, 3},
+    [0x77] = {MOV_M_A_WRAP, 5, 1},
+    [0x78] = {MOV_A_B_WRAP, 5, 1},
+    [0x79] = {MOV_A_C_WRAP, 5, 1},
+    [0x7A] = {MOV_A_D_WRAP, 5, 1},
+    [0x7B] = {MOV_A_E_WRAP, 5, 1},
+    [0x7C] = {MOV_A_H_WRAP, 5, 1},
+    [0x7D] = {MOV_A_L_WRAP, 5, 1},
+    [0x7E] = {MOV_A_M_WRAP, 5, 1},
+    [0x7F] = {MOV_A_A_WRAP, 5, 1},
+    [0x80] = {ADD_B_WRAP, 4, 1},
+    [0x81] = {ADD_C_WRAP, 4, 1},
+    [0x82] = {ADD_D_WRAP, 4, 1},
+    [0x83] = {ADD_E_WRAP, 4, 1},
+    [0x84] = {ADD_H_WRAP, 4, 1},
+    [0x85] = {ADD_L_WRAP, 4, 1},
+    [0x86] = {ADD_M_WRAP, 4, 1},
+    [0x87] = {ADD_A_WRAP, 4, 1},
+    [0x88] = {ADC_B_WRAP, 4, 1},
+    [0x89] = {ADC_C_WRAP, 4, 1},
+    [0x8A] = {ADC_D_WRAP, 4, 1},
+    [0x8B] = {ADC_E_WRAP, 4, 1},
+    [0x8C] = {ADC_H_WRAP, 4, 1},
+    [0x8D] = {ADC_L_WRAP, 4, 1},
+    [0x8E] = {ADC_M_WRAP, 4, 1},
+    [0x8F] = {ADC_A_WRAP, 4, 1},
+    [0x90] = {SUB_B_WRAP, 4, 1},
+    [0x91] = {SUB_C_WRAP, 4, 1},
+    [0x92] = {SUB_D_WRAP, 4, 1},
+    [0x93] = {SUB_E_WRAP, 4, 1},
+    [0x94] = {SUB_H_WRAP, 4, 1},
+    [0x95] = {SUB_L_WRAP, 4, 1},
+    [0x96] = {SUB_M_WRAP, 4, 1},
+    [0x97] = {SUB_A_WRAP, 4, 1},
+    [0x98] = {SBB_B_WRAP, 4, 1},
+    [0x99] = {SBB_C_WRAP, 4, 1},
+    [0x9A] = {SBB_D_WRAP, 4, 1},
+    [0x9B] = {SBB_E_WRAP, 4, 1},
+    [0x9C] = {SBB_H_WRAP, 4, 1},
+    [0x9D] = {SBB_L_WRAP, 4, 1},
+    [0x9E] = {SBB_M_WRAP, 4, 1},
+    [0x9F] = {SBB_A_WRAP, 4, 1},
+    [0xA0] = {ANA_B_WRAP, 4, 1},
+    [0xA1] = {ANA_C_WRAP, 4, 1},
+    [0xA2] = {ANA_D_WRAP, 4, 1},
+    [0xA3] = {ANA_E_WRAP, 4, 1},
+    [0xA4] = {ANA_H_WRAP, 4, 1},
+    [0xA5] = {ANA_L_WRAP, 4, 1},
+    [0xA6] = {ANA_M_WRAP, 4, 1},
+    [0xA7] = {ANA_A_WRAP, 4, 1},
+    [0xA8] = {XRA_B_WRAP, 4, 1},
+    [0xA9] = {XRA_C_WRAP, 4, 1},
+    [0xAA] = {XRA_D_WRAP, 4, 1},
+    [0xAB] = {XRA_E_WRAP, 4, 1},
+    [0xAC] = {XRA_H_WRAP, 4, 1},
+    [0xAD] = {XRA_L_WRAP, 4, 1},
+    [0xAE] = {XRA_M_WRAP, 4, 1},
+    [0xAF] = {XRA_A_WRAP, 4, 1},
+    [0xB0] = {ORA_B_WRAP, 4, 1},
+    [0xB1] = {ORA_C_WRAP, 4, 1},
+    [0xB2] = {ORA_D_WRAP, 4, 1},
+    [0xB3] = {ORA_E_WRAP, 4, 1},
+    [0xB4] = {ORA_H_WRAP, 4, 1},
+    [0xB5] = {ORA_L_WRAP, 4, 1},
+    [0xB6] = {ORA_M_WRAP, 4, 1},
+    [0xB7] = {ORA_A_WRAP, 4, 1},
+    [0xB8] = {CMP_B_WRAP, 4, 1},
+    [0xB9] = {CMP_C_WRAP, 4, 1},
+    [0xBA] = {CMP_D_WRAP, 4, 1},
+    [0xBB] = {CMP_E_WRAP, 4, 1},
+    [0xBC] = {CMP_H_WRAP, 4, 1},
+    [0xBD] = {CMP_L_WRAP, 4, 1},
+    [0xBE] = {CMP_M_WRAP, 4, 1},
+    [0xBF] = {CMP_A_WRAP, 4, 1},
+    [0xC0] = {RNZ_WRAP, 5, 1},
+    [0xC1] = {POP_BC_WRAP, 10, 1},
+    [0xC2] = {JNZ_WRAP, 10, 3},
     [0xC3] = {JMP_WRAP, 10, 3},
-    [0xC4] = {CCon_WRAP, 17, 3},
-    [0xC5] = {PUSH_WRAP, 11, 1},
+    [0xC4] = {CNZ_WRAP, 11, 3},
+    [0xC5] = {PUSH_BC_WRAP, 11, 1},
     [0xC6] = {ADI_WRAP, 7, 2},
-    [0xC7] = {RST_WRAP, 11, 1},
-    [0xC8] = {RCon_WRAP, 11, 1},
+    [0xC7] = {RST_0_WRAP, 11, 1},
+    [0xC8] = {RZ_WRAP, 5, 1},
     [0xC9] = {RET_WRAP, 10, 1},
-    [0xCA] = {JCon_WRAP, 10, 3},
-    [0xCB] = {JMP_WRAP, 10, 3},
-    [0xCC] = {CCon_WRAP, 17, 3},
+    [0xCA] = {JZ_WRAP, 10, 3},
+    [0xCB] = {JMP_UNDOC_WRAP, 10, 3},
+    [0xCC] = {CZ_WRAP, 11, 3},
     [0xCD] = {CALL_WRAP, 17, 3},
     [0xCE] = {ACI_WRAP, 7, 2},
-    [0xCF] = {RST_WRAP, 11, 1},
-    [0xD0] = {RCon_WRAP, 11, 1},
-    [0xD1] = {POP_WRAP, 10, 1},
-    [0xD2] = {JCon_WRAP, 10, 3},
+    [0xCF] = {RST_1_WRAP, 11, 1},
+    [0xD0] = {RNC_WRAP, 5, 1},
+    [0xD1] = {POP_DE_WRAP, 10, 1},
+    [0xD2] = {JNC_WRAP, 10, 3},
     [0xD3] = {OUT_WRAP, 10, 2},
-    [0xD4] = {CCon_WRAP, 17, 3},
-    [0xD5] = {PUSH_WRAP, 11, 1},
+    [0xD4] = {CNC_WRAP, 11, 3},
+    [0xD5] = {PUSH_DE_WRAP, 11, 1},
     [0xD6] = {SUI_WRAP, 7, 2},
-    [0xD7] = {RST_WRAP, 11, 1},
-    [0xD8] = {RCon_WRAP, 11, 1},
-    [0xD9] = {RET_WRAP, 10, 1},
-    [0xDA] = {JCon_WRAP, 10, 3},
+    [0xD7] = {RST_2_WRAP, 11, 1},
+    [0xD8] = {RC_WRAP, 5, 1},
+    [0xD9] = {RET_UNDOC_WRAP, 10, 1},
+    [0xDA] = {JC_WRAP, 10, 3},
     [0xDB] = {IN_WRAP, 10, 2},
-    [0xDC] = {CCon_WRAP, 17, 3},
-    [0xDD] = {CALL_WRAP, 17, 3},
+    [0xDC] = {CC_WRAP, 11, 3},
+    [0xDD] = {CALL_UNDOC_WRAP, 17, 3},
     [0xDE] = {SBI_WRAP, 7, 2},
-    [0xDF] = {RST_WRAP, 11, 1},
-    [0xE0] = {RCon_WRAP, 11, 1},
-    [0xE1] = {POP_WRAP, 10, 1},
-    [0xE2] = {JCon_WRAP, 10, 3},
+    [0xDF] = {RST_3_WRAP, 11, 1},
+    [0xE0] = {RPO_WRAP, 5, 1},
+    [0xE1] = {POP_HL_WRAP, 10, 1},
+    [0xE2] = {JPO_WRAP, 10, 3},
     [0xE3] = {XTHL_WRAP, 18, 1},
-    [0xE4] = {CCon_WRAP, 17, 3},
-    [0xE5] = {PUSH_WRAP, 11, 1},
+    [0xE4] = {CPO_WRAP, 11, 3},
+    [0xE5] = {PUSH_HL_WRAP, 11, 1},
     [0xE6] = {ANI_WRAP, 7, 2},
-    [0xE7] = {RST_WRAP, 11, 1},
-    [0xE8] = {RCon_WRAP, 11, 1},
+    [0xE7] = {RST_4_WRAP, 11, 1},
+    [0xE8] = {RPE_WRAP, 5, 1},
     [0xE9] = {PCHL_WRAP, 5, 1},
-    [0xEA] = {JCon_WRAP, 10, 3},
+    [0xEA] = {JPE_WRAP, 10, 3},
     [0xEB] = {XCHG_WRAP, 5, 1},
-    [0xEC] = {CCon_WRAP, 17, 3},
-    [0xED] = {CALL_WRAP, 17, 3},
+    [0xEC] = {CPE_WRAP, 11, 3},
+    [0xED] = {CALL_UNDOC_WRAP, 17, 3},
     [0xEE] = {XRI_WRAP, 7, 2},
-    [0xEF] = {RST_WRAP, 11, 1},
-    [0xF0] = {RCon_WRAP, 11, 1},
-    [0xF1] = {POP_WRAP, 10, 1},
-    [0xF2] = {JCon_WRAP, 10, 3},
+    [0xEF] = {RST_5_WRAP, 11, 1},
+    [0xF0] = {RP_WRAP, 5, 1},
+    [0xF1] = {POP_PSW_WRAP, 10, 1},
+    [0xF2] = {JP_WRAP, 10, 3},
     [0xF3] = {DI_WRAP, 4, 1},
-    [0xF4] = {CCon_WRAP, 17, 3},
-    [0xF5] = {PUSH_WRAP, 11, 1},
+    [0xF4] = {CP_WRAP, 11, 3},
+    [0xF5] = {PUSH_PSW_WRAP, 11, 1},
     [0xF6] = {ORI_WRAP, 7, 2},
-    [0xF7] = {RST_WRAP, 11, 1},
-    [0xF8] = {RCon_WRAP, 11, 1},
+    [0xF7] = {RST_6_WRAP, 11, 1},
+    [0xF8] = {RM_WRAP, 5, 1},
     [0xF9] = {SPHL_WRAP, 5, 1},
-    [0xFA] = {JCon_WRAP, 10, 3},
+    [0xFA] = {JM_WRAP, 10, 3},
     [0xFB] = {EI_WRAP, 4, 1},
-    [0xFC] = {CCon_WRAP, 17, 3},
-    [0xFD] = {CALL_WRAP, 17, 3},
+    [0xFC] = {CM_WRAP, 11, 3},
+    [0xFD] = {CALL_UNDOC_WRAP, 17, 3},
     [0xFE] = {CPI_WRAP, 7, 2},
-    [0xFF] = {RST_WRAP, 11, 1},
+    [0xFF] = {RST_7_WRAP, 11, 1},
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+/**
+ * @file pcache_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Persistent code cache. What the engine decoded out of the ROM
+ * (the block engine's predecoded blocks, the JIT's translated block
+ * starts) is saved to a file keyed by a hash of the ROM and the engine's
+ * cache version, so the next run mmaps it and starts warm instead of
+ * decoding and profiling its way there again. Files of another ROM,
+ * engine or version, or damaged ones, are ignored and rewritten on save.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef PCACHE_8080_H
+#define PCACHE_8080_H
+
+#include <inttypes.h>
+#include "cpu_8080.h"
+
+#if defined(ENGINE_BLOCK) || (defined(ENGINE_JIT) && defined(__x86_64__) && defined(__linux__))
+/** Defined when the engine has anything to keep in the file */
+#define PCACHE_ENGINE
+#endif
+
+/**
+ * @brief Warms the cpu's code cache up from the file at path. Call once
+ * the ROM (cpu->rom_size bytes from 0) is in memory and after anything
+ * flushing the code cache, such as hle_enable.
+ *
+ * @param cpu
+ * @param path
+ * @return uint8_t 1 if loaded, 0 if missing, stale, damaged or the
+ * engine keeps no code cache
+ */
+uint8_t pcache_load(cpu_state* cpu, const char* path);
+
+/**
+ * @brief Saves the cpu's code cache lying within the ROM to path. The
+ * file is written aside and renamed over path, so runs sharing it only
+ * ever map whole files.
+ *
+ * @param cpu
+ * @param path
+ * @return uint8_t 1 if saved, 0 if there was nothing to save or it failed
+ */
+uint8_t pcache_save(cpu_state* cpu, const char* path);
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * @file ref_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Reference model of the 8080 the fuzzer checks everything
+ * against: the opcode handlers as they were before the lazy PSW, flat
+ * register file and per operand specialisation, with eager flags and
+ * their own copy of set_flags, aux_flag_set_add and DAA. It's frozen,
+ * nothing else builds on it, so a change to the handlers or an engine
+ * can't move the model along with it.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef REF_8080_H
+#define REF_8080_H
+
+#include <inttypes.h>
+#include "cpu_8080.h"
+
+/**
+ * @brief Runs the model on cpu until at least budget clock cycles have
+ * been charged, as interp_run_cycles does. Registers, flags, interrupt
+ * state and the counters are taken from cpu and put back after.
+ *
+ * @param cpu whose mem.base is a flat 64KB of guest memory, read and
+ * written directly
+ * @param budget clock cycles to run for
+ * @return int 1 if the budget was used up, 0 if the cpu halted, -1 if fail
+ */
+int ref_run_cycles(cpu_state* cpu, uint32_t budget);
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file sched_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Emulated time event scheduler. Events are keyed by the cycle
+ * count they are due at and kept on a small timing wheel. sched_run runs
+ * the cpu in slices which end on the next deadline, so everything an
+ * event does (raising pend_intt, drawing a frame) happens at the same
+ * emulated cycle whatever the host load.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef SCHED_8080_H
+#define SCHED_8080_H
+
+#include <inttypes.h>
+#include "cpu_8080.h"
+
+#define SCHED_SLOTS         16                      /** Buckets on the wheel */
+#define SCHED_SLOT_CYCLES   (CYCLES_PER_FRAME / 8)  /** Cycles each bucket spans */
+#define SCHED_NEVER         UINT64_MAX              /** Deadline with nothing scheduled */
+
+typedef struct sched_event sched_event;
+typedef struct scheduler scheduler;
+
+/**
+ * @brief Called once the cpu reached the event's cycle. It may put the
+ * event (or any other) back on the wheel with sched_at.
+ */
+typedef void (*sched_cb)(scheduler* sched, cpu_state* cpu, sched_event* event);
+
+/**
+ * @brief An event, owned by the caller and linked into the wheel while
+ * scheduled
+ */
+struct sched_event {
+    uint64_t when;      /**< Cycle count it is due at */
+    sched_cb cb;
+    void* ctx;          /**< For cb */
+    sched_event* next;  /**< Next event in the same bucket, by when */
+};
+
+/**
+ * @brief Timing wheel, events land in bucket (when / SCHED_SLOT_CYCLES)
+ * % SCHED_SLOTS, sorted. Ones further out than a turn share the bucket
+ * and wait behind the nearer ones.
+ */
+struct scheduler {
+    sched_event* wheel[SCHED_SLOTS];
+    uint64_t next;      /**< Earliest deadline on the wheel, SCHED_NEVER if none */
+};
+
+/**
+ * @brief Empties the wheel
+ *
+ * @param sched
+ */
+void sched_init(scheduler* sched);
+
+/**
+ * @brief Schedules event at cycle count when. The event must not
+ * already be on the wheel.
+ *
+ * @param sched
+ * @param event with cb and ctx filled in
+ * @param when
+ */
+void sched_at(scheduler* sched, sched_event* event, uint64_t when);
+
+/**
+ * @brief Runs the cpu up to cycle count until, in run_cycles slices that
+ * stop at each deadline, firing the events due as it reaches them.
+ *
+ * @param sched
+ * @param cpu
+ * @param until
+ * @return int 1 if it got there, 0 if the cpu halted, -1 if it failed
+ */
+int sched_run(scheduler* sched, cpu_state* cpu, uint64_t until);
+
+#endif
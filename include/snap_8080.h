@@ -0,0 +1,137 @@
+/**
+ * @file snap_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Snapshot store for keeping many states of the same machine
+ * (search trees, rewinds, replay checkpoints). Guest memory is kept as
+ * 256 byte pages, deduplicated by content with reference counts, so a
+ * snapshot costs its registers and a page id per page; the pages which
+ * didn't change since the last snapshot cost nothing. Restoring copies
+ * back only the pages which differ from the cpu's memory.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef SNAP_8080_H
+#define SNAP_8080_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "cpu_8080.h"
+
+#define SNAP_NONE   0xFFFFFFFFu     /** No snapshot, no page */
+
+/**
+ * @brief A page of guest memory in the store
+ */
+typedef struct {
+    uint64_t hash;                  /**< Of bytes, see snap_page_hash */
+    uint32_t refs;                  /**< Snapshots holding it, 0 if the slot is free */
+    uint32_t next;                  /**< Next page in the bucket, or in the free list */
+    uint8_t bytes[MEM_PAGE_SIZE];
+} snap_page;
+
+/**
+ * @brief The cpu state a snapshot keeps next to its pages
+ */
+typedef struct {
+    uint8_t reg[8];
+    uint16_t SP;
+    uint16_t PC;
+    program_status_word PSW;
+    uint8_t intt;
+    uint8_t pend_intt;
+    uint8_t halt;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t skipped_instructions;
+    uint64_t idle_cycles;
+    uint64_t hle_cycles;
+    uint64_t loop_cycles;
+} snap_cpu;
+
+/**
+ * @brief A snapshot, its memory as page ids. Mirrors, ROM and MMIO
+ * pages aren't state and are SNAP_NONE.
+ */
+typedef struct {
+    snap_cpu cpu;
+    uint32_t pages[MEM_PAGES];
+    uint32_t next_free;             /**< Next free snapshot slot, if this one is */
+    uint8_t used;
+} snap_state;
+
+/**
+ * @brief The store. Zero it, or snap_init, before use.
+ */
+typedef struct {
+    snap_page* pages;
+    uint32_t page_count;            /**< Slots of pages in use or freed */
+    uint32_t page_cap;
+    uint32_t page_free;             /**< Freed page slots, chained through next */
+    uint32_t* buckets;              /**< Page ids by hash, chained through next */
+    uint32_t bucket_mask;
+    snap_state* snaps;
+    uint32_t snap_count;
+    uint32_t snap_cap;
+    uint32_t snap_free;             /**< Dropped snapshot slots, chained through next_free */
+    uint32_t last;                  /**< Snapshot taken last, pages are compared against it first */
+    ///@{
+    /** Counters */
+    uint32_t live_snaps;
+    uint32_t live_pages;            /**< Distinct pages held */
+    uint64_t pages_copied;          /**< Pages snap_restore wrote back */
+    ///@}
+} snap_store;
+
+/**
+ * @brief Sets up an empty store
+ *
+ * @param store
+ */
+void snap_init(snap_store* store);
+
+/**
+ * @brief Frees the store and every snapshot in it
+ *
+ * @param store
+ */
+void snap_free(snap_store* store);
+
+/**
+ * @brief Snapshots the cpu and its memory
+ *
+ * @param store
+ * @param cpu
+ * @return uint32_t the snapshot's id, SNAP_NONE if out of memory
+ */
+uint32_t snap_take(snap_store* store, cpu_state* cpu);
+
+/**
+ * @brief Puts the cpu back the way snapshot id found it. Only the pages
+ * differing from its memory are copied, the cpu's memory has to be
+ * mapped the way it was when the snapshot was taken.
+ *
+ * @param store
+ * @param id
+ * @param cpu
+ * @return uint8_t 1 if restored, 0 if there's no such snapshot
+ */
+uint8_t snap_restore(snap_store* store, uint32_t id, cpu_state* cpu);
+
+/**
+ * @brief Drops snapshot id, and the pages only it held
+ *
+ * @param store
+ * @param id
+ */
+void snap_drop(snap_store* store, uint32_t id);
+
+/**
+ * @brief Bytes the store takes for its live snapshots
+ *
+ * @param store
+ * @return size_t
+ */
+size_t snap_bytes(const snap_store* store);
+
+#endif
@@ -10,21 +10,22 @@
 #define SPACE_H
 
 #include "cpu_8080.h"
+#include "sched_8080.h"
+#include "pcache_8080.h"
+#include "vram_8080.h"
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_timer.h>
 
-#define ALIGNED_PREFIX (1<<16)  /** Prefix to get 16bit aligned memory */
 #define ROM_OFFSET  0x0     /** offset to load the ROM **/
-#define VRAM_OFFSET 0x2400  /** Location of VRAM **/
-#define VRAM_SIZE   0x1C00  /** Size of VRAM **/
-#define VRAM_DELAY  0x9     /** 112 Hz for 1000 ms */
+#define ROM_PAGES   0x20    /** 8KB of ROM from ROM_OFFSET, writes to it are dropped **/
+#define MIRROR_PAGE 0x40    /** A14/A15 aren't decoded, 0x4000 up mirrors 0x0000 **/
+#define CODE_CACHE_PATH "./build/invaders.pcache"    /** Code cache kept across runs, see pcache_8080.h **/
+#define CYCLES_PER_SLICE (CYCLES_PER_FRAME / 16) /** Cycles run between event polls */
+#define NS_PER_CYCLE (1000000000ull / CPU_CLOCK_HZ)  /** Host time one emulated cycle takes */
 #define half_1      0x2     /** Pending Intt to Call RST 1 */
 #define full_2      0x4     /** Pending Intt to Call RST 2 */
 // Invaders Stuff
 #define WINDOW_WIDTH (256)  /** Window Width, later rotated */
 #define WINDOW_HEIGHT (224) /** Window Height, later rotated */
-#define GREEN_PIXEL 0xFF00  /** RGB888 GREEN Value */
-#define BLACK_PIXEL 0x0     /** RGB888 Black Value */
 ///@{
 /** Key Mapping TODO */
 #define CREDIT_COIN SDLK_c
@@ -40,7 +41,8 @@
 
 /**
  * @brief invader window struct which keeps track of all the
- * window related state including the SDL components and timers
+ * window related state including the SDL components and the
+ * emulated time events
  * 
  */
 typedef struct {
@@ -50,7 +52,10 @@ typedef struct {
     uint32_t* pixels;       /**< Pixels below surf. Chnages on Resize */
     uint8_t quit_event;     /**< quit event triggered */
     SDL_Event event;        /**< temp event under processing */
-    SDL_TimerID vram_timer; /**< vram_time to trigger at VRAM_DELAY */
+    scheduler sched;        /**< Emulated time events */
+    sched_event half_event; /**< RST 1 at the half frame point */
+    sched_event full_event; /**< RST 2 and a redraw at the full frame point */
+    vram_tracker vram;      /**< What of VRAM the window shows, redraws go by it */
 } invaders_window;
 
 /**
@@ -83,15 +88,24 @@ typedef struct {
 } port_IO;
 
 /**
- * @brief Copies the invaders ROM into the correct memory locations.
- * The way memory is mapped is documented at: http://www.emutalk.net/threads/38177-Space-Invaders
+ * @brief Sets up the cpu's memory with the invaders ROM in the correct
+ * locations, mapped read only and shared with every other process
+ * running it. The way memory is mapped is documented at: http://www.emutalk.net/threads/38177-Space-Invaders
  * 
  * @param path to the folder containing the ROM
  * @param cpu pointer to the CPU instance executing the ROM
- * @return int -1 if fail, array of file descriptors if pass
+ * @return int 1 if loaded, 0 if not
  */
 int copy_invaders_rom(char *path, cpu_state* cpu);
 
+/**
+ * @brief Maps the invaders board's memory: ROM_PAGES of write protected
+ * ROM, then RAM, all of it mirrored every MIRROR_PAGE pages
+ *
+ * @param mem fresh from mem_init, ROM loaded
+ */
+void map_invaders(v_memory* mem);
+
 /**
  * @brief Space_IN, IN instruction function callback. Handles
  * all the `IN PORT` instruction IO
@@ -129,22 +143,34 @@ void process_key_event(SDL_KeyboardEvent key_event);
 void set_pixel(uint32_t *pixels, uint32_t x, uint32_t y, uint8_t state);
 
 /**
- * @brief Renders the Vram into the surface Pixel
+ * @brief Renders what changed in the Vram since the last frame into
+ * the surface Pixels and updates those parts of the window
  * 
  * @param cpu cpu emulating the game
- * @param pixels underlying uint32_t[] pointer for the SDL surface
+ * @param game_window window to draw on
+ */
+void render_vram(cpu_state *cpu, invaders_window *game_window);
+
+/**
+ * @brief scheduler callback which is triggered when the scan line
+ * reaches 1/2 of the display. Pends RST 1 and comes back a frame later
+ * 
+ * @param sched wheel the event lives on
+ * @param cpu cpu emulating the game
+ * @param event half_event
  */
-void render_vram(cpu_state *cpu, uint32_t *pixels);
+void half_frame_cb(scheduler* sched, cpu_state* cpu, sched_event* event);
 
 /**
- * @brief callback which is triggered when scan line reaches
- * 1/2 of the display, or at 120Hz
+ * @brief scheduler callback which is triggered when the scan line
+ * reaches the end of the display. Pends RST 2, draws the frame and
+ * comes back a frame later
  * 
- * @param interval Interval to trigger at
- * @param param NULL
- * @return uint32_t Interval
+ * @param sched wheel the event lives on
+ * @param cpu cpu emulating the game
+ * @param event full_event, ctx pointing at the invaders_window
  */
-uint32_t update_vram_cb(uint32_t interval, UNUSED void *param);
+void full_frame_cb(scheduler* sched, cpu_state* cpu, sched_event* event);
 
 /**
  * @brief Initializes the SDL game window
@@ -167,6 +193,6 @@ void destroy_game_window(invaders_window *game_window);
  * @param cpu to modify using the event
  * @param game_window relating to the generated event
  */
-void process_SDL_event(cpu_state *cpu, invaders_window *game_window);
+void process_SDL_event(UNUSED cpu_state *cpu, invaders_window *game_window);
 
 #endif
\ No newline at end of file
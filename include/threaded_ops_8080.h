@@ -0,0 +1,469 @@
+/**
+ * @file threaded_ops_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Opcode bodies shared by the computed goto engines (threaded and
+ * block). Only meant to be included by an engine's .c file, which
+ * provides the memory macros RD8, WR8, RD16, WR16, the operand fetches
+ * IMM8, IMM16 and CALL_IMM16 (read after the return address is pushed,
+ * which may have overwritten it), and the NEXT(n)/DISPATCH() control
+ * flow, along with the locals cpu, pc, sp, a, psw, cycles, instructions,
+ * target and the op_cycles table.
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ */
+#ifndef THREADED_OPS_8080_H
+#define THREADED_OPS_8080_H
+
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+
+///@{
+/** Register operands, token pasted from the DDD/SSS/RP fields */
+#define GET_B           cpu->reg[SLOT_B]
+#define GET_C           cpu->reg[SLOT_C]
+#define GET_D           cpu->reg[SLOT_D]
+#define GET_E           cpu->reg[SLOT_E]
+#define GET_H           cpu->reg[SLOT_H]
+#define GET_L           cpu->reg[SLOT_L]
+#define GET_M           RD8(cpu->HL)
+#define GET_A           a
+#define SET_B(v)        (cpu->reg[SLOT_B] = (v))
+#define SET_C(v)        (cpu->reg[SLOT_C] = (v))
+#define SET_D(v)        (cpu->reg[SLOT_D] = (v))
+#define SET_E(v)        (cpu->reg[SLOT_E] = (v))
+#define SET_H(v)        (cpu->reg[SLOT_H] = (v))
+#define SET_L(v)        (cpu->reg[SLOT_L] = (v))
+#define SET_M(v)        WR8(cpu->HL, (v))
+#define SET_A(v)        (a = (v))
+#define GET_BC          cpu->BC
+#define GET_DE          cpu->DE
+#define GET_HL          cpu->HL
+#define GET_SP          sp
+#define SET_BC(v)       (cpu->BC = (v))
+#define SET_DE(v)       (cpu->DE = (v))
+#define SET_HL(v)       (cpu->HL = (v))
+#define SET_SP(v)       (sp = (v))
+///@}
+
+///@{
+/** Condition checks, see condition_flags */
+#define NZ_COND         (!psw_zero(&psw))
+#define Z_COND          (psw_zero(&psw))
+#define NC_COND         (!psw_carry(&psw))
+#define C_COND          (psw_carry(&psw))
+#define PO_COND         (!psw_parity(&psw))
+#define PE_COND         (psw_parity(&psw))
+#define P_COND          (!psw_sign(&psw))
+#define M_COND          (psw_sign(&psw))
+///@}
+
+///@{
+/** Lazy flag helpers, matching set_flags and aux_flag_set_add */
+#define CY              psw_carry(&psw)
+#define SZP(v)          psw_set_szp(&psw, (v))
+#define SZPC(v)         (psw_set_szp(&psw, (v)), psw_set_cy_res(&psw, (v)))
+#define AUX(x, y)       psw_set_aux_add(&psw, (x), (y))
+///@}
+
+///@{
+/** Moving the cached state in and out of cpu_state */
+#define SYNC_OUT()      do { cpu->PC = pc; cpu->SP = sp; cpu->ACC = a;              \
+                             cpu->PSW = psw;                                        \
+                             cpu->cycles = cycles; cpu->instructions = instructions; \
+                        } while(0)
+#define SYNC_IN()       do { pc = cpu->PC; sp = cpu->SP; a = cpu->ACC;              \
+                             psw = cpu->PSW;                                        \
+                        } while(0)
+///@}
+
+///@{
+/** Interrupts only get unmasked by EI, so only checked at slice start, EI and IO */
+#define CHECK_INTT()    do { if(cycles < target && cpu->intt && cpu->pend_intt){     \
+                                 uint8_t index = __builtin_ctz(cpu->pend_intt);     \
+                                 if(index > 3) abort();                             \
+                                 cpu->pend_intt &= ~(1 << index);                   \
+                                 cpu->intt = 0;                                     \
+                                 cycles += op_cycles[0xC7 | (index << 3)];          \
+                                 instructions++;                                    \
+                                 sp -= 2; WR16(sp, pc); pc = index * 8;             \
+                             } } while(0)
+///@}
+
+///@{
+/** Opcode families */
+#define NOP()           NEXT(1)
+#define LXI(rp)         do { SET_##rp(IMM16); NEXT(3); } while(0)
+#define STAX(rp)        do { WR8(GET_##rp, a); NEXT(1); } while(0)
+#define LDAX(rp)        do { a = RD8(GET_##rp); NEXT(1); } while(0)
+#define INX(rp)         do { SET_##rp(GET_##rp + 1); NEXT(1); } while(0)
+#define DCX(rp)         do { SET_##rp(GET_##rp - 1); NEXT(1); } while(0)
+#define DAD(rp)         do { uint32_t t_ = (uint32_t)cpu->HL + GET_##rp; cpu->HL = t_; \
+                             psw_set_cy_res(&psw, t_ >> 8); NEXT(1); } while(0)
+#define INR(r)          do { uint8_t b_ = GET_##r; uint8_t v_ = b_ + 1; SET_##r(v_);    \
+                             SZP(v_); AUX(b_, 1); NEXT(1); } while(0)
+#define DCR(r)          do { uint8_t b_ = GET_##r; uint8_t v_ = b_ - 1; SET_##r(v_);    \
+                             SZP(v_); AUX(b_, -1); NEXT(1); } while(0)
+#define MVI(r)          do { SET_##r(IMM8); NEXT(2); } while(0)
+#define MOV(d, s)       do { SET_##d(GET_##s); NEXT(1); } while(0)
+#define SHLD()          do { WR16(IMM16, cpu->HL); NEXT(3); } while(0)
+#define LHLD()          do { cpu->HL = RD16(IMM16); NEXT(3); } while(0)
+#define STA()           do { WR8(IMM16, a); NEXT(3); } while(0)
+#define LDA()           do { a = RD8(IMM16); NEXT(3); } while(0)
+#define RLC()           do { uint8_t m_ = a >> 7; a = (a << 1) | m_; psw_set_carry(&psw, m_); \
+                             NEXT(1); } while(0)
+#define RRC()           do { uint8_t l_ = a & 1; a = (a >> 1) | (l_ << 7); psw_set_carry(&psw, l_); \
+                             NEXT(1); } while(0)
+#define RAL()           do { uint8_t m_ = a >> 7; a = (a << 1) | CY; psw_set_carry(&psw, m_); \
+                             NEXT(1); } while(0)
+#define RAR()           do { uint8_t l_ = a & 1; a = (a >> 1) | (CY << 7);                \
+                             psw_set_carry(&psw, l_); NEXT(1); } while(0)
+#define CMA()           do { a = ~a; NEXT(1); } while(0)
+#define STC()           do { psw_set_carry(&psw, 1); NEXT(1); } while(0)
+#define CMC()           do { psw_set_carry(&psw, !CY); NEXT(1); } while(0)
+#define DAA()           do { uint16_t d_ = daa_lookup[a | (CY << 8) | (psw_aux(&psw) << 9)]; \
+                             a = d_; psw_set_aux(&psw, d_ >> 9);                    \
+                             psw_set_cy_res(&psw, d_ & DAA_CARRY); NEXT(1); } while(0)
+#define HLT()           do { pc += 1; cpu->halt = 1; goto slice_end; } while(0)
+#define ADD(src)        do { uint8_t s_ = (src); uint16_t t_ = a + s_; SZPC(t_);        \
+                             AUX(a, s_); a = t_; } while(0)
+#define ADC(src)        do { uint8_t s_ = (src); uint16_t t_ = a + s_ + CY; SZPC(t_);   \
+                             AUX(a, s_ + CY); a = t_; } while(0)
+#define SUB(src)        do { uint8_t s_ = (src); uint16_t t_ = a - s_; SZPC(t_);        \
+                             AUX(a, -s_); a = t_; } while(0)
+#define SBB(src)        do { uint8_t s_ = (src); uint16_t t_ = a - (s_ + CY); SZPC(t_); \
+                             AUX(a, -s_ - 1); a = t_; } while(0)
+#define SBI()           do { uint8_t s_ = IMM8; uint16_t t_ = a - s_ - CY; SZPC(t_);    \
+                             AUX(a, -s_ - CY); a = t_; NEXT(2); } while(0)
+#define ANA(src)        do { uint8_t s_ = (src); psw_set_aux(&psw, (a | s_) & 0x08);    \
+                             a &= s_; SZPC(a); } while(0)
+#define XRA(src)        do { a ^= (src); SZPC(a); psw_set_aux(&psw, 0); } while(0)
+#define ORA(src)        do { a |= (src); SZPC(a); psw_set_aux(&psw, 0); } while(0)
+#define CMP(src)        do { uint8_t s_ = (src); uint16_t t_ = a - s_; SZPC(t_);        \
+                             AUX(a, -s_); } while(0)
+#ifdef IDLE_SKIP
+/** A short jump back may close an idle loop or a loop idiom, idle_skip works on cpu_state */
+#define JUMP_TO(addr)   do { uint16_t from_ = pc; pc = (addr);                        \
+                             if((uint16_t)(from_ - pc) < IDLE_MAX_BYTES &&            \
+                                cpu->idle_reject != (0x10000u | pc)){                 \
+                                 SYNC_OUT(); idle_skip(cpu, from_, target); SYNC_IN(); \
+                                 cycles = cpu->cycles; instructions = cpu->instructions; \
+                             } } while(0)
+#else
+#define JUMP_TO(addr)   (pc = (addr))
+#endif
+#ifdef HLE
+/** A call or tail jump into a routine hle_call knows may run natively, see hle_8080.c */
+#define HLE_CALL()      do { if(hle_hit(cpu, pc)){                                    \
+                                 SYNC_OUT();                                          \
+                                 if(hle_call(cpu, target)){                           \
+                                     SYNC_IN(); cycles = cpu->cycles;                 \
+                                     instructions = cpu->instructions;                \
+                                 } } } while(0)
+#else
+#define HLE_CALL()      ((void)0)
+#endif
+#define JMP()           do { JUMP_TO(IMM16); HLE_CALL(); DISPATCH(); } while(0)
+#define JCON(c)         do { if(c){ JUMP_TO(IMM16); } else { pc += 3; } DISPATCH(); } while(0)
+#define CALL()          do { sp -= 2; WR16(sp, pc + 3); pc = CALL_IMM16; HLE_CALL();    \
+                             DISPATCH(); } while(0)
+#define CCON(c)         do { if(c){ sp -= 2; WR16(sp, pc + 3); pc = CALL_IMM16;         \
+                                 cycles += CCON_TAKEN_CYCLES; }                     \
+                             else { pc += 3; } DISPATCH(); } while(0)
+#define RET()           do { pc = RD16(sp); sp += 2; DISPATCH(); } while(0)
+#define RCON(c)         do { if(c){ pc = RD16(sp); sp += 2; cycles += RCON_TAKEN_CYCLES; } \
+                             else { pc += 1; } DISPATCH(); } while(0)
+#define RST(n)          do { sp -= 2; WR16(sp, pc + 1); pc = (n) * 8; cpu->intt = 0;   \
+                             DISPATCH(); } while(0)
+#define PUSH(rp)        do { sp -= 2; WR16(sp, GET_##rp); NEXT(1); } while(0)
+#define POP(rp)         do { SET_##rp(RD16(sp)); sp += 2; NEXT(1); } while(0)
+#define PUSH_PSW()      do { sp -= 2; WR8(sp, compress_PSW(psw)); WR8(sp + 1, a); NEXT(1); } while(0)
+#define POP_PSW()       do { psw = decompress_PSW(RD8(sp)); a = RD8(sp + 1); sp += 2;   \
+                             NEXT(1); } while(0)
+#define OUT()           do { uint8_t port_ = IMM8; pc += 2; SYNC_OUT();                 \
+                             cpu->OUT_Func(port_, a); SYNC_IN();                    \
+                             CHECK_INTT(); DISPATCH(); } while(0)
+#define IN()            do { uint8_t port_ = IMM8; pc += 2; SYNC_OUT();                 \
+                             cpu->ACC = cpu->IN_Func(port_); SYNC_IN();             \
+                             CHECK_INTT(); DISPATCH(); } while(0)
+#define XTHL()          do { uint16_t t_ = RD16(sp); WR16(sp, cpu->HL); cpu->HL = t_;    \
+                             NEXT(1); } while(0)
+/** Same exchange as the interpreter's SPHL_WRAP */
+#define SPHL()          do { uint16_t t_ = cpu->HL; cpu->HL = RD16(sp); WR16(sp, t_);    \
+                             NEXT(1); } while(0)
+#define PCHL()          do { pc = cpu->HL; DISPATCH(); } while(0)
+#define XCHG()          do { uint16_t t_ = cpu->HL; cpu->HL = cpu->DE; cpu->DE = t_;    \
+                             NEXT(1); } while(0)
+#define DI()            do { cpu->intt = 0; NEXT(1); } while(0)
+#define EI()            do { cpu->intt = 1; pc += 1; CHECK_INTT(); DISPATCH(); } while(0)
+/** Alternate CALL encodings are treated as no-ops by CALL_WRAP */
+#define CALL_ILLEGAL()  NEXT(3)
+#define JMP_ILLEGAL()   do { DEBUG_PRINT("%s\n", "UNINIMPLEMENTED."); exit(-3); } while(0)
+/** RET_WRAP only accepts 0xC9 */
+#define RET_ILLEGAL()   exit(-2)
+///@}
+
+/**
+ * @brief X-macro over all 256 opcodes, X(code, body) where body is
+ * the opcode family invocation with its operands fixed.
+ */
+#define OPCODE_BODIES(X)                                                        \
+    X(00, NOP())               \
+    X(01, LXI(BC))             \
+    X(02, STAX(BC))            \
+    X(03, INX(BC))             \
+    X(04, INR(B))              \
+    X(05, DCR(B))              \
+    X(06, MVI(B))              \
+    X(07, RLC())               \
+    X(08, NOP())               \
+    X(09, DAD(BC))             \
+    X(0A, LDAX(BC))            \
+    X(0B, DCX(BC))             \
+    X(0C, INR(C))              \
+    X(0D, DCR(C))              \
+    X(0E, MVI(C))              \
+    X(0F, RRC())               \
+    X(10, NOP())               \
+    X(11, LXI(DE))             \
+    X(12, STAX(DE))            \
+    X(13, INX(DE))             \
+    X(14, INR(D))              \
+    X(15, DCR(D))              \
+    X(16, MVI(D))              \
+    X(17, RAL())               \
+    X(18, NOP())               \
+    X(19, DAD(DE))             \
+    X(1A, LDAX(DE))            \
+    X(1B, DCX(DE))             \
+    X(1C, INR(E))              \
+    X(1D, DCR(E))              \
+    X(1E, MVI(E))              \
+    X(1F, RAR())               \
+    X(20, NOP())               \
+    X(21, LXI(HL))             \
+    X(22, SHLD())              \
+    X(23, INX(HL))             \
+    X(24, INR(H))              \
+    X(25, DCR(H))              \
+    X(26, MVI(H))              \
+    X(27, DAA())               \
+    X(28, NOP())               \
+    X(29, DAD(HL))             \
+    X(2A, LHLD())              \
+    X(2B, DCX(HL))             \
+    X(2C, INR(L))              \
+    X(2D, DCR(L))              \
+    X(2E, MVI(L))              \
+    X(2F, CMA())               \
+    X(30, NOP())               \
+    X(31, LXI(SP))             \
+    X(32, STA())               \
+    X(33, INX(SP))             \
+    X(34, INR(M))              \
+    X(35, DCR(M))              \
+    X(36, MVI(M))              \
+    X(37, STC())               \
+    X(38, NOP())               \
+    X(39, DAD(SP))             \
+    X(3A, LDA())               \
+    X(3B, DCX(SP))             \
+    X(3C, INR(A))              \
+    X(3D, DCR(A))              \
+    X(3E, MVI(A))              \
+    X(3F, CMC())               \
+    X(40, MOV(B, B))           \
+    X(41, MOV(B, C))           \
+    X(42, MOV(B, D))           \
+    X(43, MOV(B, E))           \
+    X(44, MOV(B, H))           \
+    X(45, MOV(B, L))           \
+    X(46, MOV(B, M))           \
+    X(47, MOV(B, A))           \
+    X(48, MOV(C, B))           \
+    X(49, MOV(C, C))           \
+    X(4A, MOV(C, D))           \
+    X(4B, MOV(C, E))           \
+    X(4C, MOV(C, H))           \
+    X(4D, MOV(C, L))           \
+    X(4E, MOV(C, M))           \
+    X(4F, MOV(C, A))           \
+    X(50, MOV(D, B))           \
+    X(51, MOV(D, C))           \
+    X(52, MOV(D, D))           \
+    X(53, MOV(D, E))           \
+    X(54, MOV(D, H))           \
+    X(55, MOV(D, L))           \
+    X(56, MOV(D, M))           \
+    X(57, MOV(D, A))           \
+    X(58, MOV(E, B))           \
+    X(59, MOV(E, C))           \
+    X(5A, MOV(E, D))           \
+    X(5B, MOV(E, E))           \
+    X(5C, MOV(E, H))           \
+    X(5D, MOV(E, L))           \
+    X(5E, MOV(E, M))           \
+    X(5F, MOV(E, A))           \
+    X(60, MOV(H, B))           \
+    X(61, MOV(H, C))           \
+    X(62, MOV(H, D))           \
+    X(63, MOV(H, E))           \
+    X(64, MOV(H, H))           \
+    X(65, MOV(H, L))           \
+    X(66, MOV(H, M))           \
+    X(67, MOV(H, A))           \
+    X(68, MOV(L, B))           \
+    X(69, MOV(L, C))           \
+    X(6A, MOV(L, D))           \
+    X(6B, MOV(L, E))           \
+    X(6C, MOV(L, H))           \
+    X(6D, MOV(L, L))           \
+    X(6E, MOV(L, M))           \
+    X(6F, MOV(L, A))           \
+    X(70, MOV(M, B))           \
+    X(71, MOV(M, C))           \
+    X(72, MOV(M, D))           \
+    X(73, MOV(M, E))           \
+    X(74, MOV(M, H))           \
+    X(75, MOV(M, L))           \
+    X(76, HLT())               \
+    X(77, MOV(M, A))           \
+    X(78, MOV(A, B))           \
+    X(79, MOV(A, C))           \
+    X(7A, MOV(A, D))           \
+    X(7B, MOV(A, E))           \
+    X(7C, MOV(A, H))           \
+    X(7D, MOV(A, L))           \
+    X(7E, MOV(A, M))           \
+    X(7F, MOV(A, A))           \
+    X(80, ADD(GET_B); NEXT(1)) \
+    X(81, ADD(GET_C); NEXT(1)) \
+    X(82, ADD(GET_D); NEXT(1)) \
+    X(83, ADD(GET_E); NEXT(1)) \
+    X(84, ADD(GET_H); NEXT(1)) \
+    X(85, ADD(GET_L); NEXT(1)) \
+    X(86, ADD(GET_M); NEXT(1)) \
+    X(87, ADD(GET_A); NEXT(1)) \
+    X(88, ADC(GET_B); NEXT(1)) \
+    X(89, ADC(GET_C); NEXT(1)) \
+    X(8A, ADC(GET_D); NEXT(1)) \
+    X(8B, ADC(GET_E); NEXT(1)) \
+    X(8C, ADC(GET_H); NEXT(1)) \
+    X(8D, ADC(GET_L); NEXT(1)) \
+    X(8E, ADC(GET_M); NEXT(1)) \
+    X(8F, ADC(GET_A); NEXT(1)) \
+    X(90, SUB(GET_B); NEXT(1)) \
+    X(91, SUB(GET_C); NEXT(1)) \
+    X(92, SUB(GET_D); NEXT(1)) \
+    X(93, SUB(GET_E); NEXT(1)) \
+    X(94, SUB(GET_H); NEXT(1)) \
+    X(95, SUB(GET_L); NEXT(1)) \
+    X(96, SUB(GET_M); NEXT(1)) \
+    X(97, SUB(GET_A); NEXT(1)) \
+    X(98, SBB(GET_B); NEXT(1)) \
+    X(99, SBB(GET_C); NEXT(1)) \
+    X(9A, SBB(GET_D); NEXT(1)) \
+    X(9B, SBB(GET_E); NEXT(1)) \
+    X(9C, SBB(GET_H); NEXT(1)) \
+    X(9D, SBB(GET_L); NEXT(1)) \
+    X(9E, SBB(GET_M); NEXT(1)) \
+    X(9F, SBB(GET_A); NEXT(1)) \
+    X(A0, ANA(GET_B); NEXT(1)) \
+    X(A1, ANA(GET_C); NEXT(1)) \
+    X(A2, ANA(GET_D); NEXT(1)) \
+    X(A3, ANA(GET_E); NEXT(1)) \
+    X(A4, ANA(GET_H); NEXT(1)) \
+    X(A5, ANA(GET_L); NEXT(1)) \
+    X(A6, ANA(GET_M); NEXT(1)) \
+    X(A7, ANA(GET_A); NEXT(1)) \
+    X(A8, XRA(GET_B); NEXT(1)) \
+    X(A9, XRA(GET_C); NEXT(1)) \
+    X(AA, XRA(GET_D); NEXT(1)) \
+    X(AB, XRA(GET_E); NEXT(1)) \
+    X(AC, XRA(GET_H); NEXT(1)) \
+    X(AD, XRA(GET_L); NEXT(1)) \
+    X(AE, XRA(GET_M); NEXT(1)) \
+    X(AF, XRA(GET_A); NEXT(1)) \
+    X(B0, ORA(GET_B); NEXT(1)) \
+    X(B1, ORA(GET_C); NEXT(1)) \
+    X(B2, ORA(GET_D); NEXT(1)) \
+    X(B3, ORA(GET_E); NEXT(1)) \
+    X(B4, ORA(GET_H); NEXT(1)) \
+    X(B5, ORA(GET_L); NEXT(1)) \
+    X(B6, ORA(GET_M); NEXT(1)) \
+    X(B7, ORA(GET_A); NEXT(1)) \
+    X(B8, CMP(GET_B); NEXT(1)) \
+    X(B9, CMP(GET_C); NEXT(1)) \
+    X(BA, CMP(GET_D); NEXT(1)) \
+    X(BB, CMP(GET_E); NEXT(1)) \
+    X(BC, CMP(GET_H); NEXT(1)) \
+    X(BD, CMP(GET_L); NEXT(1)) \
+    X(BE, CMP(GET_M); NEXT(1)) \
+    X(BF, CMP(GET_A); NEXT(1)) \
+    X(C0, RCON(NZ_COND))       \
+    X(C1, POP(BC))             \
+    X(C2, JCON(NZ_COND))       \
+    X(C3, JMP())               \
+    X(C4, CCON(NZ_COND))       \
+    X(C5, PUSH(BC))            \
+    X(C6, ADD(IMM8); NEXT(2))  \
+    X(C7, RST(0))              \
+    X(C8, RCON(Z_COND))        \
+    X(C9, RET())               \
+    X(CA, JCON(Z_COND))        \
+    X(CB, JMP_ILLEGAL())       \
+    X(CC, CCON(Z_COND))        \
+    X(CD, CALL())              \
+    X(CE, ADC(IMM8); NEXT(2))  \
+    X(CF, RST(1))              \
+    X(D0, RCON(NC_COND))       \
+    X(D1, POP(DE))             \
+    X(D2, JCON(NC_COND))       \
+    X(D3, OUT())               \
+    X(D4, CCON(NC_COND))       \
+    X(D5, PUSH(DE))            \
+    X(D6, SUB(IMM8); NEXT(2))  \
+    X(D7, RST(2))              \
+    X(D8, RCON(C_COND))        \
+    X(D9, RET_ILLEGAL())       \
+    X(DA, JCON(C_COND))        \
+    X(DB, IN())                \
+    X(DC, CCON(C_COND))        \
+    X(DD, CALL_ILLEGAL())      \
+    X(DE, SBI())               \
+    X(DF, RST(3))              \
+    X(E0, RCON(PO_COND))       \
+    X(E1, POP(HL))             \
+    X(E2, JCON(PO_COND))       \
+    X(E3, XTHL())              \
+    X(E4, CCON(PO_COND))       \
+    X(E5, PUSH(HL))            \
+    X(E6, ANA(IMM8); NEXT(2))  \
+    X(E7, RST(4))              \
+    X(E8, RCON(PE_COND))       \
+    X(E9, PCHL())              \
+    X(EA, JCON(PE_COND))       \
+    X(EB, XCHG())              \
+    X(EC, CCON(PE_COND))       \
+    X(ED, CALL_ILLEGAL())      \
+    X(EE, XRA(IMM8); NEXT(2))  \
+    X(EF, RST(5))              \
+    X(F0, RCON(P_COND))        \
+    X(F1, POP_PSW())           \
+    X(F2, JCON(P_COND))        \
+    X(F3, DI())                \
+    X(F4, CCON(P_COND))        \
+    X(F5, PUSH_PSW())          \
+    X(F6, ORA(IMM8); NEXT(2))  \
+    X(F7, RST(6))              \
+    X(F8, RCON(M_COND))        \
+    X(F9, SPHL())              \
+    X(FA, JCON(M_COND))        \
+    X(FB, EI())                \
+    X(FC, CCON(M_COND))        \
+    X(FD, CALL_ILLEGAL())      \
+    X(FE, CMP(IMM8); NEXT(2))  \
+    X(FF, RST(7))
+
+#endif
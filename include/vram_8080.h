@@ -0,0 +1,82 @@
+/**
+ * @file vram_8080.h
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Incremental renderer for the invaders frame buffer. VRAM is
+ * 224 scan lines of 32 bytes, each line one column of the screen once
+ * rotated upright. Every frame the lines are compared against the copy
+ * drawn last, the ones which changed are marked in a dirty bitmap, and
+ * only those are expanded into pixels and reported as rects to hand
+ * the window (SDL_UpdateWindowSurfaceRects). Comparing costs the cpu
+ * nothing; hooking VRAM stores would put a check on every engine store.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#ifndef VRAM_8080_H
+#define VRAM_8080_H
+
+#include <inttypes.h>
+
+#define VRAM_OFFSET     0x2400                          /** Location of VRAM **/
+#define VRAM_SIZE       0x1C00                          /** Size of VRAM **/
+#define VRAM_LINE_SIZE  32                              /** Bytes of a scan line, a column upright **/
+#define VRAM_LINES      (VRAM_SIZE / VRAM_LINE_SIZE)    /** Scan lines, the upright width **/
+#define VRAM_LINE_BITS  (VRAM_LINE_SIZE * 8)            /** Pixels of a scan line, the upright height **/
+#define GREEN_PIXEL     0xFF00                          /** RGB888 GREEN Value */
+#define BLACK_PIXEL     0x0                             /** RGB888 Black Value */
+
+/**
+ * @brief Part of the upright screen redrawn, in pixels
+ */
+typedef struct {
+    int32_t x, y, w, h;
+} vram_rect;
+
+/**
+ * @brief Renderer state, zero it (or vram_invalidate) before the first
+ * frame
+ */
+typedef struct {
+    uint8_t shown[VRAM_SIZE];           /**< VRAM as last drawn */
+    uint8_t dirty[VRAM_LINES / 8];      /**< Lines differing from shown, a bit each */
+    uint8_t primed;                     /**< 0 until the first full draw */
+    ///@{
+    /** Counters, over every vram_render */
+    uint64_t frames;
+    uint64_t lines_drawn;               /**< Scan lines with anything redrawn */
+    uint64_t bytes_drawn;               /**< VRAM bytes expanded into pixels */
+    ///@}
+} vram_tracker;
+
+/**
+ * @brief Has the next vram_render redraw everything, for when the
+ * pixels were lost (the window was exposed or resized)
+ *
+ * @param vt
+ */
+void vram_invalidate(vram_tracker* vt);
+
+/**
+ * @brief Marks the scan lines of vram differing from what was drawn
+ * last in vt->dirty
+ *
+ * @param vt
+ * @param vram VRAM_SIZE bytes of the guest's VRAM
+ * @return uint32_t lines marked
+ */
+uint32_t vram_mark(vram_tracker* vt, const uint8_t* vram);
+
+/**
+ * @brief Draws the changed parts of vram into the upright pixels
+ * (VRAM_LINES wide, VRAM_LINE_BITS high) and reports them as rects,
+ * one per run of neighbouring changed lines
+ *
+ * @param vt
+ * @param vram VRAM_SIZE bytes of the guest's VRAM
+ * @param pixels VRAM_LINES * VRAM_LINE_BITS, row by row
+ * @param rects out, room for VRAM_LINES / 2 + 1
+ * @return uint32_t rects filled in, 0 if nothing changed
+ */
+uint32_t vram_render(vram_tracker* vt, const uint8_t* vram, uint32_t* pixels, vram_rect* rects);
+
+#endif
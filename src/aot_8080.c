@@ -0,0 +1,297 @@
+/**
+ * @file aot_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Ahead of time translator behind `make ENGINE=aot`. Walks a ROM
+ * image's control flow from the reset and RST vectors and writes out one C
+ * function, aot_exec, with a case label per basic block. The opcode bodies
+ * are the threaded engines' OPCODE_BODIES with the operands baked in as
+ * constants. Anything it can't prove is plain ROM code (RST, PCHL, the
+ * illegal JMP/RET encodings, RAM) is left to the interpreter.
+ * usage: aot_8080 <rom image> <output.c>
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "threaded_ops_8080.h"
+
+#define AOT_MAX_OPS     32          /** Longest straight line run in one block */
+#define AOT_MEM_SIZE    0x10000     /** Address space the ROM is walked in */
+
+///@{
+/** Source text of every opcode body */
+#define BODY_TEXT(code, body)   [0x##code] = #body,
+static const char* const op_body[0x100] = { OPCODE_BODIES(BODY_TEXT) };
+///@}
+
+/**
+ * @brief The ROM and what the walk found out about it
+ */
+typedef struct {
+    uint8_t rom[AOT_MEM_SIZE];      /**< ROM image, zero past its end */
+    uint32_t size;                  /**< Bytes in the image */
+    uint8_t start[AOT_MEM_SIZE];    /**< Non zero if a block starts at the address */
+    uint16_t queue[AOT_MEM_SIZE];   /**< Block starts still to walk */
+    uint32_t queued;
+} aot_image;
+
+/**
+ * @brief Whether the generated code may run an opcode. RST and PCHL are
+ * left to the interpreter, so are the encodings it exits on.
+ *
+ * @param op_code
+ * @return int 1 if translatable
+ */
+static int aot_translatable(uint8_t op_code){
+    if((op_code & 0xC7) == 0xC7){   // RST
+        return 0;
+    }
+    return op_code != 0xE9 && op_code != 0xCB && op_code != 0xD9;
+}
+
+/**
+ * @brief Marks addr as a block start, queueing it for the walk
+ *
+ * @param img
+ * @param addr
+ */
+static void aot_add(aot_image* img, uint32_t addr){
+    if(addr < img->size && !img->start[addr]){
+        img->start[addr] = 1;
+        img->queue[img->queued++] = addr;
+    }
+}
+
+/**
+ * @brief Walks the straight line run starting at addr
+ *
+ * @param img
+ * @param addr block start
+ * @param visit called on every translated instruction when not NULL
+ * @param ctx passed back to visit
+ * @return uint32_t the address the block stops at
+ */
+static uint32_t aot_walk(aot_image* img, uint32_t addr,
+                         void (*visit)(aot_image*, uint32_t, void*), void* ctx){
+    uint32_t pc = addr;
+    for(uint32_t len = 0; len < AOT_MAX_OPS; len++){
+        uint8_t op = img->rom[pc];
+        uint8_t size = opcode_size(op);
+        if(pc + size > img->size || !aot_translatable(op)){
+            // Return address of an RST, the interpreter comes back here
+            if(pc < img->size && (op & 0xC7) == 0xC7){
+                aot_add(img, pc + 1);
+            }
+            return pc;
+        }
+        if(visit){
+            visit(img, pc, ctx);
+        }
+        uint16_t imm = img->rom[pc + 1] | (img->rom[pc + 2] << 8);
+        if(op == 0xC3 || op == 0xCD || (op & 0xC7) == 0xC2 || (op & 0xC7) == 0xC4){
+            aot_add(img, imm);
+        }
+        pc += size;
+        if(opcode_ends_block(op)){
+            // Everything but JMP and RET may carry on after it
+            if(op != 0xC3 && op != 0xC9){
+                aot_add(img, pc);
+            }
+            return pc;
+        }
+    }
+    aot_add(img, pc);
+    return pc;
+}
+
+/**
+ * @brief Cycles charged before the last op of a block
+ */
+typedef struct {
+    uint32_t lead;
+    uint32_t last;      /**< Cycles of the last op */
+    uint8_t last_op;
+} aot_lead;
+
+static void aot_visit_lead(aot_image* img, uint32_t pc, void* ctx){
+    aot_lead* lead = ctx;
+    lead->lead += lead->last;
+    lead->last = opcode_cycles(img->rom[pc]);
+    lead->last_op = img->rom[pc];
+}
+
+static void aot_visit_emit(aot_image* img, uint32_t pc, void* ctx){
+    FILE* out = ctx;
+    uint8_t op = img->rom[pc];
+    uint8_t size = opcode_size(op);
+    uint16_t imm = 0;
+    fprintf(out, "    /* %04" PRIX32 ":", pc);
+    for(uint8_t i = 0; i < size; i++){
+        fprintf(out, " %02X", img->rom[pc + i]);
+    }
+    fprintf(out, " */\n");
+    if(size == 2){
+        imm = img->rom[pc + 1];
+    } else if(size == 3){
+        imm = img->rom[pc + 1] | (img->rom[pc + 2] << 8);
+    }
+    fprintf(out, "    %s(%u, 0x%04X, %s);\n", opcode_ends_block(op) ? "OP_END" : "OP",
+            opcode_cycles(op), imm, op_body[op]);
+}
+
+/**
+ * @brief Writes the generated translation unit
+ *
+ * @param img walked image
+ * @param rom_path named in the header comment
+ * @param out
+ */
+static void aot_emit(aot_image* img, const char* rom_path, FILE* out){
+    fprintf(out,
+        "/**\n"
+        " * @file invaders_aot.c\n"
+        " * @brief Generated by aot_8080 from %s, do not edit.\n"
+        " * One case label per basic block, see aot_8080.c.\n"
+        " */\n\n"
+        "#include <stdlib.h>\n"
+        "#include <inttypes.h>\n"
+        "#include \"cpu_8080.h\"\n"
+        "#include \"engine_8080.h\"\n"
+        "#include \"threaded_ops_8080.h\"\n\n"
+        "#define AOT_ROM_END     0x%" PRIX32 "\n\n"
+        "#define MEM_PTR(addr)   ((uintptr_t)mem_base | (uint16_t)(addr))\n"
+        "#define RD8(addr)       (*(uint8_t *)MEM_PTR(addr))\n"
+        "#define RD16(addr)      (*(uint16_t *)MEM_PTR(addr))\n"
+        "#define MEM_TRAP(addr)  (mem_pages[(uint16_t)(addr) >> 8] & MEM_STORE_TRAP)\n"
+        "#define WR8(addr, val)  do { uint16_t w_ = (addr);                                  \\\n"
+        "                             if(MEM_TRAP(w_)){                                      \\\n"
+        "                                 mem_write(&cpu->mem, w_, (val));                   \\\n"
+        "                             } else {                                               \\\n"
+        "                                 *(uint8_t *)MEM_PTR(w_) = (val);                   \\\n"
+        "                                 rom_written |= w_ < AOT_ROM_END;                   \\\n"
+        "                             } } while(0)\n"
+        "#define WR16(addr, val) do { uint16_t w_ = (addr);                                  \\\n"
+        "                             if(MEM_TRAP(w_) | MEM_TRAP(w_ + 1)){                   \\\n"
+        "                                 short_mem_write(&cpu->mem, w_, (val));             \\\n"
+        "                             } else {                                               \\\n"
+        "                                 *(uint16_t *)MEM_PTR(w_) = (val);                  \\\n"
+        "                                 rom_written |= w_ < AOT_ROM_END;                   \\\n"
+        "                             } } while(0)\n"
+        "#define IMM8            ((uint8_t)op_imm)\n"
+        "#define IMM16           op_imm\n"
+        "#define CALL_IMM16      (rom_written ? RD16(pc + 1) : op_imm)\n"
+        "#define NEXT(n)         (pc += (n))\n"
+        "#define DISPATCH()      goto dispatch\n"
+        "#undef CHECK_INTT\n"
+        "#define CHECK_INTT()    do { if(cpu->intt && cpu->pend_intt) goto leave; } while(0)\n"
+        "#ifdef HLE\n"
+        "#undef HLE_CALL\n"
+        "#define HLE_CALL()      do { if(hle_hit(cpu, pc)) goto leave; } while(0)\n"
+        "#endif\n"
+        "#define OP(cyc, imm, body) do { UNUSED const uint16_t op_imm = (imm);                  \\\n"
+        "                             cycles += (cyc); instructions++; body;                 \\\n"
+        "                             if(rom_written) goto rom_exit; } while(0)\n"
+        "#define OP_END(cyc, imm, body) do { UNUSED const uint16_t op_imm = (imm);              \\\n"
+        "                             cycles += (cyc); instructions++; body; } while(0)\n\n",
+        rom_path, img->size);
+
+    fprintf(out, "const uint32_t aot_rom_size = 0x%" PRIX32 ";\n", img->size);
+    fprintf(out, "const uint8_t aot_rom_image[0x%" PRIX32 "] = {", img->size);
+    for(uint32_t i = 0; i < img->size; i++){
+        fprintf(out, "%s0x%02X,", (i % 16) ? " " : "\n    ", img->rom[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out,
+        "int aot_exec(cpu_state* cpu, uint64_t target){\n"
+        "    void* mem_base = cpu->mem.base;\n"
+        "    const uintptr_t* mem_pages = cpu->mem.pages;\n"
+        "    uint64_t cycles = cpu->cycles;\n"
+        "    uint64_t instructions = cpu->instructions;\n"
+        "    uint16_t pc, sp;\n"
+        "    uint8_t a;\n"
+        "    program_status_word psw;\n"
+        "    uint8_t rom_written = 0;\n"
+        "    SYNC_IN();\n\n"
+        "dispatch:\n"
+        "    if(rom_written) goto rom_exit;\n"
+        "    switch(pc){\n");
+    uint32_t blocks = 0;
+    for(uint32_t addr = 0; addr < img->size; addr++){
+        aot_lead lead = {0, 0, 0};
+        if(!img->start[addr]){
+            continue;
+        }
+        uint32_t end = aot_walk(img, addr, &aot_visit_lead, &lead);
+        if(end == addr){
+            continue;
+        }
+        blocks++;
+        fprintf(out, "case 0x%04" PRIX32 ":\n", addr);
+        fprintf(out, "    if(cycles + %" PRIu32 " >= target) goto leave;\n", lead.lead);
+        fprintf(out, "    pc = 0x%04" PRIX32 ";\n", addr);
+        aot_walk(img, addr, &aot_visit_emit, out);
+        // Blocks stopping short of a block ending op go on through dispatch
+        if(!opcode_ends_block(lead.last_op)){
+            fprintf(out, "    DISPATCH();\n");
+        }
+    }
+    fprintf(out,
+        "default:\n"
+        "    goto leave;\n"
+        "    }\n\n"
+        "leave:\n"
+        "slice_end: UNUSED;\n"
+        "    SYNC_OUT();\n"
+        "    return AOT_LEAVE;\n"
+        "rom_exit:\n"
+        "    SYNC_OUT();\n"
+        "    return AOT_ROM_WRITTEN;\n"
+        "}\n");
+    fprintf(stderr, "aot_8080: %" PRIu32 " blocks out of %s\n", blocks, rom_path);
+}
+
+/**
+ * @brief aot_8080 driver.
+ * usage: aot_8080 <rom image> <output.c>
+ *
+ * @return int 0 if success, else error code
+ */
+int main(int argc, char** argv){
+    if(argc != 3){
+        fprintf(stderr, "usage: %s <rom image> <output.c>\n", argv[0]);
+        return -1;
+    }
+    aot_image* img = calloc(1, sizeof(aot_image));
+    FILE* rom = fopen(argv[1], "rb");
+    if(!rom){
+        fprintf(stderr, "aot_8080: can't open %s, did you `make extractROM`?\n", argv[1]);
+        return -1;
+    }
+    img->size = fread(img->rom, 1, AOT_MEM_SIZE, rom);
+    fclose(rom);
+
+    // Reset and the interrupt vectors are the only ways in
+    for(uint32_t vector = 0; vector < 0x40; vector += 8){
+        aot_add(img, vector);
+    }
+    for(uint32_t i = 0; i < img->queued; i++){
+        aot_walk(img, img->queue[i], NULL, NULL);
+    }
+
+    FILE* out = fopen(argv[2], "w");
+    if(!out){
+        fprintf(stderr, "aot_8080: can't write %s\n", argv[2]);
+        return -1;
+    }
+    aot_emit(img, argv[1], out);
+    fclose(out);
+    free(img);
+    return 0;
+}
@@ -0,0 +1,735 @@
+/**
+ * @file bench.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Headless benchmark runner for the 8080 core. Runs the invaders
+ * ROM and the cpu diagnostic ROM without SDL and reports how fast
+ * the core emulates them.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "sched_8080.h"
+#include "pcache_8080.h"
+#include "vram_8080.h"
+#include "snap_8080.h"
+
+#define BENCH_MEM_SIZE      (1<<16)     /** 64KB of guest memory, 64KB aligned */
+#define INVADERS_ROM_PAGES  0x20        /** 8KB of write protected ROM from 0 */
+#define INVADERS_MIRROR_PAGE 0x40       /** A14/A15 aren't decoded, 0x4000 up mirrors 0x0000 */
+#define INVADERS_RAM_SIZE   0x2000      /** Work RAM and VRAM, after the ROM */
+#define COMPACT_FRAMES      120         /** Frames each compact instance runs */
+#define COMPACT_INSTANCES   1024        /** Most compact instances swept by default */
+#define SNAP_RESTORES       1000        /** Snapshots restored, picked all over the run */
+#define SNAP_CHECK_EVERY    500         /** Snapshots kept in full too, to check restores against */
+/** Compact memory has no window for the lockstep and HLE_VERIFY shadows to copy */
+#if !defined(LOCKSTEP) && !defined(HLE_VERIFY)
+#define BENCH_COMPACT
+#endif
+#define half_1              0x2         /** Pending Intt to Call RST 1 */
+#define full_2              0x4         /** Pending Intt to Call RST 2 */
+#define DEFAULT_FRAMES      6000        /** 100 emulated seconds */
+#define DIAG_LOAD_OFFSET    0x100       /** cpudiag expects to start at 0x100 */
+#define DIAG_STACK_SLACK    0x200       /** cpudiag keeps its stack past the image */
+#define DIAG_CYCLES         (CPU_CLOCK_HZ * 100ull) /** 100 emulated seconds of cpudiag */
+
+/**
+ * @brief Counters collected over a benchmark run
+ */
+typedef struct {
+    uint64_t instructions;  /**< Instructions executed */
+    uint64_t skipped;       /**< Of instructions, the ones charged without being run, see skipped_instructions */
+    uint64_t cycles;        /**< Emulated clock cycles charged by the core */
+    uint64_t idle_cycles;   /**< Of cycles, the ones idle_skip fast forwarded */
+    uint64_t hle_cycles;    /**< Of cycles, the ones of routines run natively by hle_call */
+    uint64_t loop_cycles;   /**< Of cycles, the ones of loop passes loop_skip did in bulk */
+    uint64_t host_ns;       /**< Host wall clock time spent */
+    uint64_t render_ns;     /**< Of it, the time vram_render took, left out of host_ns */
+    vram_tracker vram;      /**< The invaders frames, drawn as the game would */
+} bench_stats;
+
+/**
+ * @brief Minimal stand in for the invaders port IO, enough
+ * to keep the shift hardware functional without SDL.
+ */
+typedef struct {
+    uint8_t shift_config;
+    uint16_t hidden_reg;
+} bench_port_state;
+static bench_port_state bench_ports;
+
+/**
+ * @brief One of many invaders machines in compact memory, see
+ * bench_compact
+ */
+typedef struct {
+    cpu_state* cpu;
+    bench_port_state ports;     /**< Swapped into bench_ports while it runs */
+} compact_instance;
+
+static uint8_t bench_IN(uint8_t port){
+    switch (port)
+    {
+    case 0:
+        return 0x0E;
+    case 1:
+        return 0x09;
+    case 2:
+        return 0x03;
+    case 3:
+        return (uint8_t)(bench_ports.hidden_reg >> (8 - bench_ports.shift_config));
+    default:
+        return 0x0;
+    }
+}
+
+static void bench_OUT(uint8_t port, uint8_t data){
+    switch (port)
+    {
+    case 2:
+        bench_ports.shift_config = data & 0x7;
+        break;
+    case 4:
+        bench_ports.hidden_reg = (bench_ports.hidden_reg >> 8) | ((uint16_t)data << 8);
+        break;
+    default:
+        break;
+    }
+}
+
+static uint64_t now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Reads a ROM image from disk into guest memory
+ *
+ * @param file_path ROM to load
+ * @param cpu cpu whose memory is populated
+ * @param offset guest address to load the ROM at
+ * @return int bytes loaded, -1 on failure
+ */
+static int load_rom(const char* file_path, cpu_state* cpu, uint16_t offset){
+    int FD;
+    if ((FD = open(file_path, O_RDONLY)) == -1) {
+        WARN(0, "%s\n", "open failure");
+        return -1;
+    }
+    ssize_t loaded = read(FD, (uint8_t*)cpu->mem.base + offset, BENCH_MEM_SIZE - offset);
+    close(FD);
+    if (loaded <= 0){
+        WARN(0, "%s\n", "ROM_LOAD_FAILED.");
+        return -1;
+    }
+    cpu->rom_size = loaded;
+    return loaded;
+}
+
+/**
+ * @brief Maps a ROM image read only and shared at guest address 0,
+ * like space.c's copy_invaders_rom, or reads it in if it can't be
+ *
+ * @param file_path ROM to load
+ * @param cpu cpu whose memory is populated
+ * @return int bytes loaded, -1 on failure
+ */
+static int map_rom(const char* file_path, cpu_state* cpu){
+    int FD;
+    struct stat romstats;
+    if ((FD = open(file_path, O_RDONLY)) == -1 || fstat(FD, &romstats) == -1) {
+        if (FD != -1){
+            close(FD);
+        }
+        WARN(0, "%s\n", "open failure");
+        return -1;
+    }
+    uint8_t mapped = mem_map_file(&cpu->mem, 0x00, FD, romstats.st_size);
+    close(FD);
+    if (!mapped){
+        return load_rom(file_path, cpu, 0x0);
+    }
+    cpu->rom_size = romstats.st_size;
+    return romstats.st_size;
+}
+
+/**
+ * @brief Maps the invaders board over the ROM at page 0, as space.c's
+ * map_invaders
+ *
+ * @param mem
+ */
+static void bench_map_invaders(v_memory* mem){
+    mem_map_flags(mem, 0x00, INVADERS_ROM_PAGES, MEM_RO);
+    for(uint32_t page = INVADERS_MIRROR_PAGE; page < MEM_PAGES; page += INVADERS_MIRROR_PAGE){
+        mem_map_mirror(mem, page, INVADERS_MIRROR_PAGE, 0x00);
+    }
+}
+
+/**
+ * @brief Raises the event's intt and puts it back a frame later
+ *
+ * @param sched
+ * @param cpu
+ * @param event ctx holds the pend_intt bit
+ */
+static void bench_intt(scheduler* sched, cpu_state* cpu, sched_event* event){
+    cpu->pend_intt |= (uintptr_t)event->ctx;
+    sched_at(sched, event, event->when + CYCLES_PER_FRAME);
+}
+
+/**
+ * @brief Raises RST 2 and draws the frame, like the game's full frame
+ * event, into a buffer nobody looks at
+ *
+ * @param sched
+ * @param cpu
+ * @param event ctx holds the bench_stats
+ */
+static void bench_frame(scheduler* sched, cpu_state* cpu, sched_event* event){
+    static uint32_t pixels[VRAM_LINES * VRAM_LINE_BITS];
+    vram_rect rects[VRAM_LINES / 2 + 1];
+    bench_stats* stats = event->ctx;
+    cpu->pend_intt |= full_2;
+    uint64_t start = now_ns();
+    vram_render(&stats->vram, mem_ref(&cpu->mem, VRAM_OFFSET), pixels, rects);
+    stats->render_ns += now_ns() - start;
+#ifdef MEM_HEAT
+    if(cpu->mem.heat){
+        heat_frame(cpu->mem.heat);
+    }
+#endif
+    sched_at(sched, event, event->when + CYCLES_PER_FRAME);
+}
+
+#ifdef MEM_HASH
+/**
+ * @brief Prints the cpu's fingerprint, kept up to date since the run
+ * started, and what it takes next to hashing the memory from scratch
+ *
+ * @param cpu
+ */
+static void report_hash(cpu_state* cpu){
+    uint64_t start = now_ns();
+    uint64_t fingerprint = cpu_fingerprint(cpu);
+    uint64_t kept_ns = now_ns() - start;
+    start = now_ns();
+    uint64_t full = mem_hash_full(&cpu->mem);
+    uint64_t full_ns = now_ns() - start;
+    printf("%-10s fingerprint %016" PRIx64 " in %" PRIu64 " ns, the memory hash %s a %.1f us full recompute\n",
+           "hash", fingerprint, kept_ns, full == mem_hash(&cpu->mem) ? "matches" : "DIFFERS from", full_ns / 1e3);
+}
+#endif
+
+/**
+ * @brief Sets up a cpu running the invaders ROM on the invaders board
+ *
+ * @param rom_path path to invaders.hgfe
+ * @return cpu_state* NULL on failure
+ */
+static cpu_state* bench_invaders_cpu(const char* rom_path){
+    cpu_state* cpu = init_cpu_8080(0x0, &bench_IN, &bench_OUT);
+    memset(&bench_ports, 0, sizeof(bench_ports));
+    if (!mem_init(&cpu->mem) || map_rom(rom_path, cpu) == -1){
+        mem_free(&cpu->mem);
+        free_cpu_8080(cpu);
+        return NULL;
+    }
+    bench_map_invaders(&cpu->mem);
+#ifdef HLE
+    hle_enable(cpu, HLE_ROUTINES);
+#endif
+    return cpu;
+}
+
+/**
+ * @brief Runs the invaders ROM for a fixed number of emulated frames,
+ * raising RST 1 and RST 2 at the half and full frame points.
+ *
+ * @param rom_path path to invaders.hgfe
+ * @param frames number of frames to emulate
+ * @param cache_path code cache to start from and save back to
+ * @param heat_path where a `MEM_HEAT=1` build dumps the run's memory accesses
+ * @param stats collected counters
+ * @return int 0 on success, -1 on failure
+ */
+static int bench_invaders(const char* rom_path, uint32_t frames, const char* cache_path, UNUSED const char* heat_path,
+                          bench_stats* stats){
+    cpu_state* cpu = bench_invaders_cpu(rom_path);
+    if (!cpu){
+        return -1;
+    }
+#ifdef MEM_HEAT
+    cpu->mem.heat = heat_open(heat_path);
+    if (!cpu->mem.heat){
+        fprintf(stderr, "heat: can't write %s\n", heat_path);
+    }
+#endif
+#ifdef PCACHE_ENGINE
+    uint8_t warm = pcache_load(cpu, cache_path);
+    printf("code cache: %s (%s)\n", cache_path, warm ? "warm" : "cold");
+#endif
+
+    // Fixed timeline, so overshoot doesn't drift the intts
+    scheduler sched;
+    sched_event half = {.cb = bench_intt, .ctx = (void*)(uintptr_t)half_1};
+    sched_event full = {.cb = bench_frame, .ctx = stats};
+    sched_init(&sched);
+    sched_at(&sched, &half, CYCLES_PER_FRAME / 2);
+    sched_at(&sched, &full, CYCLES_PER_FRAME);
+
+#ifdef MEM_HASH
+    // From here on the stores keep it up to date
+    cpu_fingerprint(cpu);
+#endif
+
+    int ret = 0;
+    uint64_t start = now_ns();
+    if (sched_run(&sched, cpu, (uint64_t)frames * CYCLES_PER_FRAME) != 1){
+        fprintf(stderr, "invaders: cpu stopped at PC:%x\n", cpu->PC);
+        ret = -1;
+    }
+    stats->host_ns += now_ns() - start - stats->render_ns;
+#ifdef MEM_HASH
+    report_hash(cpu);
+#endif
+#ifdef MEM_HEAT
+    if (cpu->mem.heat){
+        uint32_t heat_frames = cpu->mem.heat->frames + (cpu->mem.heat->touched_count != 0);
+        if (heat_close(cpu->mem.heat) == 0){
+            printf("%-10s %u frames of memory accesses dumped to %s\n", "heat", heat_frames, heat_path);
+        } else {
+            fprintf(stderr, "heat: failed writing %s\n", heat_path);
+        }
+        cpu->mem.heat = NULL;
+    }
+#endif
+    stats->instructions += cpu->instructions;
+    stats->skipped += cpu->skipped_instructions;
+    stats->cycles += cpu->cycles;
+    stats->idle_cycles += cpu->idle_cycles;
+    stats->hle_cycles += cpu->hle_cycles;
+    stats->loop_cycles += cpu->loop_cycles;
+    if(ret == 0){
+        pcache_save(cpu, cache_path);
+    }
+
+    mem_free(&cpu->mem);
+    free_cpu_8080(cpu);
+    return ret;
+}
+
+#ifdef BENCH_COMPACT
+/**
+ * @brief Runs count invaders machines in compact memory, round robin a
+ * frame at a time for COMPACT_FRAMES frames each. They all share one
+ * copy of the ROM and own only their 8KB of RAM (mem_init_compact), so
+ * they run on the interpreter whatever the engine.
+ *
+ * @param rom_path path to invaders.hgfe
+ * @param count instances
+ * @param stats collected counters
+ * @return int 0 on success, -1 on failure
+ */
+static int bench_compact(const char* rom_path, uint32_t count, bench_stats* stats){
+    // Page table entries keep flags in the low bits, the bytes are page aligned
+    uint8_t* rom = aligned_alloc(MEM_PAGE_SIZE, INVADERS_ROM_PAGES * MEM_PAGE_SIZE);
+    uint8_t* ram = aligned_alloc(MEM_PAGE_SIZE, (size_t)count * INVADERS_RAM_SIZE);
+    compact_instance* fleet = calloc(count, sizeof(compact_instance));
+    int FD = open(rom_path, O_RDONLY);
+    ssize_t loaded = -1;
+    if (FD != -1 && rom){
+        memset(rom, 0, INVADERS_ROM_PAGES * MEM_PAGE_SIZE);
+        loaded = read(FD, rom, INVADERS_ROM_PAGES * MEM_PAGE_SIZE);
+    }
+    if (FD != -1){
+        close(FD);
+    }
+    if (loaded <= 0 || !ram || !fleet){
+        WARN(0, "%s\n", "ROM_LOAD_FAILED.");
+        free(rom);
+        free(ram);
+        free(fleet);
+        return -1;
+    }
+    memset(ram, 0, (size_t)count * INVADERS_RAM_SIZE);
+    for(uint32_t i = 0; i < count; i++){
+        cpu_state* cpu = fleet[i].cpu = init_cpu_8080(0x0, &bench_IN, &bench_OUT);
+        mem_init_compact(&cpu->mem);
+        mem_map_host(&cpu->mem, 0x00, INVADERS_ROM_PAGES, rom, MEM_RO);
+        mem_map_host(&cpu->mem, INVADERS_ROM_PAGES, INVADERS_RAM_SIZE / MEM_PAGE_SIZE,
+                     ram + (size_t)i * INVADERS_RAM_SIZE, 0);
+        bench_map_invaders(&cpu->mem);
+        cpu->rom_size = loaded;
+#ifdef HLE
+        hle_enable(cpu, HLE_ROUTINES);
+#endif
+    }
+
+    int ret = 0;
+    uint64_t start = now_ns();
+    for(uint32_t frame = 0; frame < COMPACT_FRAMES && ret == 0; frame++){
+        for(uint32_t i = 0; i < count && ret == 0; i++){
+            cpu_state* cpu = fleet[i].cpu;
+            bench_ports = fleet[i].ports;
+            // Fixed timeline, RST 1 at the half frame and RST 2 at the end
+            uint64_t half = (uint64_t)frame * CYCLES_PER_FRAME + CYCLES_PER_FRAME / 2;
+            uint64_t full = (uint64_t)(frame + 1) * CYCLES_PER_FRAME;
+            if ((cpu->cycles < half && run_cycles(cpu, half - cpu->cycles) == -1) ||
+                (cpu->pend_intt |= half_1, cpu->cycles < full && run_cycles(cpu, full - cpu->cycles) == -1)){
+                fprintf(stderr, "compact: cpu %u stopped at PC:%x\n", i, cpu->PC);
+                ret = -1;
+            }
+            cpu->pend_intt |= full_2;
+            fleet[i].ports = bench_ports;
+        }
+    }
+    stats->host_ns += now_ns() - start;
+
+    for(uint32_t i = 0; i < count; i++){
+        cpu_state* cpu = fleet[i].cpu;
+        stats->instructions += cpu->instructions;
+        stats->skipped += cpu->skipped_instructions;
+        stats->cycles += cpu->cycles;
+        stats->idle_cycles += cpu->idle_cycles;
+        stats->hle_cycles += cpu->hle_cycles;
+        stats->loop_cycles += cpu->loop_cycles;
+        mem_free(&cpu->mem);
+        free_cpu_8080(cpu);
+    }
+    free(fleet);
+    free(ram);
+    free(rom);
+    return ret;
+}
+
+/**
+ * @brief Prints what a compact instance costs, and how many fit a GB
+ */
+static void report_compact_size(){
+    size_t state = sizeof(cpu_state) - sizeof(((v_memory*)0)->pages);
+    size_t total = INVADERS_RAM_SIZE + sizeof(cpu_state) + sizeof(compact_instance);
+    printf("%-10s per instance: %zu B mutable (%u RAM + %zu cpu), %zu B with its page table, %.0f instances/GB\n",
+           "compact", INVADERS_RAM_SIZE + state, INVADERS_RAM_SIZE, state, total, (double)(1u << 30) / total);
+}
+#endif
+
+/**
+ * @brief Snapshots of the invaders run, see bench_snap
+ */
+typedef struct {
+    snap_store store;
+    uint32_t* ids;              /**< Of each frame's snapshot */
+    uint32_t count;
+    uint64_t take_ns;
+    uint64_t restore_ns;
+    uint32_t restores;
+    uint32_t checked;           /**< Restores checked against a full copy */
+    uint32_t check_failed;
+    uint8_t* full[64];          /**< Every SNAP_CHECK_EVERY'th snapshot's memory in full */
+    uint64_t full_cycles[64];   /**< and its cycle count */
+} bench_snaps;
+
+/**
+ * @brief Raises RST 2 and snapshots the machine, at every frame's end
+ *
+ * @param sched
+ * @param cpu
+ * @param event ctx holds the bench_snaps
+ */
+static void bench_snap_frame(scheduler* sched, cpu_state* cpu, sched_event* event){
+    bench_snaps* snaps = event->ctx;
+    cpu->pend_intt |= full_2;
+    uint64_t start = now_ns();
+    snaps->ids[snaps->count] = snap_take(&snaps->store, cpu);
+    snaps->take_ns += now_ns() - start;
+    uint32_t check = snaps->count / SNAP_CHECK_EVERY;
+    if (snaps->count % SNAP_CHECK_EVERY == 0 && check < 64 && (snaps->full[check] = malloc(MEM_SIZE))){
+        memcpy(snaps->full[check], cpu->mem.base, MEM_SIZE);
+        snaps->full_cycles[check] = cpu->cycles;
+    }
+    snaps->count++;
+    sched_at(sched, event, event->when + CYCLES_PER_FRAME);
+}
+
+/**
+ * @brief Runs the invaders ROM for frames, snapshotting it every frame,
+ * then restores SNAP_RESTORES of them picked all over the run. The
+ * ones also kept in full are checked against it.
+ *
+ * @param rom_path path to invaders.hgfe
+ * @param frames number of frames to emulate
+ * @param snaps collected counters
+ * @return int 0 on success, -1 on failure
+ */
+static int bench_snap(const char* rom_path, uint32_t frames, bench_snaps* snaps){
+    cpu_state* cpu = bench_invaders_cpu(rom_path);
+    snaps->ids = malloc((frames + 1) * sizeof(uint32_t));
+    if (!cpu || !snaps->ids){
+        if (cpu){
+            mem_free(&cpu->mem);
+            free_cpu_8080(cpu);
+        }
+        return -1;
+    }
+    snap_init(&snaps->store);
+
+    scheduler sched;
+    sched_event half = {.cb = bench_intt, .ctx = (void*)(uintptr_t)half_1};
+    sched_event full = {.cb = bench_snap_frame, .ctx = snaps};
+    sched_init(&sched);
+    sched_at(&sched, &half, CYCLES_PER_FRAME / 2);
+    sched_at(&sched, &full, CYCLES_PER_FRAME);
+    int ret = 0;
+    if (sched_run(&sched, cpu, (uint64_t)frames * CYCLES_PER_FRAME) != 1){
+        fprintf(stderr, "snapshots: cpu stopped at PC:%x\n", cpu->PC);
+        ret = -1;
+    }
+
+    for (uint32_t i = 0; ret == 0 && snaps->count && i < SNAP_RESTORES; i++){
+        uint32_t n = (uint32_t)(((uint64_t)i * 7919) % snaps->count);
+        // Every so often one of the snapshots kept in full, to check it
+        if (i % 16 == 0 && snaps->full[(i / 16) % 64]){
+            n = (i / 16) % 64 * SNAP_CHECK_EVERY;
+        }
+        uint64_t start = now_ns();
+        uint8_t restored = snap_restore(&snaps->store, snaps->ids[n], cpu);
+        snaps->restore_ns += now_ns() - start;
+        snaps->restores += restored;
+        if (restored && n % SNAP_CHECK_EVERY == 0 && n / SNAP_CHECK_EVERY < 64 && snaps->full[n / SNAP_CHECK_EVERY]){
+            snaps->checked++;
+            snaps->check_failed += memcmp(cpu->mem.base, snaps->full[n / SNAP_CHECK_EVERY], MEM_SIZE) != 0 ||
+                                   cpu->cycles != snaps->full_cycles[n / SNAP_CHECK_EVERY];
+        }
+    }
+
+    mem_free(&cpu->mem);
+    free_cpu_8080(cpu);
+    return ret;
+}
+
+/**
+ * @brief Prints what the snapshots took, next to keeping them in full,
+ * then drops every other one and frees the store
+ *
+ * @param snaps
+ */
+static void report_snap(bench_snaps* snaps){
+    snap_store* store = &snaps->store;
+    double flat = (double)snaps->count * (MEM_SIZE + sizeof(cpu_state));
+    double kept = snap_bytes(store);
+    printf("%-10s %u of them: %.1f MB in full, %.2f MB stored (%.1f%%) in %u distinct pages | "
+           "take %.2f us, restore %.2f us (%.1f pages copied), %u/%u checked restores match\n",
+           "snapshots", snaps->count, flat / 1e6, kept / 1e6, 100.0 * kept / flat, store->live_pages,
+           snaps->take_ns / 1e3 / snaps->count, snaps->restore_ns / 1e3 / snaps->restores,
+           (double)store->pages_copied / snaps->restores, snaps->checked - snaps->check_failed, snaps->checked);
+    for (uint32_t n = 1; n < snaps->count; n += 2){
+        snap_drop(store, snaps->ids[n]);
+    }
+    printf("%-10s every other one dropped: %u left in %u distinct pages, %.2f MB\n",
+           "snapshots", store->live_snaps, store->live_pages, snap_bytes(store) / 1e6);
+    snap_free(store);
+    free(snaps->ids);
+    for (uint32_t i = 0; i < 64; i++){
+        free(snaps->full[i]);
+    }
+}
+
+/**
+ * @brief Runs the cpu diagnostic ROM back to back until the cycle
+ * budget is used up. CP/M's warm boot (0x0) is a HLT and the BDOS
+ * print call (0x5) a RET, so every pass ends in a halt.
+ *
+ * @param rom_path path to the cpudiag binary
+ * @param budget emulated cycles to run
+ * @param stats collected counters
+ * @return int 0 on success, -1 on failure
+ */
+static int bench_diag(const char* rom_path, uint64_t budget, bench_stats* stats){
+    cpu_state* cpu = init_cpu_8080(DIAG_LOAD_OFFSET, NULL, NULL);
+    if (!mem_init(&cpu->mem) || load_rom(rom_path, cpu, DIAG_LOAD_OFFSET) == -1){
+        mem_free(&cpu->mem);
+        free_cpu_8080(cpu);
+        return -1;
+    }
+    // Keep a pristine copy of the image (and the stack it sets up
+    // right after it) to reload between passes
+    uint32_t image_size = DIAG_LOAD_OFFSET + cpu->rom_size + DIAG_STACK_SLACK;
+    uint8_t* image = malloc(image_size);
+    mem_write(&cpu->mem, 0x0000, 0x76);  // HLT
+    mem_write(&cpu->mem, 0x0005, 0xC9);  // RET
+    memcpy(image, cpu->mem.base, image_size);
+
+    int ret = 0;
+    uint64_t start = now_ns();
+    while (stats->cycles + cpu->cycles < budget){
+        if (cpu->halt){
+            stats->instructions += cpu->instructions;
+            stats->skipped += cpu->skipped_instructions;
+            stats->cycles += cpu->cycles;
+            stats->idle_cycles += cpu->idle_cycles;
+            stats->loop_cycles += cpu->loop_cycles;
+            // Reload behind the core's back, keeping its memory and engine state
+            v_memory mem = cpu->mem;
+            void* engine_state = cpu->engine_state;
+            void* lockstep_state = cpu->lockstep_state;
+            memcpy(mem.base, image, image_size);
+            memset(cpu, 0, sizeof(cpu_state));
+            cpu->mem = mem;
+            cpu->engine_state = engine_state;
+            cpu->lockstep_state = lockstep_state;
+            cpu->PC = DIAG_LOAD_OFFSET;
+            cpu->SP = 0xF000;
+            cpu->IN_Func = &io_machine_IN;
+            cpu->OUT_Func = &io_machine_OUT;
+            flush_code_cache(cpu);
+        }
+        if (run_cycles(cpu, budget - stats->cycles - cpu->cycles) == -1){
+            fprintf(stderr, "cpudiag: cpu stopped at PC:%x\n", cpu->PC);
+            ret = -1;
+            break;
+        }
+    }
+    stats->host_ns += now_ns() - start;
+    stats->instructions += cpu->instructions;
+    stats->skipped += cpu->skipped_instructions;
+    stats->cycles += cpu->cycles;
+    stats->idle_cycles += cpu->idle_cycles;
+    stats->loop_cycles += cpu->loop_cycles;
+
+    free(image);
+    mem_free(&cpu->mem);
+    free_cpu_8080(cpu);
+    return ret;
+}
+
+/**
+ * @brief Prints a run's counters. Minst/s and ns/inst are of the
+ * instructions the engine ran, the ones idle skipping, loop idioms and
+ * HLE charged without running them are counted apart as skipped.
+ *
+ * @param name
+ * @param stats
+ */
+static void report(const char* name, const bench_stats* stats){
+    double secs = stats->host_ns / 1e9;
+    uint64_t run = stats->instructions - stats->skipped;
+    printf("%-10s inst:%12" PRIu64 " skipped:%12" PRIu64 " cycles:%12" PRIu64 " host:%8.3fs | "
+           "%8.2f Minst/s %8.2f emulated MHz %7.2f ns/inst | idle:%5.1f%% hle:%5.1f%% loop:%5.1f%%\n",
+           name, stats->instructions, stats->skipped, stats->cycles, secs,
+           run / secs / 1e6,
+           stats->cycles / secs / 1e6,
+           run ? (double)stats->host_ns / run : 0.0,
+           100.0 * stats->idle_cycles / stats->cycles,
+           100.0 * stats->hle_cycles / stats->cycles,
+           100.0 * stats->loop_cycles / stats->cycles);
+}
+
+/**
+ * @brief Prints how much of the screen vram_render redrew per frame
+ *
+ * @param stats
+ */
+static void report_vram(const bench_stats* stats){
+    const vram_tracker* vt = &stats->vram;
+    if(!vt->frames){
+        return;
+    }
+    printf("%-10s redrawn per frame: %5.1f%% of lines %5.1f%% of bytes %7.2f us/frame\n", "vram",
+           100.0 * vt->lines_drawn / (vt->frames * VRAM_LINES),
+           100.0 * vt->bytes_drawn / (vt->frames * VRAM_SIZE),
+           stats->render_ns / 1e3 / vt->frames);
+}
+
+/**
+ * @brief bench driver.
+ * usage: bench [frames] [rom_folder] [diag_rom] [pair_profile] [code_cache] [instances] [heat_dump]
+ * pair_profile is where a `PROFILE_PAIRS=1` build writes the opcode
+ * pair counts of the invaders run, the invaders run starts from and
+ * saves back to code_cache (see pcache_8080.h). The compact run sweeps
+ * 1, 4, 16... up to instances machines (0 skips it). A `MEM_HEAT=1`
+ * build dumps the invaders run's memory accesses to heat_dump.
+ *
+ * @return int 0 if success, else error code
+ */
+int main(int argc, char** argv){
+    uint32_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_FRAMES;
+    const char* rom_dir = argc > 2 ? argv[2] : "./invaders_rom";
+    const char* diag_path = argc > 3 ? argv[3] : "./assets/debug.bin";
+    UNUSED const char* profile_path = argc > 4 ? argv[4] : "./build/pair_profile.txt";
+    const char* cache_path = argc > 5 ? argv[5] : "./build/invaders.pcache";
+    UNUSED uint32_t instances = argc > 6 ? strtoul(argv[6], NULL, 0) : COMPACT_INSTANCES;
+    const char* heat_path = argc > 7 ? argv[7] : "./build/heat.bin";
+    char rom_path[256];
+    snprintf(rom_path, sizeof(rom_path), "%s/%s", rom_dir, "invaders.hgfe");
+
+#ifdef LOCKSTEP
+    printf("engine: %s, in lockstep with the interpreter\n", engine_name());
+#else
+    printf("engine: %s\n", engine_name());
+#endif
+    int ret = 0;
+    bench_stats stats = {0};
+    if (bench_invaders(rom_path, frames, cache_path, heat_path, &stats) == 0){
+        report("invaders", &stats);
+        report_vram(&stats);
+#ifdef PROFILE_PAIRS
+        pair_profile_dump(profile_path);
+        pair_profile_reset();
+#endif
+    } else {
+        fprintf(stderr, "invaders bench failed, did you `make extractROM`?\n");
+        ret = -1;
+    }
+
+    bench_snaps snaps = {0};
+    if (bench_snap(rom_path, frames, &snaps) == 0 && snaps.restores){
+        report_snap(&snaps);
+    } else {
+        fprintf(stderr, "snapshot bench failed.\n");
+        ret = -1;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    if (bench_diag(diag_path, DIAG_CYCLES, &stats) == 0){
+        report("cpudiag", &stats);
+    } else {
+        fprintf(stderr, "cpudiag bench failed.\n");
+        ret = -1;
+    }
+
+#ifdef BENCH_COMPACT
+    if (instances){
+        report_compact_size();
+    }
+    for(uint32_t count = 1; count && count <= instances; count = count < instances && count * 4 > instances ? instances : count * 4){
+        char name[32];
+        snprintf(name, sizeof(name), "x%u", count);
+        memset(&stats, 0, sizeof(stats));
+        if (bench_compact(rom_path, count, &stats) == 0){
+            report(name, &stats);
+        } else {
+            fprintf(stderr, "compact bench failed.\n");
+            ret = -1;
+            break;
+        }
+        if (count == instances){
+            break;
+        }
+    }
+#endif
+    return ret;
+}
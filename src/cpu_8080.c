@@ -10,10 +10,62 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include "debug.h"
 #include "cpu_8080.h"
+#include "engine_8080.h"
+#include "lockstep_8080.h"
 #include "opcodes_8080.h"
 
+///@{
+/** Expands a table of 4, 16, 64 or 256 ENTRY(i) at compile time */
+#define LUT_4(ENTRY, i)     ENTRY(i), ENTRY(i + 1), ENTRY(i + 2), ENTRY(i + 3)
+#define LUT_16(ENTRY, i)    LUT_4(ENTRY, i), LUT_4(ENTRY, i + 4), LUT_4(ENTRY, i + 8), LUT_4(ENTRY, i + 12)
+#define LUT_64(ENTRY, i)    LUT_16(ENTRY, i), LUT_16(ENTRY, i + 16), LUT_16(ENTRY, i + 32),    \
+                            LUT_16(ENTRY, i + 48)
+#define LUT_256(ENTRY, i)   LUT_64(ENTRY, i), LUT_64(ENTRY, i + 64), LUT_64(ENTRY, i + 128),   \
+                            LUT_64(ENTRY, i + 192)
+///@}
+
+///@{
+/** Builds szp_flag_lookup at compile time, 0x000-0x0FF are result bytes,
+ * 0x100-0x1FF explicit SZP_FLAGS bits from POP PSW */
+#define PARITY_EVEN(v)  (!(((v) ^ ((v) >> 1) ^ ((v) >> 2) ^ ((v) >> 3) ^ \
+                           ((v) >> 4) ^ ((v) >> 5) ^ ((v) >> 6) ^ ((v) >> 7)) & 1))
+#define SZP_ENTRY(i)    (((i) & SZP_EXPLICIT) ? ((i) & SZP_FLAGS) :        \
+                         (((i) & 0x80) ? SIGN_FLAG : 0) |                  \
+                         (((i) & 0xFF) == 0 ? ZERO_FLAG : 0) |             \
+                         (PARITY_EVEN(i) ? PARITY_FLAG : 0))
+///@}
+
+const uint8_t szp_flag_lookup[0x200] = { LUT_256(SZP_ENTRY, 0), LUT_256(SZP_ENTRY, 0x100) };
+
+///@{
+/** Builds daa_lookup at compile time. The low nibble is adjusted first,
+ * then the high one off the adjusted A and the carry so far */
+#define DAA_A(i)        ((i) & 0xFF)
+#define DAA_LO(i)       ((DAA_A(i) & 0xF) > 0x9 || ((i) & DAA_AUX))
+#define DAA_A1(i)       ((DAA_A(i) + (DAA_LO(i) ? 0x06 : 0)) & 0xFF)
+#define DAA_CY1(i)      (((i) & DAA_CARRY) || (DAA_LO(i) && DAA_A(i) + 0x06 > 0xFF))
+#define DAA_HI(i)       ((DAA_A1(i) >> 4) > 0x9 || DAA_CY1(i))
+#define DAA_ENTRY(i)    (((DAA_A1(i) + (DAA_HI(i) ? 0x60 : 0)) & 0xFF) |                 \
+                         ((DAA_CY1(i) || (DAA_HI(i) && (DAA_A1(i) >> 4) + 0x06 > 0xF)) ? \
+                          DAA_CARRY : 0) |                                              \
+                         ((DAA_LO(i) && (DAA_A(i) & 0xF) + 0x06 > 0xF) ? DAA_AUX : 0))
+///@}
+
+const uint16_t daa_lookup[0x400] = {
+    LUT_256(DAA_ENTRY, 0), LUT_256(DAA_ENTRY, 0x100),
+    LUT_256(DAA_ENTRY, 0x200), LUT_256(DAA_ENTRY, 0x300)
+};
+
+#ifdef PROFILE_PAIRS
+/** Times opcode (index & 0xFF) ran straight after opcode (index >> 8) */
+static uint64_t pair_counts[0x10000];
+/** Opcode run last, PAIR_NONE after an interrupt */
+static uint16_t pair_prev = PAIR_NONE;
+#endif
+
 // Main Externally visible Functions
 cpu_state* init_cpu_8080(uint16_t pc, uint8_t (*in_cb)(uint8_t), void (*out_cb)(uint8_t, uint8_t)){
     // Malloc a new struct
@@ -33,51 +85,277 @@ cpu_state* init_cpu_8080(uint16_t pc, uint8_t (*in_cb)(uint8_t), void (*out_cb)(
     return cpu;
 }
 
-int exec_inst(cpu_state* cpu){
+void free_cpu_8080(cpu_state* cpu){
+#if defined(ENGINE_BLOCK)
+    block_cache_free(cpu);
+#elif defined(ENGINE_JIT)
+    jit_cache_free(cpu);
+#elif defined(ENGINE_AOT)
+    aot_cache_free(cpu);
+#endif
+#ifdef LOCKSTEP
+    lockstep_free(cpu);
+#endif
+    free(cpu);
+}
+
+#ifdef MEM_HASH
+uint64_t cpu_fingerprint(cpu_state* cpu){
+    uint64_t pairs = (uint64_t)cpu->BC | (uint64_t)cpu->DE << 16 | (uint64_t)cpu->HL << 32 | (uint64_t)cpu->SP << 48;
+    uint64_t rest = (uint64_t)cpu->PC | (uint64_t)cpu->ACC << 16 | (uint64_t)compress_PSW(cpu->PSW) << 24 |
+                    (uint64_t)cpu->intt << 32 | (uint64_t)cpu->pend_intt << 40 | (uint64_t)cpu->halt << 48;
+    return mem_hash(&cpu->mem) ^ mem_mix(pairs) ^ mem_mix(mem_mix(rest));
+}
+#endif
+
+void flush_code_cache(cpu_state* cpu){
+    mem_hash_reset(&cpu->mem);
+#if defined(ENGINE_BLOCK)
+    block_cache_flush(cpu);
+#elif defined(ENGINE_JIT)
+    jit_cache_flush(cpu);
+#elif defined(ENGINE_AOT)
+    aot_cache_flush(cpu);
+#endif
+#ifdef LOCKSTEP
+    lockstep_sync(cpu);
+#endif
+}
 
+/**
+ * @brief Takes the lowest pending interrupt, running its RST. Only
+ * call with cpu->intt and cpu->pend_intt set.
+ * 
+ * @param cpu 
+ * @return int 1 of success, -1 if fail
+ */
+static inline int take_intt(cpu_state* cpu){
+    // Entering Intt Handler, disable Intt
+    cpu->intt = 0;
+    uint8_t index = __builtin_ctz(cpu->pend_intt);
+    uint8_t op_code = 0xC7 | (index << 3);
+    cpu->pend_intt &= ~(1u << index);  // Marking Intt as handled
+#ifdef PROFILE_PAIRS
+    pair_prev = PAIR_NONE;
+#endif
+    cpu->cycles += opcode_lookup[op_code].cycle_count;
+    cpu->instructions++;
+    return opcode_lookup[op_code].target_func(cpu, 0xFFFF, op_code);
+}
+
+/**
+ * @brief Executes the instruction at PC and charges its cycles. Shared
+ * by exec_inst and the run_cycles loop so the batch path doesn't pay
+ * for an external call per opcode.
+ * 
+ * @param cpu 
+ * @param op_code the byte at PC
+ * @return int 1 of success, -1 if fail
+ */
+static inline int step_op(cpu_state* cpu, uint8_t op_code){
+    uint16_t inital_pc_ptr = cpu->PC;
+    cpu->PC += opcode_lookup[op_code].size;
+#ifdef MEM_HEAT
+    for(uint16_t i = 0; i < opcode_lookup[op_code].size; i++){
+        mem_heat(&cpu->mem, inital_pc_ptr + i, HEAT_EXEC);
+    }
+#endif
+#ifdef PROFILE_PAIRS
+    if(pair_prev != PAIR_NONE){
+        pair_counts[(pair_prev << 8) | op_code]++;
+    }
+    pair_prev = op_code;
+#endif
+
+    // Conditional CALL/RET charge their extra cycles when taken
+    cpu->cycles += opcode_lookup[op_code].cycle_count;
+    cpu->instructions++;
+    return opcode_lookup[op_code].target_func(cpu, inital_pc_ptr, op_code);
+}
+
+int exec_inst(cpu_state* cpu){
     // Check if Intt Available, if so exec that instead
     if(cpu->intt && cpu->pend_intt){
-        // Entering Intt Handler, disable Intt
-        cpu->intt = 0;
-        uint8_t index = 0;
-        for(uint16_t mask = 0x1; mask <= 0x8; mask <<= 1){
-            if(cpu->pend_intt & mask){
-                uint8_t op_code = 0xC7 | (index << 3);
-                cpu->pend_intt &= (~mask);  // Marking Intt as handled
-                return RST_WRAP(cpu, 0xFFFF, op_code);
+        return take_intt(cpu);
+    }
+    return step_op(cpu, mem_fetch(&cpu->mem, cpu->PC));
+}
+
+int interp_run_cycles(cpu_state* cpu, uint32_t budget){
+    uint64_t target = cpu->cycles + budget;
+    // pend_intt only changes between slices, so a pending intt is taken
+    // when the slice starts or right after the EI which enables it
+    if(cpu->cycles < target && !cpu->halt && cpu->intt && cpu->pend_intt &&
+       take_intt(cpu) != 1){
+        return -1;
+    }
+    while(cpu->cycles < target){
+        if(cpu->halt){
+            return 0;
+        }
+        uint16_t from = cpu->PC;
+        uint8_t op_code = mem_fetch(&cpu->mem, from);
+        if(step_op(cpu, op_code) != 1){
+            return -1;
+        }
+        if(op_code == 0xFB && cpu->pend_intt && cpu->cycles < target){
+            if(take_intt(cpu) != 1){
+                return -1;
             }
-            index++;
+            continue;
+        }
+#ifdef HLE
+        if((op_code == 0xCD || op_code == 0xC3) && hle_hit(cpu, cpu->PC)){
+            hle_call(cpu, target);
+            continue;
+        }
+#endif
+#ifdef IDLE_SKIP
+        // Only jumps close loops, RET and intts coming back near by don't
+        if((uint16_t)(from - cpu->PC) < IDLE_MAX_BYTES && cpu->idle_reject != (0x10000u | cpu->PC) &&
+           (op_code == 0xC3 || (op_code & 0xC7) == 0xC2)){
+            idle_skip(cpu, from, target);
         }
-        // Shoild never reach here
-        abort();
+#endif
     }
+    return 1;
+}
 
-    // If not, normal exec
-    uint8_t Instt = mem_read(&cpu->mem, cpu->PC);
-    uint16_t inital_pc_ptr = cpu->PC;
-    cpu->PC += opcode_lookup[Instt].size;
-    
-    // TODO: Remove
-    if(opcode_lookup[Instt].target_func == 0x0){
-         opcode_lookup[Instt].target_func = UNDEFINED_OP_WRAP;
+int engine_run_cycles(cpu_state* cpu, uint32_t budget){
+    // The engines address the window directly, maps it doesn't show are interpreted
+    if(!cpu->mem.direct){
+        return interp_run_cycles(cpu, budget);
     }
+#if defined(ENGINE_THREADED)
+    return threaded_run_cycles(cpu, budget);
+#elif defined(ENGINE_BLOCK)
+    return block_run_cycles(cpu, budget);
+#elif defined(ENGINE_JIT)
+    return jit_run_cycles(cpu, budget);
+#elif defined(ENGINE_AOT)
+    return aot_run_cycles(cpu, budget);
+#else
+    return interp_run_cycles(cpu, budget);
+#endif
+}
 
-    int ret = opcode_lookup[Instt].target_func(cpu, inital_pc_ptr, Instt);
-    return ret;
+int run_cycles(cpu_state* cpu, uint32_t budget){
+#ifdef LOCKSTEP
+    return lockstep_run_cycles(cpu, budget);
+#else
+    return engine_run_cycles(cpu, budget);
+#endif
+}
+
+const char* engine_name(){
+#if defined(ENGINE_THREADED)
+    return "threaded";
+#elif defined(ENGINE_BLOCK)
+    return "block";
+#elif defined(ENGINE_JIT)
+    return "jit";
+#elif defined(ENGINE_AOT)
+    return "aot";
+#else
+    return "interp";
+#endif
+}
+
+int run_frame(cpu_state* cpu){
+    return run_cycles(cpu, CYCLES_PER_FRAME);
+}
+
+uint8_t opcode_cycles(uint8_t op_code){
+    return opcode_lookup[op_code].cycle_count;
+}
+
+uint8_t opcode_size(uint8_t op_code){
+    return opcode_lookup[op_code].size;
+}
+
+opcode_handler opcode_func(uint8_t op_code){
+    return opcode_lookup[op_code].target_func;
+}
+
+uint8_t opcode_ends_block(uint8_t op_code){
+    if(op_code >= 0xC0){
+        switch (op_code & 0x07)
+        {
+        case 0x0:   // Rcc
+        case 0x2:   // Jcc
+        case 0x4:   // Ccc
+        case 0x7:   // RST
+            return 1;
+        default:
+            break;
+        }
+    }
+    switch (op_code)
+    {
+    case 0x76:  // HLT
+    case 0xC3: case 0xCB:   // JMP
+    case 0xC9: case 0xD9:   // RET
+    case 0xCD:  // CALL
+    case 0xD3: case 0xDB:   // OUT, IN
+    case 0xE9:  // PCHL
+    case 0xFB:  // EI
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+#ifdef PROFILE_PAIRS
+/**
+ * @brief qsort order for pair indices, most frequent first
+ */
+static int pair_cmp(const void* x, const void* y){
+    uint64_t cx = pair_counts[*(const uint16_t*)x], cy = pair_counts[*(const uint16_t*)y];
+    return cx < cy ? 1 : cx > cy ? -1 : 0;
+}
+#endif
+
+int pair_profile_dump(UNUSED const char* path){
+#ifdef PROFILE_PAIRS
+    FILE* out = fopen(path, "w");
+    if(!out){
+        WARN(0, "%s\n", "can't write the pair profile");
+        return -1;
+    }
+    static uint16_t order[0x10000];
+    uint64_t total = 0;
+    for(uint32_t i = 0; i < 0x10000; i++){
+        order[i] = i;
+        total += pair_counts[i];
+    }
+    qsort(order, 0x10000, sizeof(order[0]), &pair_cmp);
+    fprintf(out, "# 8080 opcode pair profile, %" PRIu64 " pairs\n"
+                 "# first second count\n", total);
+    for(uint32_t i = 0; i < 0x10000 && pair_counts[order[i]]; i++){
+        fprintf(out, "%02X %02X %" PRIu64 "\n", order[i] >> 8, order[i] & 0xFF,
+                pair_counts[order[i]]);
+    }
+    fclose(out);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void pair_profile_reset(){
+#ifdef PROFILE_PAIRS
+    memset(pair_counts, 0, sizeof(pair_counts));
+    pair_prev = PAIR_NONE;
+#endif
 }
 
 int decompile_inst(cpu_state* cpu, uint16_t* next_inst){
-    uint8_t Instt = mem_read(&cpu->mem, (*next_inst));
+    uint8_t Instt = mem_fetch(&cpu->mem, (*next_inst));
     cpu->PC = (*next_inst);
 
     (*next_inst) += opcode_lookup[Instt].size;
 
     uint16_t inital_pc_ptr = cpu->PC;
-    
-    // TODO: Remove
-    if(opcode_lookup[Instt].target_func == 0x0){
-         opcode_lookup[Instt].target_func = UNDEFINED_OP_WRAP;
-    }
 
     int ret = opcode_lookup[Instt].target_func(cpu, inital_pc_ptr, Instt);
     return ret;
@@ -110,21 +388,23 @@ uint8_t io_machine_IN(UNUSED uint8_t port){
     return 0x0;
 }
 
-void print_state(const cpu_state cpu){
+void print_state(cpu_state cpu){
     printf("+++++++++++++++++++++++++++++++++++++++++++++++++\n");
     printf("CPU State Dump:\n");
     printf("======GP======\n");
-    printf("B:%x\n", cpu.B);
-    printf("C:%x\n", cpu.C);
-    printf("D:%x\n", cpu.D);
-    printf("E:%x\n", cpu.E);
-    printf("H:%x\n", cpu.H);
-    printf("L:%x\n", cpu.L);
+    // Not M, a dump shouldn't read guest memory
+    for(uint8_t code = 0; code < 6; code++){
+        printf("%c:%x\n", "BCDEHL"[code], cpu_reg_read(&cpu, code));
+    }
+    for(uint8_t rp = 0; rp < 3; rp++){
+        printf("%s:%x\n", (const char*[]){"BC", "DE", "HL"}[rp], cpu_pair_read(&cpu, rp));
+    }
     printf("=====SPCL=====\n");
-    printf("ACC:%x\n", cpu.ACC);
-    printf("PSW: C:%x A:%x S:%x Z:%x P:%x\n",   cpu.PSW.carry, cpu.PSW.aux, cpu.PSW.sign,
-                                                cpu.PSW.zero, cpu.PSW.parity);
-    printf("SP:%x\n", cpu.SP);
+    printf("ACC:%x\n", cpu_reg_read(&cpu, 7));
+    printf("PSW: C:%x A:%x S:%x Z:%x P:%x\n",   psw_carry(&cpu.PSW), psw_aux(&cpu.PSW),
+                                                psw_sign(&cpu.PSW), psw_zero(&cpu.PSW),
+                                                psw_parity(&cpu.PSW));
+    printf("SP:%x\n", cpu_pair_read(&cpu, 3));
     printf("PC:%x\n", cpu.PC);
     printf("Intt:%x\n", cpu.intt);
     printf("======IMG=====\n");
@@ -0,0 +1,116 @@
+/**
+ * @file cpu_aot.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Ahead of time engine, `make ENGINE=aot`. Runs the aot_exec that
+ * aot_8080 generated off the invaders ROM at build time, as long as guest
+ * memory still holds that exact ROM. Everything the translation left out
+ * (interrupts, RST, PCHL, RAM, a budget ending mid block) runs on
+ * exec_inst, as does any other image.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+
+/**
+ * @brief Per cpu view of the translation, kept in cpu->engine_state
+ */
+typedef struct {
+    uint8_t checked;            /**< Guest ROM compared with aot_rom_image since the last flush */
+    uint8_t usable;             /**< The translation matches guest memory */
+    uint8_t rom_pages[0x100];   /**< Pages the translation was made from, the memory watch */
+} aot_state;
+
+/**
+ * @brief memory watch callback, a write into the ROM outdates the
+ * translation until the next flush
+ *
+ * @param ctx the aot_state
+ * @param offset written to
+ */
+static void aot_watch_hit(void* ctx, UNUSED uint16_t offset){
+    ((aot_state*)ctx)->usable = 0;
+}
+
+/**
+ * @brief Creates the cpu's aot_state and hooks it up to the memory watch
+ *
+ * @param cpu
+ * @return aot_state*
+ */
+static aot_state* aot_state_init(cpu_state* cpu){
+    aot_state* state = calloc(1, sizeof(aot_state));
+    memset(state->rom_pages, 1, (aot_rom_size + 0xFF) >> 8);
+    cpu->engine_state = state;
+    mem_watch_set(&cpu->mem, state->rom_pages, &aot_watch_hit, state);
+    return state;
+}
+
+void aot_cache_flush(cpu_state* cpu){
+    if(cpu->engine_state){
+        ((aot_state*)cpu->engine_state)->checked = 0;
+    }
+}
+
+void aot_cache_free(cpu_state* cpu){
+    if(cpu->engine_state){
+        mem_watch_set(&cpu->mem, NULL, NULL, NULL);
+        free(cpu->engine_state);
+        cpu->engine_state = NULL;
+    }
+}
+
+int aot_run_cycles(cpu_state* cpu, uint32_t budget){
+    aot_state* state = cpu->engine_state;
+    if(!state){
+        state = aot_state_init(cpu);
+    }
+    if(!state->checked){
+        state->usable = !memcmp(cpu->mem.base, aot_rom_image, aot_rom_size);
+        state->checked = 1;
+    }
+    uint64_t target = cpu->cycles + budget;
+    while(cpu->cycles < target){
+        if(cpu->halt){
+            return 0;
+        }
+        // exec_inst takes the pending intt, translated code never sees one
+        if(cpu->intt && cpu->pend_intt){
+            if(exec_inst(cpu) != 1){
+                return -1;
+            }
+            continue;
+        }
+        if(state->usable){
+            if(aot_exec(cpu, target) == AOT_ROM_WRITTEN){
+                state->usable = 0;
+            }
+            if(cpu->cycles >= target || cpu->halt || (cpu->intt && cpu->pend_intt)){
+                continue;
+            }
+        }
+#ifdef HLE
+        // aot_exec leaves calls into the routines to hle_call, which
+        // writes through the watch
+        if(hle_hit(cpu, cpu->PC) && hle_call(cpu, target)){
+            continue;
+        }
+#endif
+        // Not translated, or the budget ends inside the block: step one run of straight line code
+        uint8_t op_code;
+        do {
+            op_code = mem_read(&cpu->mem, cpu->PC);
+            if(exec_inst(cpu) != 1){
+                return -1;
+            }
+        } while(!opcode_ends_block(op_code) && cpu->cycles < target &&
+                !(cpu->intt && cpu->pend_intt));
+    }
+    return 1;
+}
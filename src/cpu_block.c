@@ -0,0 +1,588 @@
+/**
+ * @file cpu_block.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Block cache execution engine for the 8080. Straight line runs of
+ * guest code are decoded once into arrays of predecoded ops (handler,
+ * operand, size and cycles resolved up front) and run from there. A block
+ * is charged its summed cycles on entry. Writes into cached code invalidate
+ * the blocks covering it, so RAM resident code stays correct. The opcode
+ * pairs in fused_ops_8080.h are decoded as one superinstruction, whose
+ * handler runs both bodies without dispatching in between.
+ * @note Shares the opcode bodies with the threaded engine, needs GCC/Clang
+ * labels-as-values. Selected with `make ENGINE=block`.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "threaded_ops_8080.h"
+#include "fused_ops_8080.h"
+
+#ifdef __GNUC__
+
+#define BLOCK_MAX_OPS       32                      /** Ops decoded into one block at most */
+#define BLOCK_MAX_BYTES     (BLOCK_MAX_OPS * 3)     /** Guest bytes one block can cover */
+#define BLOCK_MAX_CYCLES    (BLOCK_MAX_OPS * 18)    /** Most cycles one block can charge (18 for XTHL) */
+#define BLOCK_POOL_SIZE     4096                    /** Blocks cached before the cache is flushed */
+#define BLOCK_CACHE_VERSION 1                       /** Bump when decoding or the code cache records change */
+#define BLOCK_FUSED_ID      0x100                   /** block_op_record handler of fused_table[0] */
+#define BLOCK_EXIT_ID       0xFFFF                  /** block_op_record handler of the block exit */
+
+/**
+ * @brief A predecoded instruction
+ */
+typedef struct {
+    const void* label;  /**< Opcode body to run, or the block exit */
+    uint16_t imm;       /**< byte 2 or bytes 3:2 of the instruction */
+    uint8_t size;       /**< Instruction size in bytes */
+    uint8_t cycles;     /**< Clock cycles charged (not taken count) */
+} block_op;
+
+/**
+ * @brief A fused opcode pair's handler
+ */
+typedef struct {
+    uint16_t pair;      /**< First opcode << 8 | second opcode */
+    const void* label;  /**< Runs both ops, entered on the first's block_op */
+} block_fused;
+
+/**
+ * @brief A straight line run of guest code, ends at the first
+ * instruction that can leave it (jumps, calls, returns, IO, EI, HLT).
+ */
+typedef struct {
+    uint16_t start;         /**< Guest address of the first op */
+    uint8_t len;            /**< Number of ops, not counting the exit */
+    uint8_t bytes;          /**< Guest bytes covered from start */
+    uint32_t cycles;        /**< Summed cycles of all the ops */
+    uint32_t lead_cycles;   /**< Summed cycles of all but the last op */
+    block_op ops[BLOCK_MAX_OPS + 1]; /**< The ops, followed by the exit */
+} block_8080;
+
+/**
+ * @brief A block in the code cache file, followed by its len + 1
+ * block_op_records. Read and written with memcpy, records aren't aligned.
+ */
+typedef struct {
+    uint16_t start;
+    uint8_t len;
+    uint8_t bytes;
+    uint32_t cycles;
+    uint32_t lead_cycles;
+} block_record;
+
+/**
+ * @brief A block_op in the code cache file, labels differ from run to run
+ */
+typedef struct {
+    uint16_t handler;   /**< Opcode, BLOCK_FUSED_ID + fused index or BLOCK_EXIT_ID */
+    uint16_t imm;
+    uint8_t size;
+    uint8_t cycles;
+} block_op_record;
+
+/**
+ * @brief Per cpu block cache, hung off cpu->engine_state
+ */
+typedef struct {
+    block_8080* lookup[0x10000];        /**< Live block starting at each address */
+    uint8_t code_bytes[0x10000 / 8];    /**< Bit per address covered by a block */
+    uint8_t code_pages[0x100];          /**< Pages holding any code, the memory watch */
+    v_memory* mem;                      /**< Memory the watch is hooked up to */
+    block_8080* current;                /**< Block being run, NULL if single stepping */
+    uint32_t used;                      /**< Blocks handed out of the pool */
+    block_8080 pool[BLOCK_POOL_SIZE];
+} block_cache;
+
+/**
+ * @brief Marks the guest bytes of a block as code
+ *
+ * @param cache
+ * @param block
+ * @param set 1 to mark, 0 to clear
+ */
+static void block_mark(block_cache* cache, const block_8080* block, uint8_t set){
+    for(uint16_t i = 0; i < block->bytes; i++){
+        uint16_t addr = block->start + i;
+        if(set){
+            cache->code_bytes[addr >> 3] |= 1 << (addr & 7);
+            if(!cache->code_pages[addr >> 8]){
+                cache->code_pages[addr >> 8] = 1;
+                mem_watch_sync(cache->mem, addr >> 8, 1);
+            }
+        } else {
+            cache->code_bytes[addr >> 3] &= ~(1 << (addr & 7));
+        }
+    }
+}
+
+/**
+ * @brief Invalidates every block covering a written address
+ *
+ * @param cache
+ * @param offset written to
+ * @return int 1 if the block being run was one of them
+ */
+static int block_write_hit(block_cache* cache, uint16_t offset){
+    if(!(cache->code_bytes[offset >> 3] & (1 << (offset & 7)))){
+        return 0;
+    }
+    int hit_current = 0;
+    for(uint16_t back = 0; back < BLOCK_MAX_BYTES; back++){
+        uint16_t start = offset - back;
+        block_8080* block = cache->lookup[start];
+        if(block && back < block->bytes){
+            cache->lookup[start] = NULL;
+            hit_current |= (block == cache->current);
+        }
+    }
+    cache->code_bytes[offset >> 3] &= ~(1 << (offset & 7));
+    return hit_current;
+}
+
+/**
+ * @brief memory watch callback, writes through mem_write/short_mem_write
+ *
+ * @param ctx the block_cache
+ * @param offset written to
+ */
+static void block_watch_hit(void* ctx, uint16_t offset){
+    block_write_hit((block_cache*)ctx, offset);
+}
+
+/**
+ * @brief Drops every block handed out of the pool
+ *
+ * @param cache
+ */
+static void block_pool_flush(block_cache* cache){
+    for(uint32_t i = 0; i < cache->used; i++){
+        block_8080* block = &cache->pool[i];
+        if(cache->lookup[block->start] == block){
+            cache->lookup[block->start] = NULL;
+        }
+        block_mark(cache, block, 0);
+    }
+    memset(cache->code_pages, 0, sizeof(cache->code_pages));
+    mem_watch_sync(cache->mem, 0, MEM_PAGES);
+    cache->current = NULL;
+    cache->used = 0;
+}
+
+void block_cache_flush(cpu_state* cpu){
+    if(cpu->engine_state){
+        block_pool_flush(cpu->engine_state);
+    }
+}
+
+void block_cache_free(cpu_state* cpu){
+    if(cpu->engine_state){
+        mem_watch_set(&cpu->mem, NULL, NULL, NULL);
+        free(cpu->engine_state);
+        cpu->engine_state = NULL;
+    }
+}
+
+/**
+ * @brief Creates the cpu's block cache and hooks it up to the memory watch
+ *
+ * @param cpu
+ * @return block_cache*
+ */
+static block_cache* block_cache_init(cpu_state* cpu){
+    block_cache* cache = calloc(1, sizeof(block_cache));
+    cache->mem = &cpu->mem;
+    cpu->engine_state = cache;
+    mem_watch_set(&cpu->mem, cache->code_pages, &block_watch_hit, cache);
+    return cache;
+}
+
+/**
+ * @brief Predecodes the instruction at pc
+ *
+ * @param out decoded op
+ * @param mem guest memory
+ * @param pc
+ * @param labels opcode body per opcode
+ */
+static void block_decode_op(block_op* out, v_memory* mem, uint16_t pc, const void* const* labels){
+    uint8_t op = mem_read(mem, pc);
+    out->label = labels[op];
+    out->size = opcode_size(op);
+    out->cycles = opcode_cycles(op);
+    out->imm = 0;
+    if(out->size == 2){
+        out->imm = mem_read(mem, pc + 1);
+    } else if(out->size == 3){
+        // Same read as the interpreter, even at the top of memory
+        out->imm = short_mem_read(mem, pc + 1);
+    }
+}
+
+/**
+ * @brief Decodes and caches the block starting at pc
+ *
+ * @param cache
+ * @param mem guest memory
+ * @param pc
+ * @param labels opcode body per opcode
+ * @param fused superinstructions to use
+ * @param fused_count entries in fused
+ * @param exit_label the block exit
+ * @return block_8080*
+ * @note Kept out of line, inlined it costs block_run_cycles its registers
+ */
+static __attribute__((noinline)) block_8080* block_decode(block_cache* cache, v_memory* mem, uint16_t pc,
+                                const void* const* labels, const block_fused* fused,
+                                uint32_t fused_count, const void* exit_label){
+    if(cache->used == BLOCK_POOL_SIZE){
+        DEBUG_PRINT("%s\n", "Block pool full, flushing.");
+        block_pool_flush(cache);
+    }
+    block_8080* block = &cache->pool[cache->used++];
+    block->start = pc;
+    block->len = 0;
+    block->bytes = 0;
+    block->cycles = 0;
+    block->lead_cycles = 0;
+    uint8_t prev_op = 0;
+    while(block->len < BLOCK_MAX_OPS){
+        uint16_t op_pc = pc + block->bytes;
+        uint8_t op = mem_read(mem, op_pc);
+        block_op* ins = &block->ops[block->len];
+        block_decode_op(ins, mem, op_pc, labels);
+        // Never let a block wrap around the address space
+        uint8_t wraps = op_pc + ins->size >= 0x10000;
+        if(wraps && block->len){
+            break;
+        }
+        block->lead_cycles = block->cycles;
+        block->cycles += ins->cycles;
+        block->bytes += ins->size;
+        block->len++;
+        // The previous op always runs on into this one, try fusing the two
+        for(uint32_t i = 0; block->len > 1 && i < fused_count; i++){
+            if(fused[i].pair == ((prev_op << 8) | op)){
+                ins[-1].label = fused[i].label;
+                break;
+            }
+        }
+        prev_op = op;
+        if(wraps || opcode_ends_block(op)){
+            break;
+        }
+    }
+    block->ops[block->len].label = exit_label;
+    block->ops[block->len].size = 0;
+    block->ops[block->len].cycles = 0;
+    block_mark(cache, block, 1);
+    cache->lookup[pc] = block;
+    return block;
+}
+
+///@{
+/** Guest memory access, same addressing as mem_ref. Stores check the
+ * watch, and end the block early if they overwrote it. Stores to ROM go
+ * through mem_write to be dropped. */
+#define MEM_PTR(addr)   ((uintptr_t)mem_base | (uint16_t)(addr))
+#define MEM_TRAP(addr)  (mem_pages[(uint16_t)(addr) >> 8] & MEM_STORE_TRAP)
+#define RD8(addr)       (*(uint8_t *)MEM_PTR(addr))
+#define RD16(addr)      (*(uint16_t *)MEM_PTR(addr))
+#define SMC_CHECK(addr) do { uint16_t w_ = (addr);                                  \
+                             if((cache->code_bytes[w_ >> 3] & (1 << (w_ & 7))) &&   \
+                                block_write_hit(cache, w_)){                        \
+                                 ins[1].label = &&smc_exit;                         \
+                             } } while(0)
+#define WR8(addr, val)  do { uint16_t a_ = (addr);                                  \
+                             if(MEM_TRAP(a_)){                                      \
+                                 mem_write(&cpu->mem, a_, (val));                   \
+                             } else {                                               \
+                                 *(uint8_t *)MEM_PTR(a_) = (val);                   \
+                                 SMC_CHECK(a_);                                     \
+                             } } while(0)
+#define WR16(addr, val) do { uint16_t a_ = (addr);                                  \
+                             if(MEM_TRAP(a_) | MEM_TRAP(a_ + 1)){                   \
+                                 short_mem_write(&cpu->mem, a_, (val));             \
+                             } else {                                               \
+                                 *(uint16_t *)MEM_PTR(a_) = (val);                  \
+                                 SMC_CHECK(a_); SMC_CHECK(a_ + 1);                  \
+                             } } while(0)
+#define IMM8            ((uint8_t)ins->imm)
+#define IMM16           (ins->imm)
+/** A CALL pushing over its own operand jumps where the push left it */
+#define CALL_IMM16      RD16(pc + 1)
+///@}
+
+///@{
+/** Dispatch: NEXT runs on to the next predecoded op, DISPATCH looks up
+ * the block at pc */
+#define OP_LABEL(code, body)    &&op_##code,
+#define OP_BODY(code, body)     op_##code: body;
+#define DISPATCH()      do { if(cycles >= target) goto slice_end;                   \
+                             goto block_enter; } while(0)
+#define NEXT_DISPATCH(n) do { pc += (n); ins++; goto *ins->label; } while(0)
+#define NEXT(n)         NEXT_DISPATCH(n)
+///@}
+
+///@{
+/** Superinstructions: expanded with NEXT falling through, the first body
+ * runs on into a direct jump to the second op's body. That one is skipped
+ * if the first overwrote it. */
+#define NEXT_FALL(n)    do { pc += (n); ins++; } while(0)
+#define FUSED_ENTRY(x, y, first, second)    { 0x##x##y, &&fused_##x##_##y },
+#define FUSED_BODY(x, y, first, second)     fused_##x##_##y: first;                         \
+                                            if(ins->label == &&smc_exit) goto smc_exit;     \
+                                            goto op_##y;
+///@}
+
+/** Cycle counts copied out of opcode_lookup on first use */
+static uint8_t op_cycles[0x100];
+static uint8_t op_cycles_ready;
+
+///@{
+/** block_run_cycles' handlers, published by its first call (one with a
+ * NULL cpu does nothing else) for the code cache records */
+static const void* const* block_labels;
+static const block_fused* block_fused_ops;
+static uint32_t block_fused_count;
+static const void* block_exit_label;
+///@}
+
+int block_run_cycles(cpu_state* cpu, uint32_t budget){
+    static const void* const dispatch_table[0x100] = { OPCODE_BODIES(OP_LABEL) };
+    static const block_fused fused_table[] = { FUSED_OPS(FUSED_ENTRY) };
+    const uint32_t fused_count = 0;
+
+    if(!block_exit_label){
+        block_labels = dispatch_table;
+        block_fused_ops = fused_table;
+        block_fused_count = fused_count;
+        block_exit_label = &&block_exit;
+    }
+    if(!cpu){
+        return 0;
+    }
+    if(!op_cycles_ready){
+        for(uint16_t i = 0; i < 0x100; i++){
+            op_cycles[i] = opcode_cycles(i);
+        }
+        op_cycles_ready = 1;
+    }
+
+    uint64_t cycles = cpu->cycles;
+    uint64_t instructions = cpu->instructions;
+    uint64_t target = cycles + budget;
+    if(cycles < target && cpu->halt){
+        return 0;
+    }
+
+    block_cache* cache = cpu->engine_state;
+    if(!cache){
+        cache = block_cache_init(cpu);
+    }
+    void* mem_base = cpu->mem.base;
+    const uintptr_t* mem_pages = cpu->mem.pages;
+    uint16_t pc, sp;
+    uint8_t a;
+    program_status_word psw;
+    // Single op run when the budget ends inside a block
+    block_op step[2];
+    block_op* ins = step;
+    block_op* ins_end = step;
+    step[1].label = &&block_exit;
+    SYNC_IN();
+    CHECK_INTT();
+    DISPATCH();
+
+block_enter:
+    {
+        block_8080* block = cache->lookup[pc];
+        // Close to the budget, don't cache blocks off mid block addresses
+        if(!block && target - cycles > BLOCK_MAX_CYCLES){
+            block = block_decode(cache, &cpu->mem, pc, dispatch_table, fused_table,
+                                 fused_count, &&block_exit);
+        }
+        if(block && cycles + block->lead_cycles < target){
+            // Every op of the block runs before the budget check
+            cache->current = block;
+            ins = block->ops;
+            ins_end = ins + block->len;
+            cycles += block->cycles;
+            instructions += block->len;
+        } else {
+            // Step so the slice ends on the same op as the interpreter, the
+            // block's first op may be fused with one that isn't in the step
+            cache->current = NULL;
+            block_decode_op(&step[0], &cpu->mem, pc, dispatch_table);
+            step[1].label = &&block_exit;
+            ins = step;
+            ins_end = step + 1;
+            cycles += ins->cycles;
+            instructions++;
+        }
+        goto *ins->label;
+    }
+
+smc_exit:
+    // The block overwrote itself, give back what its remaining ops were charged
+    for(; ins < ins_end; ins++){
+        cycles -= ins->cycles;
+        instructions--;
+    }
+block_exit:
+    DISPATCH();
+
+    OPCODE_BODIES(OP_BODY)
+
+#undef NEXT
+#define NEXT(n)         NEXT_FALL(n)
+    FUSED_OPS(FUSED_BODY)
+#undef NEXT
+#define NEXT(n)         NEXT_DISPATCH(n)
+
+slice_end:
+    cache->current = NULL;
+    SYNC_OUT();
+    // Only a HLT leaves the slice early
+    return cycles < target ? 0 : 1;
+}
+
+uint64_t block_cache_key(){
+    if(!block_exit_label){
+        block_run_cycles(NULL, 0);
+    }
+    // Handlers are stored by index, the fused pairs in use are part of the key
+    uint64_t key = 0xCBF29CE484222325ull;
+    uint32_t fields[] = {BLOCK_CACHE_VERSION, BLOCK_MAX_OPS, block_fused_count};
+    for(uint32_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++){
+        key = (key ^ fields[i]) * 0x100000001B3ull;
+    }
+    for(uint32_t i = 0; i < block_fused_count; i++){
+        key = (key ^ block_fused_ops[i].pair) * 0x100000001B3ull;
+    }
+    return key;
+}
+
+/**
+ * @brief The code cache record handler of a block's op
+ *
+ * @param mem guest memory
+ * @param pc of the op
+ * @param label the op's handler
+ * @return uint32_t handler, or past BLOCK_EXIT_ID if not one of ours
+ */
+static uint32_t block_handler_id(v_memory* mem, uint16_t pc, const void* label){
+    if(label == block_exit_label){
+        return BLOCK_EXIT_ID;
+    }
+    uint8_t op = mem_read(mem, pc);
+    if(label == block_labels[op]){
+        return op;
+    }
+    for(uint32_t i = 0; i < block_fused_count; i++){
+        if(label == block_fused_ops[i].label){
+            return BLOCK_FUSED_ID + i;
+        }
+    }
+    return BLOCK_EXIT_ID + 1;
+}
+
+size_t block_cache_save(cpu_state* cpu, uint8_t* out, uint32_t code_end, uint32_t* count){
+    block_cache* cache = cpu->engine_state;
+    size_t size = 0;
+    *count = 0;
+    if(!cache || !block_exit_label){
+        return 0;
+    }
+    for(uint32_t i = 0; i < cache->used; i++){
+        block_8080* block = &cache->pool[i];
+        if(cache->lookup[block->start] != block || block->start + block->bytes > code_end){
+            continue;
+        }
+        block_op_record ops[BLOCK_MAX_OPS + 1];
+        uint16_t pc = block->start;
+        uint8_t ours = 1;
+        for(uint8_t j = 0; j <= block->len; j++){
+            const block_op* op = &block->ops[j];
+            uint32_t handler = block_handler_id(&cpu->mem, pc, op->label);
+            ours &= handler <= BLOCK_EXIT_ID;
+            ops[j] = (block_op_record){ .handler = handler, .imm = op->imm,
+                                        .size = op->size, .cycles = op->cycles };
+            pc += op->size;
+        }
+        if(!ours){
+            continue;
+        }
+        block_record rec = { .start = block->start, .len = block->len, .bytes = block->bytes,
+                             .cycles = block->cycles, .lead_cycles = block->lead_cycles };
+        size_t ops_size = (block->len + 1) * sizeof(block_op_record);
+        if(out){
+            memcpy(out + size, &rec, sizeof(rec));
+            memcpy(out + size + sizeof(rec), ops, ops_size);
+        }
+        size += sizeof(rec) + ops_size;
+        (*count)++;
+    }
+    return size;
+}
+
+uint8_t block_cache_load(cpu_state* cpu, const uint8_t* in, size_t size, uint32_t count){
+    if(!block_exit_label){
+        block_run_cycles(NULL, 0);
+    }
+    block_cache* cache = cpu->engine_state;
+    if(!cache){
+        cache = block_cache_init(cpu);
+    }
+    if(count > BLOCK_POOL_SIZE - cache->used){
+        return 0;
+    }
+    size_t pos = 0;
+    for(uint32_t i = 0; i < count; i++){
+        block_record rec;
+        if(size - pos < sizeof(rec)){
+            return 0;
+        }
+        memcpy(&rec, in + pos, sizeof(rec));
+        pos += sizeof(rec);
+        size_t ops_size = (rec.len + 1) * sizeof(block_op_record);
+        if(rec.len > BLOCK_MAX_OPS || size - pos < ops_size){
+            return 0;
+        }
+        block_8080* block = &cache->pool[cache->used++];
+        block->start = rec.start;
+        block->len = rec.len;
+        block->bytes = rec.bytes;
+        block->cycles = rec.cycles;
+        block->lead_cycles = rec.lead_cycles;
+        for(uint8_t j = 0; j <= rec.len; j++){
+            block_op_record op;
+            memcpy(&op, in + pos, sizeof(op));
+            pos += sizeof(op);
+            if(op.handler < BLOCK_FUSED_ID){
+                block->ops[j].label = block_labels[op.handler];
+            } else if(op.handler == BLOCK_EXIT_ID){
+                block->ops[j].label = block_exit_label;
+            } else if((uint32_t)(op.handler - BLOCK_FUSED_ID) < block_fused_count){
+                block->ops[j].label = block_fused_ops[op.handler - BLOCK_FUSED_ID].label;
+            } else {
+                return 0;
+            }
+            block->ops[j].imm = op.imm;
+            block->ops[j].size = op.size;
+            block->ops[j].cycles = op.cycles;
+        }
+        block_mark(cache, block, 1);
+        cache->lookup[block->start] = block;
+    }
+    return pos == size;
+}
+
+#endif /* __GNUC__ */
@@ -0,0 +1,1411 @@
+/**
+ * @file cpu_jit.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Dynamic recompiler for the 8080 on x86-64 Linux. Straight line
+ * blocks of guest code which keep getting run are translated into host
+ * code in an mmap'd executable buffer, cold code runs on exec_inst.
+ * While in translated code A, BC, DE, HL and SP live in host registers,
+ * the PSW stays in cpu_state in its lazy form. Blocks chain straight into
+ * each other, anything not translated calls its opcode_lookup handler.
+ * Interrupts are taken by exec_inst between blocks, only EI can let one
+ * in and EI always returns to the dispatcher.
+ * @note Selected with `make ENGINE=jit`, other hosts fall back to the
+ * interpreter.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include <sys/mman.h>
+
+#define JIT_MAX_OPS         32                      /** Ops translated into one block at most */
+#define JIT_MAX_BYTES       (JIT_MAX_OPS * 3)       /** Guest bytes one block can cover */
+#define JIT_MAX_CYCLES      (JIT_MAX_OPS * 18)      /** Most cycles one block can charge (18 for XTHL) */
+#define JIT_POOL_SIZE       4096                    /** Blocks translated before the cache is flushed */
+#define JIT_CODE_SIZE       (8 << 20)               /** Host code buffer */
+#define JIT_BLOCK_CODE      (16 << 10)              /** Host code one block can take, worst case */
+#define JIT_HOT_RUNS        8                       /** Runs through the dispatcher before translating */
+#define JIT_MAX_STUBS       (JIT_MAX_OPS * 2 + 1)   /** Out of line paths of one block */
+#define JIT_CACHE_VERSION   1                       /** Bump when block boundaries or the code cache records change */
+#define JIT_MAP_CODE        0x01                    /** code_map: the byte is covered by a live block */
+#define JIT_MAP_TRAP        0x02                    /** code_map: the byte's page is MEM_STORE_TRAP */
+
+/**
+ * @brief A translated block, ends at the first instruction that can
+ * leave straight line code, see opcode_ends_block.
+ */
+typedef struct {
+    const uint8_t* code;    /**< Host code entry, first so the indirect exit can jump through it */
+    uint32_t lead_cycles;   /**< Summed cycles of all but the last op */
+    uint16_t start;         /**< Guest address of the first op */
+    uint8_t bytes;          /**< Guest bytes covered from start */
+    uint8_t len;            /**< Number of ops */
+} jit_block;
+
+typedef struct jit_cache jit_cache;
+
+/** Calls into translated code, returns the exit status */
+typedef int (*jit_entry)(cpu_state* cpu, jit_cache* cache, const uint8_t* code);
+
+/**
+ * @brief Per cpu translation cache, hung off cpu->engine_state
+ */
+struct jit_cache {
+    jit_block* lookup[0x10000];         /**< Live block starting at each address */
+    uint8_t code_map[0x10000 + 8];      /**< JIT_MAP_ bits of each byte, stores which see
+                                             any go out of line. Padded for the 16 bit
+                                             store checks. */
+    uint8_t code_pages[0x100];          /**< Pages holding any code, the memory watch */
+    uint8_t trap_pages[0x100];          /**< Pages code_map has JIT_MAP_TRAP on */
+    uint8_t heat[0x10000];              /**< Dispatcher visits of each address, up to JIT_HOT_RUNS */
+    jit_block* current;                 /**< Block whose store is being checked, NULL once
+                                             the store invalidated it */
+    uint8_t* last_link;                 /**< Chainable exit the last run left through */
+    uint64_t target;                    /**< Cycle count the slice runs up to */
+    jit_entry enter;                    /**< Loads the guest registers and jumps to a block */
+    const uint8_t* exit;                /**< Leaves translated code, eax: pc */
+    const uint8_t* exit_status;         /**< Same, edx: status to return */
+    const uint8_t* exit_link;           /**< Same, rcx: the exit to chain */
+    const uint8_t* exit_indirect;       /**< Jumps to the block at eax, or exits */
+    uint8_t* code;                      /**< Host code buffer, JIT_CODE_SIZE bytes */
+    uint8_t* code_blocks;               /**< Start of the block code, after the trampolines */
+    uint8_t* code_free;                 /**< Next free byte in the buffer */
+    uint32_t used;                      /**< Blocks handed out of the pool */
+    jit_block pool[JIT_POOL_SIZE];
+};
+
+/**
+ * @brief x86-64 registers, by encoding
+ */
+typedef enum {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15,
+    NO_REG = -1,
+} x64_reg;
+
+///@{
+/** Host registers while in translated code. The guest registers are
+ * caller saved and get written back around calls into C, the rest are
+ * callee saved. Pairs hold their 16 bit value, A its 8 bit one, both
+ * zero extended. rax, rcx, rdx and rdi are scratch. */
+#define REG_A       RSI
+#define REG_BC      R8
+#define REG_DE      R9
+#define REG_HL      R10
+#define REG_SP      R11
+#define REG_CACHE   RBP
+#define REG_INSTS   RBX
+#define REG_TARGET  R12
+#define REG_CYCLES  R13
+#define REG_MEM     R14
+#define REG_CPU     R15
+///@}
+
+///@{
+/** Field offsets for the generated code */
+#define CPU_OFF(f)      ((int32_t)offsetof(cpu_state, f))
+#define PSW_OFF(f)      (CPU_OFF(PSW) + (int32_t)offsetof(program_status_word, f))
+#define CACHE_OFF(f)    ((int32_t)offsetof(jit_cache, f))
+///@}
+
+///@{
+/** x_op flags */
+#define X_W         0x01    /** REX.W, 64 bit operands */
+#define X_16        0x02    /** 0x66 prefix, 16 bit operands */
+#define X_BYTE      0x04    /** byte registers, spl/bpl/sil/dil need a REX */
+#define X_MEM       0x08    /** rm is [base + index + disp32] */
+#define X_SCALE8    0x10    /** index scaled by 8 */
+///@}
+
+///@{
+/** x86 condition codes */
+#define CC_B        0x2
+#define CC_AE       0x3
+#define CC_E        0x4
+#define CC_NE       0x5
+///@}
+
+/**
+ * @brief Where an early exit finds the guest pc to leave with
+ */
+typedef enum {
+    PC_STATIC,      /**< Known at translation time */
+    PC_OPERAND,     /**< The 16 bit operand at a guest address, a CALL's target */
+    PC_CPU,         /**< cpu->PC, as left by an opcode_lookup handler */
+} jit_pc_from;
+
+/**
+ * @brief Out of line path of a block, emitted after its main line
+ */
+typedef struct {
+    uint8_t* jump;          /**< rel32 of the branch into the stub */
+    uint8_t* resume;        /**< Where a store check resumes, NULL for exits */
+    uint8_t op_index;       /**< Op the stub belongs to */
+    uint8_t width;          /**< Bytes stored */
+    int8_t addr_reg;        /**< Register holding the stored address, or NO_REG */
+    int8_t src;             /**< Register holding the stored value */
+    uint8_t pc_from;        /**< jit_pc_from of the exit */
+    uint16_t addr;          /**< Stored address when addr_reg is NO_REG */
+    uint16_t next_pc;       /**< PC_STATIC pc, PC_OPERAND guest address */
+    uint8_t status;         /**< 1 for an SMC exit, 0 to return the handler's status */
+} jit_stub;
+
+/**
+ * @brief A decoded guest instruction
+ */
+typedef struct {
+    uint16_t pc;        /**< Guest address */
+    uint16_t imm;       /**< byte 2 or bytes 3:2 of the instruction */
+    uint8_t code;       /**< Opcode */
+    uint8_t size;       /**< Instruction size in bytes */
+    uint8_t cycles;     /**< Clock cycles charged (not taken count) */
+} jit_op;
+
+/**
+ * @brief Translation state of one block
+ */
+typedef struct {
+    uint8_t* p;                         /**< Emit cursor */
+    jit_cache* cache;
+    jit_block* block;
+    jit_op ops[JIT_MAX_OPS];
+    uint32_t rem_cycles[JIT_MAX_OPS];   /**< Cycles charged for the ops after each op */
+    jit_stub stubs[JIT_MAX_STUBS];
+    uint32_t n_stubs;
+} jit_asm;
+
+static void jit_store(cpu_state* cpu, uint32_t addr, uint32_t width, uint32_t value);
+
+///@{
+/** Raw emitters */
+static inline void emit8(jit_asm* as, uint8_t v){
+    *as->p++ = v;
+}
+static inline void emit16(jit_asm* as, uint16_t v){
+    memcpy(as->p, &v, sizeof(v));
+    as->p += sizeof(v);
+}
+static inline void emit32(jit_asm* as, uint32_t v){
+    memcpy(as->p, &v, sizeof(v));
+    as->p += sizeof(v);
+}
+static inline void emit64(jit_asm* as, uint64_t v){
+    memcpy(as->p, &v, sizeof(v));
+    as->p += sizeof(v);
+}
+///@}
+
+/**
+ * @brief Emits an instruction with a ModRM operand
+ *
+ * @param as
+ * @param flags X_* flags
+ * @param op opcode, two byte opcodes as 0x0Fxx
+ * @param reg ModRM reg field, a register or the opcode extension
+ * @param rm register, or the base register with X_MEM
+ * @param index index register with X_MEM, or NO_REG
+ * @param disp displacement with X_MEM
+ */
+static void x_op(jit_asm* as, uint8_t flags, uint16_t op, int reg, int rm, int index, int32_t disp){
+    uint8_t idx = index == NO_REG ? RSP : index;
+    uint8_t rex = 0x40 | ((flags & X_W) ? 0x8 : 0) | ((reg & 0x8) >> 1) | ((rm & 0x8) >> 3);
+    if(flags & X_MEM){
+        rex |= (idx & 0x8) >> 2;
+    }
+    uint8_t byte_reg = (flags & X_BYTE) &&
+                       ((reg >= RSP && reg <= RDI) || (!(flags & X_MEM) && rm >= RSP && rm <= RDI));
+    if(flags & X_16){
+        emit8(as, 0x66);
+    }
+    if(rex != 0x40 || byte_reg){
+        emit8(as, rex);
+    }
+    if(op > 0xFF){
+        emit8(as, op >> 8);
+    }
+    emit8(as, op & 0xFF);
+    if(flags & X_MEM){
+        // Always [base + index + disp32] through a SIB, works for every base
+        emit8(as, 0x80 | (reg & 0x7) << 3 | 0x4);
+        emit8(as, ((flags & X_SCALE8) ? 0xC0 : 0) | (idx & 0x7) << 3 | (rm & 0x7));
+        emit32(as, disp);
+    } else {
+        emit8(as, 0xC0 | (reg & 0x7) << 3 | (rm & 0x7));
+    }
+}
+
+///@{
+/** Common instruction forms */
+static void x_mov_imm(jit_asm* as, int reg, uint32_t imm){
+    if(reg & 0x8){
+        emit8(as, 0x41);
+    }
+    emit8(as, 0xB8 | (reg & 0x7));
+    emit32(as, imm);
+}
+static void x_mov_imm64(jit_asm* as, int reg, uint64_t imm){
+    emit8(as, 0x48 | ((reg & 0x8) >> 3));
+    emit8(as, 0xB8 | (reg & 0x7));
+    emit64(as, imm);
+}
+/** op r32, r32 for the 0x01 style ALU opcodes (ADD 01, OR 09, AND 21, SUB 29, XOR 31) */
+static void x_alu(jit_asm* as, uint8_t op, int dst, int src){
+    x_op(as, 0, op, src, dst, NO_REG, 0);
+}
+/** op r32, imm32 (ADD /0, OR /1, AND /4, SUB /5, XOR /6) */
+static void x_alu_imm(jit_asm* as, uint8_t ext, int dst, uint32_t imm){
+    x_op(as, 0, 0x81, ext, dst, NO_REG, 0);
+    emit32(as, imm);
+}
+/** op r16, imm8 for the guest pairs */
+static void x_alu16_imm8(jit_asm* as, uint8_t ext, int dst, uint8_t imm){
+    x_op(as, X_16, 0x83, ext, dst, NO_REG, 0);
+    emit8(as, imm);
+}
+/** op r64, imm32 */
+static void x_alu64_imm(jit_asm* as, uint8_t ext, int dst, uint32_t imm){
+    x_op(as, X_W, 0x81, ext, dst, NO_REG, 0);
+    emit32(as, imm);
+}
+/** SHL /4, SHR /5 */
+static void x_shift(jit_asm* as, uint8_t ext, int dst, uint8_t count){
+    x_op(as, 0, 0xC1, ext, dst, NO_REG, 0);
+    emit8(as, count);
+}
+static void x_mov(jit_asm* as, int dst, int src){
+    x_op(as, 0, 0x89, src, dst, NO_REG, 0);
+}
+static void x_mov64(jit_asm* as, int dst, int src){
+    x_op(as, X_W, 0x89, src, dst, NO_REG, 0);
+}
+static void x_movzx8(jit_asm* as, int dst, int src){
+    x_op(as, X_BYTE, 0x0FB6, dst, src, NO_REG, 0);
+}
+static void x_call(jit_asm* as, const void* func){
+    x_mov_imm64(as, RAX, (uintptr_t)func);
+    x_op(as, 0, 0xFF, 2, RAX, NO_REG, 0);
+}
+static void x_push(jit_asm* as, int reg){
+    if(reg & 0x8){
+        emit8(as, 0x41);
+    }
+    emit8(as, 0x50 | (reg & 0x7));
+}
+static void x_pop(jit_asm* as, int reg){
+    if(reg & 0x8){
+        emit8(as, 0x41);
+    }
+    emit8(as, 0x58 | (reg & 0x7));
+}
+///@}
+
+///@{
+/** Jumps, the _fwd forms return the rel32 to patch once the target is known */
+static void x_patch(uint8_t* rel, const uint8_t* target){
+    int32_t disp = (int32_t)(target - (rel + 4));
+    memcpy(rel, &disp, sizeof(disp));
+}
+static void x_jmp(jit_asm* as, const uint8_t* target){
+    emit8(as, 0xE9);
+    emit32(as, 0);
+    x_patch(as->p - 4, target);
+}
+static uint8_t* x_jcc_fwd(jit_asm* as, uint8_t cc){
+    emit8(as, 0x0F);
+    emit8(as, 0x80 | cc);
+    emit32(as, 0);
+    return as->p - 4;
+}
+///@}
+
+///@{
+/** Guest state helpers */
+static const int pair_reg[4] = {REG_BC, REG_DE, REG_HL, REG_SP};
+
+/** Guest registers back into cpu_state */
+static void g_spill(jit_asm* as){
+    x_op(as, X_16 | X_MEM, 0x89, REG_BC, REG_CPU, NO_REG, CPU_OFF(BC));
+    x_op(as, X_16 | X_MEM, 0x89, REG_DE, REG_CPU, NO_REG, CPU_OFF(DE));
+    x_op(as, X_16 | X_MEM, 0x89, REG_HL, REG_CPU, NO_REG, CPU_OFF(HL));
+    x_op(as, X_16 | X_MEM, 0x89, REG_SP, REG_CPU, NO_REG, CPU_OFF(SP));
+    x_op(as, X_BYTE | X_MEM, 0x88, REG_A, REG_CPU, NO_REG, CPU_OFF(ACC));
+}
+
+/** Guest registers out of cpu_state */
+static void g_reload(jit_asm* as){
+    x_op(as, X_MEM, 0x0FB7, REG_BC, REG_CPU, NO_REG, CPU_OFF(BC));
+    x_op(as, X_MEM, 0x0FB7, REG_DE, REG_CPU, NO_REG, CPU_OFF(DE));
+    x_op(as, X_MEM, 0x0FB7, REG_HL, REG_CPU, NO_REG, CPU_OFF(HL));
+    x_op(as, X_MEM, 0x0FB7, REG_SP, REG_CPU, NO_REG, CPU_OFF(SP));
+    x_op(as, X_MEM, 0x0FB6, REG_A, REG_CPU, NO_REG, CPU_OFF(ACC));
+}
+
+/** dst = guest register r (DDD/SSS encoding), zero extended */
+static void g_get8(jit_asm* as, int dst, uint8_t r){
+    if(r == 7){
+        x_mov(as, dst, REG_A);
+    } else if(r == 6){
+        x_op(as, X_MEM, 0x0FB6, dst, REG_MEM, REG_HL, 0);
+    } else if(r & 1){
+        x_movzx8(as, dst, pair_reg[r >> 1]);
+    } else {
+        x_mov(as, dst, pair_reg[r >> 1]);
+        x_shift(as, 5, dst, 8);
+    }
+}
+
+/** guest register r (not M) = src, a zero extended byte, clobbers rdx */
+static void g_set8(jit_asm* as, uint8_t r, int src){
+    if(r == 7){
+        x_mov(as, REG_A, src);
+    } else if(r & 1){
+        x_op(as, X_BYTE, 0x88, src, pair_reg[r >> 1], NO_REG, 0);
+    } else {
+        int pair = pair_reg[r >> 1];
+        x_mov(as, RDX, src);
+        x_shift(as, 4, RDX, 8);
+        x_alu_imm(as, 4, pair, 0xFF);
+        x_alu(as, 0x09, pair, RDX);
+    }
+}
+
+/** PSW field = low 16 bits of src */
+static void g_psw16(jit_asm* as, int32_t off, int src){
+    x_op(as, X_16 | X_MEM, 0x89, src, REG_CPU, NO_REG, off);
+}
+
+/** PSW field = low 8 bits of src */
+static void g_psw8(jit_asm* as, int32_t off, int src){
+    x_op(as, X_BYTE | X_MEM, 0x88, src, REG_CPU, NO_REG, off);
+}
+
+static void g_mem_imm8(jit_asm* as, int base, int32_t off, uint8_t imm){
+    x_op(as, X_MEM, 0xC6, 0, base, NO_REG, off);
+    emit8(as, imm);
+}
+
+static void g_mem_imm16(jit_asm* as, int base, int32_t off, uint16_t imm){
+    x_op(as, X_16 | X_MEM, 0xC7, 0, base, NO_REG, off);
+    emit16(as, imm);
+}
+
+/** dst = carry flag, 0 or 1 */
+static void g_carry(jit_asm* as, int dst){
+    x_op(as, X_MEM, 0x0FB6, dst, REG_CPU, NO_REG, PSW_OFF(cy_res) + 1);
+    x_alu_imm(as, 4, dst, 1);
+}
+///@}
+
+/**
+ * @brief Queues an out of line path for the block
+ *
+ * @param as
+ * @param jump rel32 of the branch into it
+ * @param op_index op it belongs to
+ * @return jit_stub* to fill in
+ */
+static jit_stub* g_stub(jit_asm* as, uint8_t* jump, uint8_t op_index){
+    jit_stub* stub = &as->stubs[as->n_stubs++];
+    memset(stub, 0, sizeof(*stub));
+    stub->jump = jump;
+    stub->op_index = op_index;
+    stub->addr_reg = NO_REG;
+    stub->status = 1;
+    return stub;
+}
+
+/**
+ * @brief Stores to guest memory. Stores about to hit translated code or
+ * a ROM page are done out of line, through jit_store.
+ *
+ * @param as
+ * @param index op doing the store
+ * @param addr_reg guest pair holding the address, or NO_REG
+ * @param addr the address when addr_reg is NO_REG
+ * @param src register stored
+ * @param width 1 or 2 bytes
+ * @param pc_from where the pc is after the op, for an early exit
+ * @param next_pc see jit_stub
+ */
+static void g_store(jit_asm* as, uint8_t index, int addr_reg, uint16_t addr, int src,
+                    uint8_t width, uint8_t pc_from, uint16_t next_pc){
+    int32_t disp = addr_reg == NO_REG ? addr : 0;
+    x_op(as, width == 1 ? X_MEM : X_16 | X_MEM, width == 1 ? 0x80 : 0x83, 7, REG_CACHE, addr_reg,
+         CACHE_OFF(code_map) + disp);
+    emit8(as, 0);
+    jit_stub* stub = g_stub(as, x_jcc_fwd(as, CC_NE), index);
+    if(width == 1){
+        x_op(as, X_BYTE | X_MEM, 0x88, src, REG_MEM, addr_reg, disp);
+    } else {
+        x_op(as, X_16 | X_MEM, 0x89, src, REG_MEM, addr_reg, disp);
+    }
+    stub->resume = as->p;
+    stub->src = src;
+    stub->width = width;
+    stub->addr_reg = addr_reg;
+    stub->addr = addr;
+    stub->pc_from = pc_from;
+    stub->next_pc = next_pc;
+}
+
+/**
+ * @brief Emits the x86 test for a guest condition
+ *
+ * @param as
+ * @param cond condition_flags
+ * @return uint8_t x86 condition code which holds when cond does
+ */
+static uint8_t g_cond(jit_asm* as, uint8_t cond){
+    static const uint8_t cond_flag[4] = {ZERO_FLAG, CARRY_FLAG, PARITY_FLAG, SIGN_FLAG};
+    uint8_t flag = cond_flag[cond >> 1];
+    if(flag == CARRY_FLAG){
+        x_op(as, X_MEM, 0xF6, 0, REG_CPU, NO_REG, PSW_OFF(cy_res) + 1);
+        emit8(as, 1);
+    } else {
+        x_op(as, X_MEM, 0x0FB7, RAX, REG_CPU, NO_REG, PSW_OFF(szp_res));
+        x_alu_imm(as, 4, RAX, 0x1FF);
+        x_mov_imm64(as, RDX, (uintptr_t)szp_flag_lookup);
+        x_op(as, X_MEM, 0xF6, 0, RDX, RAX, 0);
+        emit8(as, flag);
+    }
+    // Odd conditions hold when the flag is set
+    return (cond & 1) ? CC_NE : CC_E;
+}
+
+/**
+ * @brief Leaves the block for a known guest pc, through an exit that
+ * gets patched into a jump to the next block once it's translated.
+ *
+ * @param as
+ * @param pc
+ */
+static void g_link(jit_asm* as, uint16_t pc){
+    uint8_t* start = as->p;
+    x_mov_imm(as, RAX, pc);                     // 5 bytes, patched to a jmp rel32
+    emit8(as, 0x48);                            // lea rcx, [rip - 12]: the exit itself
+    emit8(as, 0x8D);
+    emit8(as, 0x0D);
+    emit32(as, (uint32_t)(start - (as->p + 4)));
+    x_jmp(as, as->cache->exit_link);
+}
+
+/**
+ * @brief ADD..CMP of A with the byte in rcx, same flags as the
+ * interpreter's handlers.
+ *
+ * @param as
+ * @param kind ALU field of the opcode, 0 ADD .. 7 CMP
+ * @param sbi SBI, whose aux carry takes the carry in unlike SBB
+ */
+static void g_alu(jit_asm* as, uint8_t kind, uint8_t sbi){
+    switch (kind)
+    {
+    case 0: // ADD
+    case 1: // ADC, aux carry uses the operand plus the carry out
+        x_mov(as, RAX, REG_A);
+        x_alu(as, 0x01, RAX, RCX);
+        if(kind == 1){
+            g_carry(as, RDX);
+            x_alu(as, 0x01, RAX, RDX);
+            x_mov(as, RDX, RAX);
+            x_shift(as, 5, RDX, 8);
+            x_alu_imm(as, 4, RDX, 1);
+            x_alu(as, 0x01, RCX, RDX);
+        }
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        g_psw8(as, PSW_OFF(aux_a), REG_A);
+        g_psw8(as, PSW_OFF(aux_b), RCX);
+        x_movzx8(as, RAX, RAX);
+        g_psw16(as, PSW_OFF(szp_res), RAX);
+        x_mov(as, REG_A, RAX);
+        break;
+    case 2: // SUB
+    case 7: // CMP
+        x_mov(as, RAX, REG_A);
+        x_alu(as, 0x29, RAX, RCX);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        x_op(as, 0, 0xF7, 3, RCX, NO_REG, 0);  // neg ecx
+        g_psw8(as, PSW_OFF(aux_a), REG_A);
+        g_psw8(as, PSW_OFF(aux_b), RCX);
+        x_movzx8(as, RAX, RAX);
+        g_psw16(as, PSW_OFF(szp_res), RAX);
+        if(kind == 2){
+            x_mov(as, REG_A, RAX);
+        }
+        break;
+    case 3: // SBB, aux carry uses -src - 1 whatever the carry, SBI -src - carry out
+        g_carry(as, RDX);
+        x_mov(as, RAX, REG_A);
+        x_alu(as, 0x29, RAX, RCX);
+        x_alu(as, 0x29, RAX, RDX);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        if(sbi){
+            x_mov(as, RDX, RAX);
+            x_shift(as, 5, RDX, 8);
+            x_alu_imm(as, 4, RDX, 1);
+            x_op(as, 0, 0xF7, 3, RCX, NO_REG, 0);  // neg ecx
+            x_alu(as, 0x29, RCX, RDX);
+        } else {
+            x_op(as, 0, 0xF7, 2, RCX, NO_REG, 0);  // not ecx
+        }
+        g_psw8(as, PSW_OFF(aux_a), REG_A);
+        g_psw8(as, PSW_OFF(aux_b), RCX);
+        x_movzx8(as, RAX, RAX);
+        g_psw16(as, PSW_OFF(szp_res), RAX);
+        x_mov(as, REG_A, RAX);
+        break;
+    case 4: // ANA, aux carry is the OR of bit 3 of the operands
+        x_mov(as, RDX, REG_A);
+        x_alu(as, 0x09, RDX, RCX);
+        x_alu_imm(as, 4, RDX, 0x08);
+        g_psw8(as, PSW_OFF(aux_a), RDX);
+        g_psw8(as, PSW_OFF(aux_b), RDX);
+        x_alu(as, 0x21, REG_A, RCX);
+        g_psw16(as, PSW_OFF(szp_res), REG_A);
+        g_psw16(as, PSW_OFF(cy_res), REG_A);
+        break;
+    default: // XRA, ORA
+        x_alu(as, kind == 5 ? 0x31 : 0x09, REG_A, RCX);
+        g_psw16(as, PSW_OFF(szp_res), REG_A);
+        g_psw16(as, PSW_OFF(cy_res), REG_A);
+        g_mem_imm16(as, REG_CPU, PSW_OFF(aux_a), 0);
+        break;
+    }
+}
+
+/**
+ * @brief Runs an op through its opcode_lookup handler, with the guest
+ * state written back around the call.
+ *
+ * @param as
+ * @param index op to run
+ */
+static void g_fallback(jit_asm* as, uint8_t index){
+    const jit_op* op = &as->ops[index];
+    g_spill(as);
+    x_op(as, X_W | X_MEM, 0x89, REG_CYCLES, REG_CPU, NO_REG, CPU_OFF(cycles));
+    g_mem_imm16(as, REG_CPU, CPU_OFF(PC), op->pc + op->size);
+    x_mov_imm64(as, RAX, (uintptr_t)as->block);
+    x_op(as, X_W | X_MEM, 0x89, RAX, REG_CACHE, NO_REG, CACHE_OFF(current));
+    x_mov64(as, RDI, REG_CPU);
+    x_mov_imm(as, RSI, op->pc);
+    x_mov_imm(as, RDX, op->code);
+    x_call(as, opcode_func(op->code));
+    x_op(as, X_W | X_MEM, 0x8B, REG_CYCLES, REG_CPU, NO_REG, CPU_OFF(cycles));
+    g_reload(as);
+    // Handler failed
+    x_op(as, 0, 0x81, 7, RAX, NO_REG, 0);
+    emit32(as, 1);
+    jit_stub* stub = g_stub(as, x_jcc_fwd(as, CC_NE), index);
+    stub->pc_from = PC_CPU;
+    stub->status = 0;
+    // Handler wrote over the block
+    x_op(as, X_W | X_MEM, 0x83, 7, REG_CACHE, NO_REG, CACHE_OFF(current));
+    emit8(as, 0);
+    stub = g_stub(as, x_jcc_fwd(as, CC_E), index);
+    stub->pc_from = PC_CPU;
+    if(opcode_ends_block(op->code)){
+        x_op(as, X_MEM, 0x0FB7, RAX, REG_CPU, NO_REG, CPU_OFF(PC));
+        x_jmp(as, as->cache->exit);
+    }
+}
+
+/**
+ * @brief Translates one op
+ *
+ * @param as
+ * @param index op to translate
+ */
+static void g_op(jit_asm* as, uint8_t index){
+    const jit_op* op = &as->ops[index];
+    uint8_t code = op->code;
+    uint8_t ddd = (code >> 3) & 0x7;
+    uint8_t sss = code & 0x7;
+    int pair = pair_reg[(code >> 4) & 0x3];
+    uint16_t next_pc = op->pc + op->size;
+    uint8_t* jump;
+
+    // MOV, M to M is HLT
+    if(code >= 0x40 && code < 0x80 && code != 0x76){
+        g_get8(as, RCX, sss);
+        if(ddd == 6){
+            g_store(as, index, REG_HL, 0, RCX, 1, PC_STATIC, next_pc);
+        } else {
+            g_set8(as, ddd, RCX);
+        }
+        return;
+    }
+    // ADD..CMP with a register
+    if(code >= 0x80 && code < 0xC0){
+        g_get8(as, RCX, sss);
+        g_alu(as, ddd, 0);
+        return;
+    }
+    switch (code & 0xC7)
+    {
+    case 0x04: // INR
+    case 0x05: // DCR
+        g_get8(as, RAX, ddd);
+        g_psw8(as, PSW_OFF(aux_a), RAX);
+        g_mem_imm8(as, REG_CPU, PSW_OFF(aux_b), sss == 4 ? 1 : 0xFF);
+        x_alu_imm(as, 0, RAX, sss == 4 ? 1 : 0xFFFFFFFF);
+        x_movzx8(as, RAX, RAX);
+        g_psw16(as, PSW_OFF(szp_res), RAX);
+        if(ddd == 6){
+            g_store(as, index, REG_HL, 0, RAX, 1, PC_STATIC, next_pc);
+        } else {
+            g_set8(as, ddd, RAX);
+        }
+        return;
+    case 0x06: // MVI
+        x_mov_imm(as, RCX, op->imm);
+        if(ddd == 6){
+            g_store(as, index, REG_HL, 0, RCX, 1, PC_STATIC, next_pc);
+        } else {
+            g_set8(as, ddd, RCX);
+        }
+        return;
+    case 0xC6: // ADI..CPI
+        x_mov_imm(as, RCX, op->imm);
+        g_alu(as, ddd, code == 0xDE);
+        return;
+    case 0xC2: // Jcc
+        jump = x_jcc_fwd(as, g_cond(as, ddd));
+        g_link(as, next_pc);
+        x_patch(jump, as->p);
+        g_link(as, op->imm);
+        return;
+    case 0xC4: // Ccc, the target is read after the push like CALL_WRAP
+        jump = x_jcc_fwd(as, g_cond(as, ddd));
+        g_link(as, next_pc);
+        x_patch(jump, as->p);
+        x_alu64_imm(as, 0, REG_CYCLES, CCON_TAKEN_CYCLES);
+        x_alu16_imm8(as, 5, REG_SP, 2);
+        x_mov_imm(as, RCX, next_pc);
+        g_store(as, index, REG_SP, 0, RCX, 2, PC_OPERAND, op->pc + 1);
+        g_link(as, op->imm);
+        return;
+    case 0xC0: // Rcc
+        jump = x_jcc_fwd(as, g_cond(as, ddd));
+        g_link(as, next_pc);
+        x_patch(jump, as->p);
+        x_alu64_imm(as, 0, REG_CYCLES, RCON_TAKEN_CYCLES);
+        x_op(as, X_MEM, 0x0FB7, RAX, REG_MEM, REG_SP, 0);
+        x_alu16_imm8(as, 0, REG_SP, 2);
+        x_jmp(as, as->cache->exit_indirect);
+        return;
+    case 0xC7: // RST
+        g_mem_imm8(as, REG_CPU, CPU_OFF(intt), 0);
+        x_alu16_imm8(as, 5, REG_SP, 2);
+        x_mov_imm(as, RCX, next_pc);
+        g_store(as, index, REG_SP, 0, RCX, 2, PC_STATIC, ddd * 8);
+        g_link(as, ddd * 8);
+        return;
+    default:
+        break;
+    }
+    switch (code & 0xCF)
+    {
+    case 0x01: // LXI
+        x_mov_imm(as, pair, op->imm);
+        return;
+    case 0x03: // INX
+        x_alu16_imm8(as, 0, pair, 1);
+        return;
+    case 0x0B: // DCX
+        x_alu16_imm8(as, 5, pair, 1);
+        return;
+    case 0x09: // DAD, carry out of bit 15
+        x_mov(as, RAX, REG_HL);
+        x_alu(as, 0x01, RAX, pair);
+        x_mov(as, REG_HL, RAX);
+        x_alu_imm(as, 4, REG_HL, 0xFFFF);
+        x_shift(as, 5, RAX, 8);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        return;
+    case 0xC5: // PUSH, PSW goes through PUSH_PSW_WRAP
+        if(pair != REG_SP){
+            x_alu16_imm8(as, 5, REG_SP, 2);
+            g_store(as, index, REG_SP, 0, pair, 2, PC_STATIC, next_pc);
+            return;
+        }
+        break;
+    case 0xC1: // POP, PSW goes through POP_PSW_WRAP
+        if(pair != REG_SP){
+            x_op(as, X_MEM, 0x0FB7, pair, REG_MEM, REG_SP, 0);
+            x_alu16_imm8(as, 0, REG_SP, 2);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    switch (code)
+    {
+    case 0x00: case 0x08: case 0x10: case 0x18:     // NOP
+    case 0x20: case 0x28: case 0x30: case 0x38:
+        return;
+    case 0x02: case 0x12:   // STAX
+        g_store(as, index, pair, 0, REG_A, 1, PC_STATIC, next_pc);
+        return;
+    case 0x0A: case 0x1A:   // LDAX
+        x_op(as, X_MEM, 0x0FB6, REG_A, REG_MEM, pair, 0);
+        return;
+    case 0x22:  // SHLD
+        g_store(as, index, NO_REG, op->imm, REG_HL, 2, PC_STATIC, next_pc);
+        return;
+    case 0x2A:  // LHLD
+        x_op(as, X_MEM, 0x0FB7, REG_HL, REG_MEM, NO_REG, op->imm);
+        return;
+    case 0x32:  // STA
+        g_store(as, index, NO_REG, op->imm, REG_A, 1, PC_STATIC, next_pc);
+        return;
+    case 0x3A:  // LDA
+        x_op(as, X_MEM, 0x0FB6, REG_A, REG_MEM, NO_REG, op->imm);
+        return;
+    case 0x07:  // RLC
+        x_mov(as, RAX, REG_A);
+        x_shift(as, 5, RAX, 7);
+        x_alu(as, 0x01, REG_A, REG_A);
+        x_alu(as, 0x09, REG_A, RAX);
+        x_alu_imm(as, 4, REG_A, 0xFF);
+        x_shift(as, 4, RAX, 8);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        return;
+    case 0x0F:  // RRC
+        x_mov(as, RAX, REG_A);
+        x_alu_imm(as, 4, RAX, 1);
+        x_shift(as, 5, REG_A, 1);
+        x_mov(as, RCX, RAX);
+        x_shift(as, 4, RCX, 7);
+        x_alu(as, 0x09, REG_A, RCX);
+        x_shift(as, 4, RAX, 8);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        return;
+    case 0x17:  // RAL
+        g_carry(as, RDX);
+        x_mov(as, RAX, REG_A);
+        x_shift(as, 5, RAX, 7);
+        x_alu(as, 0x01, REG_A, REG_A);
+        x_alu(as, 0x09, REG_A, RDX);
+        x_alu_imm(as, 4, REG_A, 0xFF);
+        x_shift(as, 4, RAX, 8);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        return;
+    case 0x1F:  // RAR
+        g_carry(as, RDX);
+        x_mov(as, RAX, REG_A);
+        x_alu_imm(as, 4, RAX, 1);
+        x_shift(as, 5, REG_A, 1);
+        x_shift(as, 4, RDX, 7);
+        x_alu(as, 0x09, REG_A, RDX);
+        x_shift(as, 4, RAX, 8);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        return;
+    case 0x2F:  // CMA
+        x_alu_imm(as, 6, REG_A, 0xFF);
+        return;
+    case 0x37:  // STC
+        g_mem_imm16(as, REG_CPU, PSW_OFF(cy_res), 0x100);
+        return;
+    case 0x3F:  // CMC
+        x_op(as, X_MEM, 0x0FB7, RAX, REG_CPU, NO_REG, PSW_OFF(cy_res));
+        x_op(as, 0, 0xF7, 2, RAX, NO_REG, 0);  // not eax
+        x_alu_imm(as, 4, RAX, 0x100);
+        g_psw16(as, PSW_OFF(cy_res), RAX);
+        return;
+    case 0xEB:  // XCHG
+        x_mov(as, RAX, REG_DE);
+        x_mov(as, REG_DE, REG_HL);
+        x_mov(as, REG_HL, RAX);
+        return;
+    case 0xF3:  // DI
+        g_mem_imm8(as, REG_CPU, CPU_OFF(intt), 0);
+        return;
+    case 0xFB:  // EI, back to the dispatcher so a pending intt gets taken
+        g_mem_imm8(as, REG_CPU, CPU_OFF(intt), 1);
+        x_mov_imm(as, RAX, next_pc);
+        x_jmp(as, as->cache->exit);
+        return;
+    case 0xC3:  // JMP
+        g_link(as, op->imm);
+        return;
+    case 0xCD:  // CALL, the target is read after the push like CALL_WRAP
+        x_alu16_imm8(as, 5, REG_SP, 2);
+        x_mov_imm(as, RCX, next_pc);
+        g_store(as, index, REG_SP, 0, RCX, 2, PC_OPERAND, op->pc + 1);
+        g_link(as, op->imm);
+        return;
+    case 0xC9:  // RET
+        x_op(as, X_MEM, 0x0FB7, RAX, REG_MEM, REG_SP, 0);
+        x_alu16_imm8(as, 0, REG_SP, 2);
+        x_jmp(as, as->cache->exit_indirect);
+        return;
+    case 0xE9:  // PCHL
+        x_mov(as, RAX, REG_HL);
+        x_jmp(as, as->cache->exit_indirect);
+        return;
+    default:
+        break;
+    }
+    // IN, OUT, HLT, DAA, XTHL, SPHL, PUSH/POP PSW and the undocumented ops
+    g_fallback(as, index);
+}
+
+/**
+ * @brief Emits a queued stub
+ *
+ * @param as
+ * @param stub
+ */
+static void g_emit_stub(jit_asm* as, const jit_stub* stub){
+    x_patch(stub->jump, as->p);
+    if(stub->resume){
+        // A store about to land on translated code or ROM, store through
+        // mem_write, whose watch invalidates whatever it hit
+        if(stub->src != RCX){
+            x_mov(as, RCX, stub->src);
+        }
+        g_spill(as);
+        x_mov_imm64(as, RAX, (uintptr_t)as->block);
+        x_op(as, X_W | X_MEM, 0x89, RAX, REG_CACHE, NO_REG, CACHE_OFF(current));
+        if(stub->addr_reg == NO_REG){
+            x_mov_imm(as, RSI, stub->addr);
+        } else {
+            x_mov(as, RSI, stub->addr_reg);
+        }
+        x_mov_imm(as, RDX, stub->width);
+        x_mov64(as, RDI, REG_CPU);
+        x_call(as, (const void*)&jit_store);
+        g_reload(as);
+        x_op(as, X_W | X_MEM, 0x83, 7, REG_CACHE, NO_REG, CACHE_OFF(current));
+        emit8(as, 0);
+        uint8_t* still_valid = x_jcc_fwd(as, CC_NE);
+        x_patch(still_valid, stub->resume);
+    } else if(!stub->status){
+        x_mov(as, RDX, RAX);
+    }
+    // Leave, giving back what the ops after this one were charged
+    uint8_t index = stub->op_index;
+    uint32_t later_ops = as->block->len - 1 - index;
+    if(as->rem_cycles[index]){
+        x_alu64_imm(as, 5, REG_CYCLES, as->rem_cycles[index]);
+    }
+    if(later_ops){
+        x_alu64_imm(as, 5, REG_INSTS, later_ops);
+    }
+    switch (stub->pc_from)
+    {
+    case PC_OPERAND:
+        x_op(as, X_MEM, 0x0FB7, RAX, REG_MEM, NO_REG, stub->next_pc);
+        break;
+    case PC_CPU:
+        x_op(as, X_MEM, 0x0FB7, RAX, REG_CPU, NO_REG, CPU_OFF(PC));
+        break;
+    default:
+        x_mov_imm(as, RAX, stub->next_pc);
+        break;
+    }
+    x_jmp(as, stub->status ? as->cache->exit : as->cache->exit_status);
+}
+
+/**
+ * @brief Emits the code shared by every block at the start of the
+ * buffer: the entry from C and the exits back to it.
+ *
+ * @param cache
+ */
+static void jit_emit_trampolines(jit_cache* cache){
+    jit_asm as_stack;
+    jit_asm* as = &as_stack;
+    as->cache = cache;
+    as->p = cache->code;
+
+    // int enter(cpu_state* cpu, jit_cache* cache, const uint8_t* code)
+    cache->enter = (jit_entry)(uintptr_t)as->p;
+    x_push(as, RBX);
+    x_push(as, RBP);
+    x_push(as, R12);
+    x_push(as, R13);
+    x_push(as, R14);
+    x_push(as, R15);
+    x_alu64_imm(as, 5, RSP, 8);     // keep rsp 16 byte aligned for calls
+    x_mov64(as, REG_CPU, RDI);
+    x_mov64(as, REG_CACHE, RSI);
+    x_op(as, X_W | X_MEM, 0x8B, REG_MEM, REG_CPU, NO_REG, CPU_OFF(mem.base));
+    x_op(as, X_W | X_MEM, 0x8B, REG_CYCLES, REG_CPU, NO_REG, CPU_OFF(cycles));
+    x_op(as, X_W | X_MEM, 0x8B, REG_INSTS, REG_CPU, NO_REG, CPU_OFF(instructions));
+    x_op(as, X_W | X_MEM, 0x8B, REG_TARGET, REG_CACHE, NO_REG, CACHE_OFF(target));
+    g_reload(as);
+    x_op(as, 0, 0xFF, 4, RDX, NO_REG, 0);  // jmp rdx
+
+    // exit_link, rcx: the exit taken
+    cache->exit_link = as->p;
+    x_op(as, X_W | X_MEM, 0x89, RCX, REG_CACHE, NO_REG, CACHE_OFF(last_link));
+    // exit, eax: the guest pc
+    cache->exit = as->p;
+    x_mov_imm(as, RDX, 1);
+    // exit_status, edx: the status returned
+    cache->exit_status = as->p;
+    x_op(as, X_16 | X_MEM, 0x89, RAX, REG_CPU, NO_REG, CPU_OFF(PC));
+    g_spill(as);
+    x_op(as, X_W | X_MEM, 0x89, REG_CYCLES, REG_CPU, NO_REG, CPU_OFF(cycles));
+    x_op(as, X_W | X_MEM, 0x89, REG_INSTS, REG_CPU, NO_REG, CPU_OFF(instructions));
+    x_mov(as, RAX, RDX);
+    x_alu64_imm(as, 0, RSP, 8);
+    x_pop(as, R15);
+    x_pop(as, R14);
+    x_pop(as, R13);
+    x_pop(as, R12);
+    x_pop(as, RBP);
+    x_pop(as, RBX);
+    emit8(as, 0xC3);                // ret
+
+    // exit_indirect, eax: the guest pc, straight into its block if there's one
+    cache->exit_indirect = as->p;
+    x_op(as, X_W | X_MEM | X_SCALE8, 0x8B, RCX, REG_CACHE, RAX, CACHE_OFF(lookup));
+    x_op(as, X_W, 0x85, RCX, RCX, NO_REG, 0);   // test rcx, rcx
+    x_patch(x_jcc_fwd(as, CC_E), cache->exit);
+    x_op(as, X_MEM, 0xFF, 4, RCX, NO_REG, (int32_t)offsetof(jit_block, code));
+
+    cache->code_blocks = (uint8_t*)(((uintptr_t)as->p + 15) & ~(uintptr_t)15);
+    cache->code_free = cache->code_blocks;
+}
+
+/**
+ * @brief Points a block's entry at an exit to the dispatcher, so blocks
+ * chained to it and the indirect exits stop running it.
+ *
+ * @param cache
+ * @param block
+ */
+static void jit_retire(jit_cache* cache, jit_block* block){
+    jit_asm as;
+    as.cache = cache;
+    as.p = (uint8_t*)block->code;
+    x_mov_imm(&as, RAX, block->start);
+    x_jmp(&as, cache->exit);
+}
+
+/**
+ * @brief Invalidates every block covering a written address
+ *
+ * @param cache
+ * @param offset written to
+ */
+static void jit_write_hit(jit_cache* cache, uint16_t offset){
+    if(!(cache->code_map[offset] & JIT_MAP_CODE)){
+        return;
+    }
+    for(uint16_t back = 0; back < JIT_MAX_BYTES; back++){
+        uint16_t start = offset - back;
+        jit_block* block = cache->lookup[start];
+        if(block && back < block->bytes){
+            cache->lookup[start] = NULL;
+            jit_retire(cache, block);
+            if(block == cache->current){
+                cache->current = NULL;
+            }
+        }
+    }
+    cache->code_map[offset] &= ~JIT_MAP_CODE;
+}
+
+/**
+ * @brief Called by translated code for a store the code map flagged
+ *
+ * @param cpu
+ * @param addr stored to
+ * @param width bytes stored
+ * @param value stored
+ */
+static void jit_store(cpu_state* cpu, uint32_t addr, uint32_t width, uint32_t value){
+    if(width == 1){
+        mem_write(&cpu->mem, (uint16_t)addr, (uint8_t)value);
+    } else {
+        short_mem_write(&cpu->mem, (uint16_t)addr, (uint16_t)value);
+    }
+}
+
+/**
+ * @brief memory watch callback, writes through mem_write/short_mem_write
+ *
+ * @param ctx the jit_cache
+ * @param offset written to
+ */
+static void jit_watch_hit(void* ctx, uint16_t offset){
+    jit_write_hit((jit_cache*)ctx, offset);
+}
+
+/**
+ * @brief Brings the code map's JIT_MAP_TRAP bits in line with the page
+ * table, the code map holding no code
+ *
+ * @param cache
+ * @param mem
+ */
+static void jit_map_traps(jit_cache* cache, const v_memory* mem){
+    for(uint32_t page = 0; page < MEM_PAGES; page++){
+        uint8_t trap = mem->pages[page] & MEM_STORE_TRAP ? JIT_MAP_TRAP : 0;
+        if(cache->trap_pages[page] != trap){
+            memset(&cache->code_map[page * MEM_PAGE_SIZE], trap, MEM_PAGE_SIZE);
+            cache->trap_pages[page] = trap;
+        }
+    }
+    // A 16 bit store at 0xFFFF wraps to 0
+    cache->code_map[MEM_SIZE] = cache->code_map[0];
+}
+
+/**
+ * @brief Drops every translated block and the host code behind them
+ *
+ * @param cache
+ * @param mem
+ */
+static void jit_flush(jit_cache* cache, v_memory* mem){
+    for(uint32_t i = 0; i < cache->used; i++){
+        jit_block* block = &cache->pool[i];
+        if(cache->lookup[block->start] == block){
+            cache->lookup[block->start] = NULL;
+        }
+        for(uint16_t b = 0; b < block->bytes; b++){
+            cache->code_map[(uint16_t)(block->start + b)] &= ~JIT_MAP_CODE;
+        }
+    }
+    jit_map_traps(cache, mem);
+    memset(cache->code_pages, 0, sizeof(cache->code_pages));
+    mem_watch_sync(mem, 0, MEM_PAGES);
+    memset(cache->heat, 0, sizeof(cache->heat));
+    cache->current = NULL;
+    cache->last_link = NULL;
+    cache->used = 0;
+    cache->code_free = cache->code_blocks;
+}
+
+void jit_cache_flush(cpu_state* cpu){
+    if(cpu->engine_state){
+        jit_flush(cpu->engine_state, &cpu->mem);
+    }
+}
+
+void jit_cache_free(cpu_state* cpu){
+    jit_cache* cache = cpu->engine_state;
+    if(cache){
+        mem_watch_set(&cpu->mem, NULL, NULL, NULL);
+        munmap(cache->code, JIT_CODE_SIZE);
+        free(cache);
+        cpu->engine_state = NULL;
+    }
+}
+
+/**
+ * @brief Creates the cpu's translation cache and hooks it up to the
+ * memory watch
+ *
+ * @param cpu
+ * @return jit_cache* NULL if no executable memory could be had
+ */
+static jit_cache* jit_cache_init(cpu_state* cpu){
+    jit_cache* cache = calloc(1, sizeof(jit_cache));
+    if(!cache){
+        return NULL;
+    }
+    cache->code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(cache->code == MAP_FAILED){
+        WARN(0, "%s\n", "No executable memory for the JIT.");
+        free(cache);
+        return NULL;
+    }
+    jit_emit_trampolines(cache);
+    jit_map_traps(cache, &cpu->mem);
+    cpu->engine_state = cache;
+    mem_watch_set(&cpu->mem, cache->code_pages, &jit_watch_hit, cache);
+    return cache;
+}
+
+/**
+ * @brief Decodes and translates the block starting at pc
+ *
+ * @param cache
+ * @param mem guest memory
+ * @param pc
+ * @return jit_block*
+ */
+static jit_block* jit_translate(jit_cache* cache, v_memory* mem, uint16_t pc){
+    if(cache->used == JIT_POOL_SIZE ||
+       cache->code_free + JIT_BLOCK_CODE > cache->code + JIT_CODE_SIZE){
+        DEBUG_PRINT("%s\n", "JIT cache full, flushing.");
+        jit_flush(cache, mem);
+    }
+    jit_asm as_stack;
+    jit_asm* as = &as_stack;
+    jit_block* block = &cache->pool[cache->used++];
+    as->cache = cache;
+    as->block = block;
+    as->n_stubs = 0;
+
+    // Decode, same block boundaries as the block cache engine
+    uint32_t cycles = 0;
+    block->start = pc;
+    block->len = 0;
+    block->bytes = 0;
+    block->lead_cycles = 0;
+    while(block->len < JIT_MAX_OPS){
+        jit_op* op = &as->ops[block->len];
+        op->pc = pc + block->bytes;
+        op->code = mem_read(mem, op->pc);
+        op->size = opcode_size(op->code);
+        op->cycles = opcode_cycles(op->code);
+        op->imm = 0;
+        if(op->size == 2){
+            op->imm = mem_read(mem, op->pc + 1);
+        } else if(op->size == 3){
+            // Same read as the interpreter, even at the top of memory
+            op->imm = short_mem_read(mem, op->pc + 1);
+        }
+        // Never let a block wrap around the address space
+        uint8_t wraps = op->pc + op->size >= 0x10000;
+        if(wraps && block->len){
+            break;
+        }
+        block->lead_cycles = cycles;
+        cycles += op->cycles;
+        block->bytes += op->size;
+        block->len++;
+        if(wraps || opcode_ends_block(op->code)){
+            break;
+        }
+    }
+    uint32_t later = 0;
+    for(int i = block->len - 1; i >= 0; i--){
+        as->rem_cycles[i] = later;
+        later += as->ops[i].cycles;
+    }
+
+    // Entry: run only if every op starts inside the budget, then charge them all.
+    // The lea and cmp are rewritten by jit_retire, keep them 10+ bytes
+    as->p = cache->code_free;
+    block->code = as->p;
+    x_op(as, X_W | X_MEM, 0x8D, RAX, REG_CYCLES, NO_REG, block->lead_cycles);
+    x_op(as, X_W, 0x39, REG_TARGET, RAX, NO_REG, 0);    // cmp rax, r12
+    uint8_t* over_budget = x_jcc_fwd(as, CC_AE);
+    x_alu64_imm(as, 0, REG_CYCLES, cycles);
+    x_alu64_imm(as, 0, REG_INSTS, block->len);
+
+    for(uint8_t i = 0; i < block->len; i++){
+        g_op(as, i);
+    }
+    // Ran off the op limit, or the end of memory
+    if(!opcode_ends_block(as->ops[block->len - 1].code)){
+        g_link(as, pc + block->bytes);
+    }
+
+    // Out of line paths
+    x_patch(over_budget, as->p);
+    x_mov_imm(as, RAX, pc);
+    x_jmp(as, cache->exit);
+    for(uint32_t i = 0; i < as->n_stubs; i++){
+        g_emit_stub(as, &as->stubs[i]);
+    }
+    cache->code_free = (uint8_t*)(((uintptr_t)as->p + 15) & ~(uintptr_t)15);
+
+    for(uint16_t i = 0; i < block->bytes; i++){
+        uint16_t addr = pc + i;
+        cache->code_map[addr] |= JIT_MAP_CODE;
+        if(!cache->code_pages[addr >> 8]){
+            cache->code_pages[addr >> 8] = 1;
+            mem_watch_sync(mem, addr >> 8, 1);
+        }
+    }
+    cache->lookup[pc] = block;
+    return block;
+}
+
+/**
+ * @brief Points a chainable exit straight at the block it leads to
+ *
+ * @param link the exit, see g_link
+ * @param block
+ */
+static void jit_chain(uint8_t* link, const jit_block* block){
+    link[0] = 0xE9;
+    x_patch(link + 1, block->code);
+}
+
+#ifdef IDLE_SKIP
+/**
+ * @brief Whether the block ends on a jump back to its own start, short
+ * enough to be an idle loop. Exits into such a block stay unchained so
+ * the dispatcher gets to call idle_skip on every pass.
+ *
+ * @param mem
+ * @param block
+ * @return int 1 if a candidate
+ */
+static int jit_self_loop(v_memory* mem, const jit_block* block){
+    if(block->bytes < 3 || block->bytes - 3 >= IDLE_MAX_BYTES){
+        return 0;
+    }
+    uint16_t last = block->start + block->bytes - 3;
+    uint8_t op_code = mem_read(mem, last);
+    uint16_t imm = mem_read(mem, last + 1) | (mem_read(mem, last + 2) << 8);
+    return (op_code == 0xC3 || (op_code & 0xC7) == 0xC2) && imm == block->start;
+}
+#endif
+
+int jit_run_cycles(cpu_state* cpu, uint32_t budget){
+    jit_cache* cache = cpu->engine_state;
+    if(!cache && !(cache = jit_cache_init(cpu))){
+        return interp_run_cycles(cpu, budget);
+    }
+    uint64_t target = cpu->cycles + budget;
+    cache->target = target;
+    uint8_t* link = NULL;
+    while(cpu->cycles < target){
+        if(cpu->halt){
+            return 0;
+        }
+        // exec_inst takes the pending intt, translated code never sees one
+        if(cpu->intt && cpu->pend_intt){
+            link = NULL;
+            if(exec_inst(cpu) != 1){
+                return -1;
+            }
+            continue;
+        }
+        uint16_t pc = cpu->PC;
+#ifdef HLE
+        // Never linked to, so every call into a routine comes back here
+        if(hle_hit(cpu, pc)){
+            link = NULL;
+            if(hle_call(cpu, target)){
+                continue;
+            }
+        }
+#endif
+        jit_block* block = cache->lookup[pc];
+        if(!block && cache->heat[pc] < JIT_HOT_RUNS){
+            cache->heat[pc]++;
+        } else if(!block && target - cpu->cycles > JIT_MAX_CYCLES){
+            // Close to the budget, don't translate off mid block addresses
+            block = jit_translate(cache, &cpu->mem, pc);
+            link = NULL;
+        }
+        if(block && cpu->cycles + block->lead_cycles < target){
+#ifdef IDLE_SKIP
+            if(link && cpu->idle_reject != (0x10000u | pc) && jit_self_loop(&cpu->mem, block)){
+                link = NULL;
+                idle_skip(cpu, block->start + block->bytes - 3, target);
+                continue;
+            }
+#endif
+            if(link){
+                jit_chain(link, block);
+            }
+            cache->last_link = NULL;
+            if(cache->enter(cpu, cache, block->code) != 1){
+                return -1;
+            }
+            link = cache->last_link;
+            continue;
+        }
+        // Cold, or the budget ends inside the block: step one run of straight line code
+        link = NULL;
+        uint8_t op_code;
+        do {
+            op_code = mem_read(&cpu->mem, cpu->PC);
+            if(exec_inst(cpu) != 1){
+                return -1;
+            }
+        } while(!opcode_ends_block(op_code) && cpu->cycles < target &&
+                !(cpu->intt && cpu->pend_intt));
+    }
+    return 1;
+}
+
+uint64_t jit_cache_key(){
+    return (uint64_t)JIT_CACHE_VERSION << 32 | JIT_MAX_OPS;
+}
+
+size_t jit_cache_save(cpu_state* cpu, uint8_t* out, uint32_t code_end, uint32_t* count){
+    jit_cache* cache = cpu->engine_state;
+    size_t size = 0;
+    *count = 0;
+    if(!cache){
+        return 0;
+    }
+    for(uint32_t i = 0; i < cache->used; i++){
+        jit_block* block = &cache->pool[i];
+        if(cache->lookup[block->start] != block || block->start + block->bytes > code_end){
+            continue;
+        }
+        if(out){
+            memcpy(out + size, &block->start, sizeof(block->start));
+        }
+        size += sizeof(block->start);
+        (*count)++;
+    }
+    return size;
+}
+
+uint8_t jit_cache_load(cpu_state* cpu, const uint8_t* in, size_t size, uint32_t count){
+    jit_cache* cache = cpu->engine_state;
+    if(!cache && !(cache = jit_cache_init(cpu))){
+        return 0;
+    }
+    if(size != count * sizeof(uint16_t) || count > JIT_POOL_SIZE - cache->used){
+        return 0;
+    }
+    for(uint32_t i = 0; i < count; i++){
+        // Leave the rest to warm up as usual rather than flush
+        if(cache->code_free + JIT_BLOCK_CODE > cache->code + JIT_CODE_SIZE){
+            break;
+        }
+        uint16_t start;
+        memcpy(&start, in + i * sizeof(start), sizeof(start));
+        if(!cache->lookup[start]){
+            jit_translate(cache, &cpu->mem, start);
+        }
+    }
+    return 1;
+}
+
+#else
+
+int jit_run_cycles(cpu_state* cpu, uint32_t budget){
+    return interp_run_cycles(cpu, budget);
+}
+
+void jit_cache_flush(UNUSED cpu_state* cpu){
+}
+
+void jit_cache_free(UNUSED cpu_state* cpu){
+}
+
+uint64_t jit_cache_key(){
+    return 0;
+}
+
+size_t jit_cache_save(UNUSED cpu_state* cpu, UNUSED uint8_t* out, UNUSED uint32_t code_end, uint32_t* count){
+    *count = 0;
+    return 0;
+}
+
+uint8_t jit_cache_load(UNUSED cpu_state* cpu, UNUSED const uint8_t* in, UNUSED size_t size,
+                       UNUSED uint32_t count){
+    return 0;
+}
+
+#endif /* __x86_64__ && __linux__ */
@@ -0,0 +1,94 @@
+/**
+ * @file cpu_threaded.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Threaded (computed goto) execution engine for the 8080. Every
+ * opcode is a label with its operands fixed, and each one jumps straight
+ * to the next opcode's label. PC, SP, ACC and the lazy PSW live in locals for
+ * the whole slice and are only written back to cpu_state at the slice
+ * boundary or around IN/OUT callbacks.
+ * @note Needs GCC/Clang labels-as-values. Selected with `make ENGINE=threaded`.
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "threaded_ops_8080.h"
+
+#ifdef __GNUC__
+
+///@{
+/** Guest memory access, same addressing as mem_ref. Stores to ROM go
+ * through mem_write to be dropped. */
+#define MEM_PTR(addr)   ((uintptr_t)mem_base | (uint16_t)(addr))
+#define MEM_TRAP(addr)  (mem_pages[(uint16_t)(addr) >> 8] & MEM_WRITE_TRAP)
+#define RD8(addr)       (*(uint8_t *)MEM_PTR(addr))
+#define WR8(addr, val)  do { uint16_t w_ = (addr);                                  \
+                             if(MEM_TRAP(w_)) mem_write(&cpu->mem, w_, (val));      \
+                             else *(uint8_t *)MEM_PTR(w_) = (val); } while(0)
+#define RD16(addr)      (*(uint16_t *)MEM_PTR(addr))
+#define WR16(addr, val) do { uint16_t w_ = (addr);                                  \
+                             if(MEM_TRAP(w_) | MEM_TRAP(w_ + 1))                    \
+                                 short_mem_write(&cpu->mem, w_, (val));             \
+                             else *(uint16_t *)MEM_PTR(w_) = (val); } while(0)
+#define IMM8            RD8(pc + 1)
+#define IMM16           RD16(pc + 1)
+#define CALL_IMM16      IMM16
+///@}
+
+///@{
+/** Dispatch: fetch the next opcode, charge it and jump to its label */
+#define OP_LABEL(code, body)    &&op_##code,
+#define OP_BODY(code, body)     op_##code: body;
+#define DISPATCH()      do { if(cycles >= target) goto slice_end;                   \
+                             op = RD8(pc);                                          \
+                             cycles += op_cycles[op];                               \
+                             instructions++;                                        \
+                             goto *dispatch_table[op]; } while(0)
+#define NEXT(n)         do { pc += (n); DISPATCH(); } while(0)
+///@}
+
+/** Cycle counts copied out of opcode_lookup on first use */
+static uint8_t op_cycles[0x100];
+static uint8_t op_cycles_ready;
+
+int threaded_run_cycles(cpu_state* cpu, uint32_t budget){
+    static const void* const dispatch_table[0x100] = { OPCODE_BODIES(OP_LABEL) };
+
+    if(!op_cycles_ready){
+        for(uint16_t i = 0; i < 0x100; i++){
+            op_cycles[i] = opcode_cycles(i);
+        }
+        op_cycles_ready = 1;
+    }
+
+    uint64_t cycles = cpu->cycles;
+    uint64_t instructions = cpu->instructions;
+    uint64_t target = cycles + budget;
+    if(cycles < target && cpu->halt){
+        return 0;
+    }
+
+    void* mem_base = cpu->mem.base;
+    const uintptr_t* mem_pages = cpu->mem.pages;
+    uint16_t pc, sp;
+    uint8_t a, op;
+    program_status_word psw;
+    SYNC_IN();
+    CHECK_INTT();
+    DISPATCH();
+
+    OPCODE_BODIES(OP_BODY)
+
+slice_end:
+    SYNC_OUT();
+    // Only a HLT leaves the slice early
+    return cycles < target ? 0 : 1;
+}
+
+#endif /* __GNUC__ */
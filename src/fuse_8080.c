@@ -0,0 +1,93 @@
+/**
+ * @file fuse_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Superinstruction generator behind `make fuse`. Reads the opcode
+ * pair profile pair_profile_dump wrote and writes fused_ops_8080.h, the
+ * most frequent pairs the block engine can run as one op: the first opcode
+ * has to run on into the second, so it can't be one that ends a block.
+ * usage: fuse_8080 <pair profile> <pairs> <output.h>
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "threaded_ops_8080.h"
+
+///@{
+/** Source text of every opcode body */
+#define BODY_TEXT(code, body)   [0x##code] = #body,
+static const char* const op_body[0x100] = { OPCODE_BODIES(BODY_TEXT) };
+///@}
+
+/**
+ * @brief fuse_8080 driver.
+ * usage: fuse_8080 <pair profile> <pairs> <output.h>
+ *
+ * @return int 0 if success, else error code
+ */
+int main(int argc, char** argv){
+    if(argc != 4){
+        fprintf(stderr, "usage: %s <pair profile> <pairs> <output.h>\n", argv[0]);
+        return -1;
+    }
+    uint32_t wanted = strtoul(argv[2], NULL, 0);
+    FILE* profile = fopen(argv[1], "r");
+    if(!profile){
+        fprintf(stderr, "fuse_8080: can't open %s\n", argv[1]);
+        return -1;
+    }
+    FILE* out = fopen(argv[3], "w");
+    if(!out){
+        fprintf(stderr, "fuse_8080: can't write %s\n", argv[3]);
+        fclose(profile);
+        return -1;
+    }
+
+    fprintf(out,
+        "/**\n"
+        " * @file fused_ops_8080.h\n"
+        " * @author Pranay Garg (pranayga@andrew.cmu.edu)\n"
+        " * @brief Generated by fuse_8080 (`make fuse`), do not edit. The most\n"
+        " * frequent opcode pairs of the profiled run, which the block engine\n"
+        " * runs as one superinstruction.\n"
+        " * @version 0.1\n"
+        " * @date 2026-10-16\n"
+        " *\n"
+        " */\n"
+        "#ifndef FUSED_OPS_8080_H\n"
+        "#define FUSED_OPS_8080_H\n\n"
+        "/**\n"
+        " * @brief X-macro over the fused pairs, X(first, second, first body,\n"
+        " * second body) with the bodies as in OPCODE_BODIES. The trailing count\n"
+        " * is how often the pair ran in the profile.\n"
+        " */\n"
+        "#define FUSED_OPS(X)                                                            \\\n");
+
+    char line[128];
+    uint32_t picked = 0;
+    while(picked < wanted && fgets(line, sizeof(line), profile)){
+        unsigned first, second;
+        uint64_t count;
+        if(line[0] == '#' || sscanf(line, "%x %x %" SCNu64, &first, &second, &count) != 3){
+            continue;
+        }
+        if(first > 0xFF || second > 0xFF || opcode_ends_block(first)){
+            continue;
+        }
+        char entry[96];
+        snprintf(entry, sizeof(entry), "X(%02X, %02X, %s, %s)", first, second,
+                 op_body[first], op_body[second]);
+        fprintf(out, "    %-52s /* %12" PRIu64 " */ \\\n", entry, count);
+        picked++;
+    }
+    fprintf(out, "\n#endif\n");
+    fclose(profile);
+    fclose(out);
+    fprintf(stderr, "fuse_8080: %" PRIu32 " fused pairs into %s\n", picked, argv[3]);
+    return 0;
+}
@@ -0,0 +1,611 @@
+/**
+ * @file fuzz_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Differential fuzzer. Each case is one random instruction at a
+ * random PC with random registers, flags, interrupt state and data
+ * wherever it can read, and a HLT wherever it can go next. The case is
+ * run on the frozen reference model (ref_run_cycles), on the
+ * opcode_lookup handlers (interp_run_cycles) and on the engine the
+ * binary was built with (engine_run_cycles), and the handlers and the
+ * engine are each compared with the model: registers, flags, interrupt
+ * state, cycles, instructions, IO and all 64KB of memory. Cases are
+ * derived from the seed and their index alone, so a failure replays on
+ * its own; it is then shrunk field by field to the least state which
+ * still fails.
+ * @note The model doesn't share code with the handlers or any engine,
+ * so a flag or DAA change made to both opcodes_8080.h and
+ * threaded_ops_8080.h still shows up, whichever ENGINE it's built with.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "ref_8080.h"
+
+#define FUZZ_MEM_SIZE       (1<<16)     /** 64KB of guest memory, 64KB aligned */
+#define FUZZ_BUDGET         1000        /** Cycles a case runs, past a block's worth */
+#define FUZZ_CASES          10000000ull /** Cases run by default */
+#define FUZZ_HLT            0x76
+#define FUZZ_MAX_JOBS       256
+#define FUZZ_MAX_FAILS      16          /** A job stops after this many */
+
+/**
+ * @brief Where a case puts its data bytes, in the order they're written
+ */
+typedef enum {
+    SPOT_HL, SPOT_BC, SPOT_DE, SPOT_SP, SPOT_IMM, SPOT_COUNT,
+} fuzz_spot;
+
+/**
+ * @brief Everything a case starts from. Memory is the background (the
+ * seed's noise or zeros), then the spot data, then HLTs where the
+ * instruction may go next, then the instruction itself.
+ */
+typedef struct {
+    uint8_t code[3];                /**< The instruction, at PC */
+    uint8_t reg[7];                 /**< B..L and A, by REG_SLOT */
+    uint8_t flags;                  /**< Compressed PSW */
+    uint16_t SP;
+    uint16_t PC;
+    uint8_t intt;
+    uint8_t pend_intt;
+    uint8_t data[SPOT_COUNT][2];    /**< Two bytes at each spot's address */
+    uint8_t noise;                  /**< 1 for the noise background, 0 for zeros */
+} fuzz_case;
+
+/**
+ * @brief What a case is run on
+ */
+typedef enum {
+    SIDE_MODEL, SIDE_HANDLERS, SIDE_ENGINE, SIDE_COUNT,
+} fuzz_which;
+
+/** Column names in reports, the engine's is engine_name() */
+static const char* const fuzz_side_name[SIDE_COUNT] = {"model", "handlers", NULL};
+
+/**
+ * @brief A cpu and what it did with a case
+ */
+typedef struct {
+    cpu_state* cpu;
+    int ret;            /**< Of the run */
+    uint32_t io;        /**< IN/OUT calls */
+    uint32_t io_hash;   /**< FNV-1a over them */
+} fuzz_side;
+
+/** The noise background, off the seed */
+static uint8_t* fuzz_noise;
+/** Side whose IO is being recorded, IN/OUT handlers get no context */
+static fuzz_side* fuzz_current;
+/** Sides run, SIDE_ENGINE only when there's an engine besides the handlers */
+static uint32_t fuzz_sides;
+
+static uint64_t splitmix64(uint64_t* state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void fuzz_io_log(uint8_t out, uint8_t port, uint8_t data){
+    fuzz_current->io++;
+    uint8_t bytes[] = {out, port, data};
+    for(uint32_t i = 0; i < sizeof(bytes); i++){
+        fuzz_current->io_hash = (fuzz_current->io_hash ^ bytes[i]) * 0x01000193u;
+    }
+}
+
+/** Ports read back a fixed function of the port */
+static uint8_t fuzz_IN(uint8_t port){
+    uint8_t data = (port * 0x9D) ^ 0x5A;
+    fuzz_io_log(0, port, data);
+    return data;
+}
+
+static void fuzz_OUT(uint8_t port, uint8_t data){
+    fuzz_io_log(1, port, data);
+}
+
+/**
+ * @brief Keeps 0xCB and 0xD9 out of anything which may get run, they
+ * stop the process in opcode_lookup. Made 0xCA and 0xD8 instead.
+ *
+ * @param byte
+ */
+static void fuzz_scrub(uint8_t* byte){
+    if(*byte == 0xCB || *byte == 0xD9){
+        *byte ^= 1;
+    }
+}
+
+/**
+ * @brief Makes case index of seed
+ *
+ * @param seed
+ * @param index
+ * @param fc
+ */
+static void fuzz_make(uint64_t seed, uint64_t index, fuzz_case* fc){
+    uint64_t state = seed ^ (index * 0xD1B54A32D192ED03ull);
+    splitmix64(&state);
+    uint64_t r = splitmix64(&state);
+    fc->code[0] = r;
+    fuzz_scrub(&fc->code[0]);
+    fc->code[1] = r >> 8;
+    fc->code[2] = r >> 16;
+    fc->flags = r >> 24;
+    fc->SP = r >> 32;
+    fc->PC = r >> 48;
+    r = splitmix64(&state);
+    memcpy(fc->reg, &r, sizeof(fc->reg));
+    fc->intt = (r >> 56) & 1;
+    // The machine only raises RST 0..3, which is all the engines take
+    fc->pend_intt = ((r >> 57) & 7) == 0 ? (r >> 60) & 0xF : 0;
+    uint64_t data[2] = {splitmix64(&state), splitmix64(&state)};
+    memcpy(fc->data, data, sizeof(fc->data));
+    for(uint32_t i = 0; i < sizeof(fc->data); i++){
+        fuzz_scrub(&fc->data[0][0] + i);
+    }
+    fc->noise = 1;
+}
+
+/**
+ * @brief Whether a push from sp stays off every HLT the case lays out:
+ * a CALL, RST or interrupt would write its return address over the one
+ * it goes to, and run that instead
+ *
+ * @param sp
+ * @param halts where the HLTs are
+ * @param count of halts
+ * @return int 1 if clear
+ */
+static int fuzz_push_clear(uint16_t sp, const uint16_t* halts, uint32_t count){
+    for(uint32_t i = 0; i < count; i++){
+        if(halts[i] == (uint16_t)(sp - 1) || halts[i] == (uint16_t)(sp - 2)){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Lays the case out in the cpu and its memory. SP is moved up a
+ * few bytes at a time until a push from it can't land on a HLT.
+ *
+ * @param fc
+ * @param cpu with mem.base set
+ */
+static void fuzz_load(const fuzz_case* fc, cpu_state* cpu){
+    uint8_t* mem = cpu->mem.base;
+    memcpy(cpu->reg, fc->reg, sizeof(fc->reg));
+    uint16_t imm = fc->code[1] | fc->code[2] << 8;
+    uint16_t sp = fc->SP;
+    for(uint32_t tries = 0; ; tries++, sp += 4){
+        if(fc->noise){
+            memcpy(mem, fuzz_noise, FUZZ_MEM_SIZE);
+        } else {
+            memset(mem, 0, FUZZ_MEM_SIZE);
+        }
+        uint16_t spots[SPOT_COUNT] = {
+            [SPOT_HL] = cpu->HL, [SPOT_BC] = cpu->BC, [SPOT_DE] = cpu->DE,
+            [SPOT_SP] = sp, [SPOT_IMM] = imm,
+        };
+        for(uint32_t i = 0; i < SPOT_COUNT; i++){
+            mem[spots[i]] = fc->data[i][0];
+            mem[(uint16_t)(spots[i] + 1)] = fc->data[i][1];
+        }
+        // Wherever it goes next: an RST, on, a jump or call, PCHL, a return
+        uint16_t halts[12];
+        uint32_t count = 0;
+        for(uint16_t vector = 0; vector < 0x40; vector += 8){
+            halts[count++] = vector;
+        }
+        halts[count++] = fc->PC + opcode_size(fc->code[0]);
+        halts[count++] = imm;
+        halts[count++] = cpu->HL;
+        halts[count++] = mem[sp] | mem[(uint16_t)(sp + 1)] << 8;
+        for(uint32_t i = 0; i < count; i++){
+            mem[halts[i]] = FUZZ_HLT;
+        }
+        // A push is 2 bytes and the HLTs 12, some 4 byte step is clear
+        if(fuzz_push_clear(sp, halts, count) || tries >= 0x4000){
+            break;
+        }
+    }
+    for(uint16_t i = 0; i < opcode_size(fc->code[0]); i++){
+        mem[(uint16_t)(fc->PC + i)] = fc->code[i];
+    }
+    cpu->SP = sp;
+    cpu->PSW = decompress_PSW(fc->flags);
+    cpu->PC = fc->PC;
+    cpu->intt = fc->intt;
+    cpu->pend_intt = fc->pend_intt;
+    cpu->IN_Func = &fuzz_IN;
+    cpu->OUT_Func = &fuzz_OUT;
+}
+
+/**
+ * @brief Runs the case on one side
+ *
+ * @param fc
+ * @param side
+ * @param which the side is
+ */
+static void fuzz_run(const fuzz_case* fc, fuzz_side* side, fuzz_which which){
+    cpu_state* cpu = side->cpu;
+    // Fresh cpu, keeping its memory and engine state
+    v_memory mem = cpu->mem;
+    void* engine_state = cpu->engine_state;
+    memset(cpu, 0, sizeof(cpu_state));
+    cpu->mem = mem;
+    cpu->engine_state = engine_state;
+    fuzz_load(fc, cpu);
+    side->io = side->io_hash = 0;
+    fuzz_current = side;
+    switch(which){
+    case SIDE_MODEL:
+        side->ret = ref_run_cycles(cpu, FUZZ_BUDGET);
+        break;
+    case SIDE_HANDLERS:
+        side->ret = interp_run_cycles(cpu, FUZZ_BUDGET);
+        break;
+    default:
+        flush_code_cache(cpu);
+#ifdef ENGINE_JIT
+        // Translated straight away, the JIT would otherwise step it cold
+        jit_cache_load(cpu, (const uint8_t*)&fc->PC, sizeof(fc->PC), 1);
+#endif
+        side->ret = engine_run_cycles(cpu, FUZZ_BUDGET);
+        break;
+    }
+}
+
+/**
+ * @brief Whether both sides ended up the same
+ *
+ * @param ref
+ * @param cand
+ * @return int 1 if so
+ */
+static int fuzz_same(const fuzz_side* ref, const fuzz_side* cand){
+    const cpu_state* a = ref->cpu;
+    const cpu_state* b = cand->cpu;
+    return ref->ret == cand->ret && !memcmp(a->reg, b->reg, SLOT_M) &&
+           compress_PSW(a->PSW) == compress_PSW(b->PSW) && a->SP == b->SP && a->PC == b->PC &&
+           a->intt == b->intt && a->pend_intt == b->pend_intt && a->halt == b->halt &&
+           a->cycles == b->cycles && a->instructions == b->instructions &&
+           ref->io == cand->io && ref->io_hash == cand->io_hash &&
+           !memcmp(a->mem.base, b->mem.base, FUZZ_MEM_SIZE);
+}
+
+/**
+ * @brief Runs a case on every side
+ *
+ * @param fc
+ * @param sides
+ * @return int 1 if they all agree with the model
+ */
+static int fuzz_check(const fuzz_case* fc, fuzz_side* sides){
+    int same = 1;
+    for(uint32_t which = 0; which < fuzz_sides; which++){
+        fuzz_run(fc, &sides[which], which);
+        same &= which == SIDE_MODEL || fuzz_same(&sides[SIDE_MODEL], &sides[which]);
+    }
+    return same;
+}
+
+/**
+ * @brief Shrinks a failing case: zeroes each field in turn (the
+ * background, registers, flags, interrupt state, spot data, operands)
+ * and keeps every change it still fails with
+ *
+ * @param fc failing case, shrunk in place
+ * @param sides
+ */
+static void fuzz_minimise(fuzz_case* fc, fuzz_side* sides){
+    uint8_t* fields[] = {
+        &fc->noise, &fc->reg[0], &fc->reg[1], &fc->reg[2], &fc->reg[3], &fc->reg[4],
+        &fc->reg[5], &fc->reg[6], &fc->flags, &fc->intt, &fc->pend_intt,
+        &fc->code[1], &fc->code[2], (uint8_t*)&fc->SP, (uint8_t*)&fc->SP + 1,
+    };
+    uint8_t progress = 1;
+    while(progress){
+        progress = 0;
+        for(uint32_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++){
+            uint8_t was = *fields[i];
+            if(!was){
+                continue;
+            }
+            *fields[i] = 0;
+            if(fuzz_check(fc, sides)){
+                *fields[i] = was;
+            } else {
+                progress = 1;
+            }
+        }
+        for(uint32_t i = 0; i < sizeof(fc->data); i++){
+            uint8_t* byte = &fc->data[0][0] + i;
+            uint8_t was = *byte;
+            if(!was){
+                continue;
+            }
+            *byte = 0;
+            if(fuzz_check(fc, sides)){
+                *byte = was;
+            } else {
+                progress = 1;
+            }
+        }
+    }
+    // Leave both sides as the shrunk case has them for the report
+    fuzz_check(fc, sides);
+}
+
+/**
+ * @brief Prints a field of every side, marking a difference from the model
+ *
+ * @param name
+ * @param vals by side
+ */
+static void fuzz_row(const char* name, const uint64_t* vals){
+    uint8_t differs = 0;
+    printf("  %-14s", name);
+    for(uint32_t which = 0; which < fuzz_sides; which++){
+        printf(" %10" PRIx64, vals[which]);
+        differs |= vals[which] != vals[SIDE_MODEL];
+    }
+    printf("%s\n", differs ? "  <--" : "");
+}
+
+/** Prints a row of expr, over cpu and side, for every side */
+#define FUZZ_ROW(name, expr) do {                                               \
+    uint64_t vals[SIDE_COUNT];                                                  \
+    for(uint32_t which = 0; which < fuzz_sides; which++){                       \
+        UNUSED const fuzz_side* side = &sides[which];                           \
+        UNUSED const cpu_state* cpu = side->cpu;                                \
+        vals[which] = (expr);                                                   \
+    }                                                                           \
+    fuzz_row(name, vals);                                                       \
+} while(0)
+
+/**
+ * @brief Prints a shrunk failing case and where the sides parted
+ *
+ * @param seed
+ * @param index
+ * @param fc
+ * @param sides as the case left them
+ */
+static void fuzz_report(uint64_t seed, uint64_t index, const fuzz_case* fc, const fuzz_side* sides){
+    printf("case %" PRIu64 " of seed %" PRIu64 " differs, replay with `./fuzz 1 %" PRIu64 " 1 %" PRIu64 "`\n",
+           index, seed, seed, index);
+    printf("  %04X:", fc->PC);
+    for(uint16_t i = 0; i < opcode_size(fc->code[0]); i++){
+        printf(" %02X", fc->code[i]);
+    }
+    printf("  B=%02X C=%02X D=%02X E=%02X H=%02X L=%02X A=%02X F=%02X SP=%04X intt=%u pend=%x %s memory\n",
+           fc->reg[SLOT_B], fc->reg[SLOT_C], fc->reg[SLOT_D], fc->reg[SLOT_E], fc->reg[SLOT_H],
+           fc->reg[SLOT_L], fc->reg[SLOT_A], fc->flags, fc->SP, fc->intt, fc->pend_intt,
+           fc->noise ? "noise" : "zeroed");
+    printf("  spot data HL:%02X%02X BC:%02X%02X DE:%02X%02X SP:%02X%02X imm:%02X%02X\n",
+           fc->data[SPOT_HL][0], fc->data[SPOT_HL][1], fc->data[SPOT_BC][0], fc->data[SPOT_BC][1],
+           fc->data[SPOT_DE][0], fc->data[SPOT_DE][1], fc->data[SPOT_SP][0], fc->data[SPOT_SP][1],
+           fc->data[SPOT_IMM][0], fc->data[SPOT_IMM][1]);
+    printf("  %-14s", "");
+    for(uint32_t which = 0; which < fuzz_sides; which++){
+        printf(" %10s", fuzz_side_name[which] ? fuzz_side_name[which] : engine_name());
+    }
+    printf("\n");
+    FUZZ_ROW("returned", side->ret);
+    for(uint8_t code = 0; code < 8; code++){
+        if(REG_SLOT(code) != SLOT_M){
+            char name[] = {"BCDEHLMA"[code], 0};
+            FUZZ_ROW(name, cpu->reg[REG_SLOT(code)]);
+        }
+    }
+    FUZZ_ROW("PSW", compress_PSW(cpu->PSW));
+    FUZZ_ROW("SP", cpu->SP);
+    FUZZ_ROW("PC", cpu->PC);
+    FUZZ_ROW("intt", cpu->intt);
+    FUZZ_ROW("pend_intt", cpu->pend_intt);
+    FUZZ_ROW("halt", cpu->halt);
+    FUZZ_ROW("cycles", cpu->cycles);
+    FUZZ_ROW("instructions", cpu->instructions);
+    FUZZ_ROW("IO calls", side->io);
+    FUZZ_ROW("IO hash", side->io_hash);
+    for(uint32_t addr = 0; addr < FUZZ_MEM_SIZE; addr++){
+        uint8_t differs = 0;
+        for(uint32_t which = 1; which < fuzz_sides; which++){
+            differs |= ((const uint8_t*)sides[which].cpu->mem.base)[addr] !=
+                       ((const uint8_t*)sides[SIDE_MODEL].cpu->mem.base)[addr];
+        }
+        if(differs){
+            char name[16];
+            snprintf(name, sizeof(name), "mem %04X", addr);
+            FUZZ_ROW(name, ((const uint8_t*)cpu->mem.base)[addr]);
+        }
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Where a job is, shared with the driver so a job which dies
+ * can be counted and carried on past the case which took it down
+ */
+typedef struct {
+    uint64_t at;        /**< Case being run */
+    uint64_t ran;       /**< Cases finished */
+    uint64_t fails;     /**< Of them, failed */
+} fuzz_job;
+
+/**
+ * @brief A worker's share: cases from, from + jobs, ... up to end
+ *
+ * @param seed
+ * @param from
+ * @param end
+ * @param jobs
+ * @param job progress, kept as each case finishes
+ */
+static void fuzz_worker(uint64_t seed, uint64_t from, uint64_t end, uint32_t jobs, volatile fuzz_job* job){
+    fuzz_side sides[SIDE_COUNT] = {{0}};
+    for(uint32_t which = 0; which < fuzz_sides; which++){
+        sides[which].cpu = init_cpu_8080(0, NULL, NULL);
+        if(!mem_init(&sides[which].cpu->mem)){
+            fprintf(stderr, "fuzz: out of memory\n");
+            exit(1);
+        }
+    }
+    // Past a few, the rest are likely the same bug again
+    for(uint64_t index = from; index < end && job->fails < FUZZ_MAX_FAILS; index += jobs){
+        fuzz_case fc;
+        job->at = index;
+        fuzz_make(seed, index, &fc);
+        if(!fuzz_check(&fc, sides)){
+            fuzz_minimise(&fc, sides);
+            fuzz_report(seed, index, &fc, sides);
+            job->fails++;
+        }
+        job->ran++;
+    }
+    for(uint32_t which = 0; which < fuzz_sides; which++){
+        mem_free(&sides[which].cpu->mem);
+        free_cpu_8080(sides[which].cpu);
+    }
+}
+
+/**
+ * @brief Forks a worker on the job's cases from from
+ *
+ * @return pid_t of the worker, -1 if it couldn't be
+ */
+static pid_t fuzz_fork(uint64_t seed, uint64_t from, uint64_t end, uint32_t jobs, volatile fuzz_job* job){
+    pid_t pid = fork();
+    if(pid == 0){
+        fuzz_worker(seed, from, end, jobs, job);
+        fflush(stdout);
+        _exit(0);
+    }
+    if(pid == -1){
+        perror("fork");
+    }
+    return pid;
+}
+
+/**
+ * @brief fuzz driver.
+ * usage: fuzz [cases] [seed] [jobs] [first_case]
+ * Runs cases first_case.. over jobs processes (default: one per core).
+ *
+ * @return int 0 if every case agreed, 1 if any didn't
+ */
+int main(int argc, char** argv){
+    uint64_t count = argc > 1 ? strtoull(argv[1], NULL, 0) : FUZZ_CASES;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : (uint64_t)time(NULL);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t jobs = argc > 3 ? strtoul(argv[3], NULL, 0) : (cores > 0 ? cores : 1);
+    uint64_t first = argc > 4 ? strtoull(argv[4], NULL, 0) : 0;
+    if(jobs < 1 || jobs > FUZZ_MAX_JOBS){
+        jobs = 1;
+    }
+
+    fuzz_noise = malloc(FUZZ_MEM_SIZE);
+    uint64_t state = seed;
+    for(uint32_t i = 0; i < FUZZ_MEM_SIZE; i += sizeof(uint64_t)){
+        uint64_t r = splitmix64(&state);
+        memcpy(fuzz_noise + i, &r, sizeof(r));
+    }
+    for(uint32_t i = 0; i < FUZZ_MEM_SIZE; i++){
+        fuzz_scrub(&fuzz_noise[i]);
+    }
+
+    // The interp engine is the handlers, they're run the once
+    fuzz_sides = strcmp(engine_name(), "interp") ? SIDE_COUNT : SIDE_ENGINE;
+    printf("fuzzing the handlers%s%s against the model: %" PRIu64 " cases of seed %" PRIu64 " from %" PRIu64
+           " on %u jobs\n", fuzz_sides == SIDE_COUNT ? " and " : "", fuzz_sides == SIDE_COUNT ? engine_name() : "",
+           count, seed, first, jobs);
+    fflush(stdout);
+    uint64_t start = now_ns();
+    // Where each job is, shared so a dead job's case is known
+    volatile fuzz_job* progress = mmap(NULL, jobs * sizeof(fuzz_job), PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(progress == MAP_FAILED){
+        perror("mmap");
+        return 1;
+    }
+    uint64_t end = first + count;
+    pid_t pids[FUZZ_MAX_JOBS];
+    uint32_t running = 0;
+    for(uint32_t job = 0; job < jobs; job++){
+        pids[job] = fuzz_fork(seed, first + job, end, jobs, &progress[job]);
+        if(pids[job] == -1){
+            return 1;
+        }
+        running++;
+    }
+
+    uint64_t ran = 0, fails = 0;
+    while(running){
+        int status;
+        pid_t pid = wait(&status);
+        if(pid == -1){
+            perror("wait");
+            return 1;
+        }
+        uint32_t job = 0;
+        while(job < jobs && pids[job] != pid){
+            job++;
+        }
+        if(job == jobs){
+            continue;
+        }
+        volatile fuzz_job* at = &progress[job];
+        if(WIFEXITED(status) && WEXITSTATUS(status) == 0){
+            running--;
+            continue;
+        }
+        // A case took the process down, a failure in itself; the job goes on past it
+        printf("case %" PRIu64 " of seed %" PRIu64 " took job %u down (%s %d), replay with `./fuzz 1 %"
+               PRIu64 " 1 %" PRIu64 "`\n", at->at, seed, job, WIFSIGNALED(status) ? "signal" : "exit",
+               WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status), seed, at->at);
+        fflush(stdout);
+        at->ran++;
+        at->fails++;
+        if(at->at + jobs < end && at->fails < FUZZ_MAX_FAILS){
+            pids[job] = fuzz_fork(seed, at->at + jobs, end, jobs, at);
+            if(pids[job] == -1){
+                return 1;
+            }
+        } else {
+            running--;
+        }
+    }
+    for(uint32_t job = 0; job < jobs; job++){
+        ran += progress[job].ran;
+        fails += progress[job].fails;
+    }
+    double secs = (now_ns() - start) / 1e9;
+    printf("%" PRIu64 " cases, %" PRIu64 " failed, %.2fs (%.1fM cases/min)\n",
+           ran, fails, secs, ran / secs * 60 / 1e6);
+    munmap((void*)progress, jobs * sizeof(fuzz_job));
+    free(fuzz_noise);
+    return fails ? 1 : 0;
+}
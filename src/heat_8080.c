@@ -0,0 +1,100 @@
+/**
+ * @file heat_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Guest memory access heatmap dump, see heat_8080.h
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "heat_8080.h"
+
+/** Offset of the frame count in the dump */
+#define HEAT_FRAMES_AT  (sizeof(HEAT_MAGIC) - 1 + sizeof(uint32_t))
+
+/**
+ * @brief Writes val little endian in bytes bytes
+ *
+ * @param out
+ * @param val
+ * @param bytes
+ */
+static void heat_put(FILE* out, uint32_t val, uint32_t bytes){
+    for(uint32_t i = 0; i < bytes; i++){
+        fputc((val >> (i * 8)) & 0xFF, out);
+    }
+}
+
+/**
+ * @brief Writes val as LEB128, 7 bits a byte, low first
+ *
+ * @param out
+ * @param val
+ */
+static void heat_put_var(FILE* out, uint32_t val){
+    while(val >= 0x80){
+        fputc((val & 0x7F) | 0x80, out);
+        val >>= 7;
+    }
+    fputc(val, out);
+}
+
+heat_map* heat_open(const char* path){
+    heat_map* heat = calloc(1, sizeof(heat_map));
+    if(!heat){
+        return NULL;
+    }
+    heat->out = fopen(path, "wb");
+    if(!heat->out){
+        free(heat);
+        return NULL;
+    }
+    fwrite(HEAT_MAGIC, 1, sizeof(HEAT_MAGIC) - 1, heat->out);
+    heat_put(heat->out, HEAT_VERSION, sizeof(uint32_t));
+    heat_put(heat->out, 0, sizeof(uint32_t));
+    return heat;
+}
+
+void heat_frame(heat_map* heat){
+    heat_put(heat->out, heat->touched_count, sizeof(uint32_t));
+    for(uint32_t i = 0; i < heat->touched_count; i++){
+        uint16_t addr = heat->touched[i];
+        uint32_t* counts = heat->counts[addr];
+        uint8_t mask = 0;
+        for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+            mask |= (counts[kind] != 0) << kind;
+        }
+        heat_put(heat->out, addr, sizeof(uint16_t));
+        fputc(mask, heat->out);
+        for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+            if(counts[kind]){
+                heat_put_var(heat->out, counts[kind]);
+            }
+        }
+        memset(counts, 0, sizeof(heat->counts[addr]));
+    }
+    heat->touched_count = 0;
+    heat->frames++;
+}
+
+int heat_close(heat_map* heat){
+    if(heat->touched_count){
+        heat_frame(heat);
+    }
+    int ret = 0;
+    if(fseek(heat->out, HEAT_FRAMES_AT, SEEK_SET) == 0){
+        heat_put(heat->out, heat->frames, sizeof(uint32_t));
+    } else {
+        ret = -1;
+    }
+    if(ferror(heat->out)){
+        ret = -1;
+    }
+    if(fclose(heat->out)){
+        ret = -1;
+    }
+    free(heat);
+    return ret;
+}
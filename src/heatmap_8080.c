@@ -0,0 +1,542 @@
+/**
+ * @file heatmap_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Renderer behind `make heat`. Reads a heat_8080.h dump and writes
+ * a 64K heatmap of it (a PPM, a pixel per address, a row per page: red
+ * writes, green fetches, blue reads, each on a log scale), and prints the
+ * traffic per invaders memory region, frame by frame, and the hottest
+ * addresses and routines. Addresses are named off the ROM's disassembly:
+ * CALL targets are sub_, jump targets loc_ and addresses the code loads,
+ * stores or points at are var_.
+ * usage: heatmap_8080 <heat dump> <disassembly> <heatmap.ppm> [top]
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include "heat_8080.h"
+#include "vram_8080.h"
+
+#define HEATMAP_SCALE   3           /** Pixels a side per address */
+#define HEATMAP_TOP     20          /** Rows of each top table by default */
+#define ROM_END         0x2000      /** Invaders ROM is 0x0000-0x1FFF */
+#define RAM_MASK        0x3FFF      /** A14/A15 aren't decoded */
+#define VAR_REACH       0x10        /** Bytes past a var_ still named after it */
+#define TEXT_SIZE       40
+
+#define SYM_SUB         0x1         /** CALL or RST target */
+#define SYM_LOC         0x2         /** Jump target */
+#define SYM_VAR         0x4         /** Loaded, stored or pointed at */
+
+/**
+ * @brief Invaders memory regions the traffic is summed over
+ */
+enum {
+    REGION_ROM,
+    REGION_RAM,
+    REGION_STACK,
+    REGION_VRAM,
+    REGION_MIRROR,
+    REGIONS
+};
+static const char* const region_name[REGIONS] = {"rom", "work ram", "stack", "vram", "mirrors"};
+
+/**
+ * @brief What the disassembly says about the ROM
+ */
+typedef struct {
+    uint8_t sym[ROM_END * 2];           /**< SYM_ flags by address, RAM included */
+    uint32_t refs[ROM_END * 2];         /**< Instructions referencing each address */
+    uint16_t first_ref[ROM_END * 2];    /**< The first of them */
+    uint16_t start[ROM_END];            /**< Instruction each ROM byte is part of */
+    char text[ROM_END][TEXT_SIZE];      /**< Each instruction, by its first byte */
+    uint16_t stack_top;                 /**< Of its first `lxi sp` into RAM, 0 if none */
+} disassembly;
+
+/**
+ * @brief The dump, totalled
+ */
+typedef struct {
+    uint64_t counts[HEAT_ADDRS][HEAT_KINDS];
+    uint32_t frames;
+    uint64_t region[REGIONS][HEAT_KINDS];       /**< Over every frame */
+    uint64_t region_peak[REGIONS][HEAT_KINDS];  /**< In the busiest frame for it */
+    uint32_t busiest;                           /**< Frame with the most accesses */
+    uint64_t busiest_count;
+    uint64_t touched;                           /**< Addresses touched, summed over frames */
+} heat_totals;
+
+static disassembly dis;
+static heat_totals totals;
+
+/**
+ * @brief Region of an address
+ *
+ * @param addr
+ * @return uint32_t REGION_
+ */
+static uint32_t region_of(uint32_t addr){
+    if(addr > RAM_MASK){
+        return REGION_MIRROR;
+    }
+    if(addr < ROM_END){
+        return REGION_ROM;
+    }
+    if(addr >= VRAM_OFFSET){
+        return REGION_VRAM;
+    }
+    if(dis.stack_top && addr < dis.stack_top && addr >= (uint32_t)dis.stack_top - 0x100 && !(dis.sym[addr] & SYM_VAR)){
+        return REGION_STACK;
+    }
+    return REGION_RAM;
+}
+
+/**
+ * @brief Reads a little endian value of bytes bytes
+ *
+ * @param in
+ * @param bytes
+ * @param val
+ * @return int 0 on success, -1 at the end of the file
+ */
+static int get_le(FILE* in, uint32_t bytes, uint32_t* val){
+    *val = 0;
+    for(uint32_t i = 0; i < bytes; i++){
+        int c = fgetc(in);
+        if(c == EOF){
+            return -1;
+        }
+        *val |= (uint32_t)c << (i * 8);
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads a LEB128 value
+ *
+ * @param in
+ * @param val
+ * @return int 0 on success, -1 at the end of the file
+ */
+static int get_var(FILE* in, uint32_t* val){
+    *val = 0;
+    for(uint32_t shift = 0; shift < 35; shift += 7){
+        int c = fgetc(in);
+        if(c == EOF){
+            return -1;
+        }
+        *val |= (uint32_t)(c & 0x7F) << shift;
+        if(!(c & 0x80)){
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Totals the dump at path
+ *
+ * @param path
+ * @return int 0 on success, -1 if it isn't one
+ */
+static int load_heat(const char* path){
+    FILE* in = fopen(path, "rb");
+    if(!in){
+        fprintf(stderr, "can't read %s\n", path);
+        return -1;
+    }
+    char magic[sizeof(HEAT_MAGIC) - 1];
+    uint32_t version, frames;
+    if(fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, HEAT_MAGIC, sizeof(magic)) ||
+       get_le(in, sizeof(uint32_t), &version) || version != HEAT_VERSION || get_le(in, sizeof(uint32_t), &frames)){
+        fprintf(stderr, "%s isn't a version %u heat dump\n", path, HEAT_VERSION);
+        fclose(in);
+        return -1;
+    }
+    for(uint32_t frame = 0; frame < frames; frame++){
+        uint32_t records;
+        uint64_t frame_region[REGIONS][HEAT_KINDS] = {{0}};
+        uint64_t frame_count = 0;
+        if(get_le(in, sizeof(uint32_t), &records)){
+            break;
+        }
+        for(uint32_t r = 0; r < records; r++){
+            uint32_t addr, mask;
+            if(get_le(in, sizeof(uint16_t), &addr) || get_le(in, 1, &mask)){
+                fprintf(stderr, "%s ends in frame %u\n", path, frame);
+                fclose(in);
+                return -1;
+            }
+            for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+                uint32_t count = 0;
+                if((mask & (1 << kind)) && get_var(in, &count)){
+                    fprintf(stderr, "%s ends in frame %u\n", path, frame);
+                    fclose(in);
+                    return -1;
+                }
+                totals.counts[addr][kind] += count;
+                frame_region[region_of(addr)][kind] += count;
+                frame_count += count;
+            }
+        }
+        for(uint32_t region = 0; region < REGIONS; region++){
+            for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+                totals.region[region][kind] += frame_region[region][kind];
+                if(frame_region[region][kind] > totals.region_peak[region][kind]){
+                    totals.region_peak[region][kind] = frame_region[region][kind];
+                }
+            }
+        }
+        if(frame_count > totals.busiest_count){
+            totals.busiest_count = frame_count;
+            totals.busiest = frame;
+        }
+        totals.touched += records;
+        totals.frames++;
+    }
+    fclose(in);
+    return 0;
+}
+
+/**
+ * @brief Parses `$XXXX` out of an operand, if it has one
+ *
+ * @param operands
+ * @param addr
+ * @return int 1 if found
+ */
+static int operand_addr(const char* operands, uint32_t* addr){
+    const char* at = strchr(operands, '$');
+    if(!at){
+        return 0;
+    }
+    char* end;
+    *addr = strtoul(at + 1, &end, 16);
+    return end - at == 5;
+}
+
+/**
+ * @brief Reads the disassembly's "AAAA  BB BB BB  mnemonic operands"
+ * lines into dis
+ *
+ * @param path
+ * @return int 0 on success, -1 if it can't be read
+ */
+static int load_disassembly(const char* path){
+    FILE* in = fopen(path, "r");
+    if(!in){
+        fprintf(stderr, "can't read %s\n", path);
+        return -1;
+    }
+    // Reset and the RST 1/RST 2 interrupt handlers
+    dis.sym[0x00] = dis.sym[0x08] = dis.sym[0x10] = SYM_SUB;
+    char line[256];
+    while(fgets(line, sizeof(line), in)){
+        char* end;
+        uint32_t addr = strtoul(line, &end, 16);
+        if(end - line != 4 || addr >= ROM_END){
+            continue;
+        }
+        // Two spaces part the address, the bytes and the instruction
+        char* text = strstr(end + 2, "  ");
+        if(!text){
+            continue;
+        }
+        uint32_t size = 0;
+        for(char* byte = end + 2; byte < text; byte += 3){
+            size++;
+        }
+        while(*text == ' '){
+            text++;
+        }
+        text[strcspn(text, ";\r\n")] = '\0';
+        for(size_t len = strlen(text); len && text[len - 1] == ' '; len--){
+            text[len - 1] = '\0';
+        }
+        if(!size || !strcmp(text, "org") || !strncmp(text, "org ", 4)){
+            continue;
+        }
+        snprintf(dis.text[addr], TEXT_SIZE, "%s", text);
+        for(uint32_t i = 0; i < size && addr + i < ROM_END; i++){
+            dis.start[addr + i] = addr;
+        }
+
+        uint32_t target;
+        if(!operand_addr(text, &target) || target >= ROM_END * 2){
+            continue;
+        }
+        char mnemonic[8] = {0};
+        sscanf(text, "%7s", mnemonic);
+        uint8_t is_call = mnemonic[0] == 'c' && strcmp(mnemonic, "cpi") && strcmp(mnemonic, "cma") &&
+                          strcmp(mnemonic, "cmc") && strcmp(mnemonic, "cmp");
+        uint8_t is_jump = mnemonic[0] == 'j';
+        dis.sym[target] |= is_call ? SYM_SUB : is_jump ? SYM_LOC : SYM_VAR;
+        if(!is_call && !is_jump){
+            if(!dis.refs[target]++){
+                dis.first_ref[target] = addr;
+            }
+            // The first stack set up in RAM, bytes of data past the code disassemble to others
+            if((!strncmp(text, "lxi     sp", 10) || !strncmp(text, "lxi sp", 6)) && !dis.stack_top &&
+               target > ROM_END && target <= VRAM_OFFSET){
+                dis.stack_top = target;
+                dis.sym[target] &= ~SYM_VAR;
+                dis.refs[target]--;
+            }
+        }
+    }
+    fclose(in);
+    return 0;
+}
+
+/**
+ * @brief The routine a ROM address belongs to, the nearest sub_ below it
+ *
+ * @param addr
+ * @return uint32_t
+ */
+static uint32_t routine_of(uint32_t addr){
+    while(addr && !(dis.sym[addr] & SYM_SUB)){
+        addr--;
+    }
+    return addr;
+}
+
+/**
+ * @brief Names a ROM address as sub_XXXX+offset
+ *
+ * @param addr
+ * @param name
+ * @param size
+ */
+static void name_code(uint32_t addr, char* name, size_t size){
+    uint32_t routine = routine_of(addr);
+    if(addr == routine){
+        snprintf(name, size, "sub_%04X", routine);
+    } else {
+        snprintf(name, size, "sub_%04X+%X", routine, addr - routine);
+    }
+}
+
+/**
+ * @brief Describes what an address is, off the disassembly
+ *
+ * @param addr
+ * @param note
+ * @param size
+ */
+static void annotate(uint32_t addr, char* note, size_t size){
+    char where[48] = "";
+    if(addr > RAM_MASK){
+        snprintf(where, sizeof(where), "mirror of %04X, ", addr & RAM_MASK);
+        addr &= RAM_MASK;
+    }
+    char name[32];
+    if(addr < ROM_END){
+        uint32_t start = dis.start[addr];
+        name_code(start, name, sizeof(name));
+        snprintf(note, size, "%s%s%s: %s", where, name, start == addr ? "" : " operand", dis.text[start]);
+        return;
+    }
+    if(addr >= VRAM_OFFSET){
+        uint32_t at = addr - VRAM_OFFSET;
+        snprintf(note, size, "%svram line %u, pixels %u-%u up", where, at / VRAM_LINE_SIZE,
+                 at % VRAM_LINE_SIZE * 8, at % VRAM_LINE_SIZE * 8 + 7);
+        return;
+    }
+    if(region_of(addr) == REGION_STACK){
+        snprintf(note, size, "%sstack, top-%u", where, dis.stack_top - addr);
+        return;
+    }
+    uint32_t var = addr;
+    while(var > ROM_END && addr - var < VAR_REACH && !(dis.sym[var] & SYM_VAR)){
+        var--;
+    }
+    if(!(dis.sym[var] & SYM_VAR)){
+        snprintf(note, size, "%swork ram", where);
+        return;
+    }
+    name_code(dis.first_ref[var], name, sizeof(name));
+    if(var == addr){
+        snprintf(note, size, "%svar_%04X, %u refs, first %s: %s", where, var, dis.refs[var], name,
+                 dis.text[dis.first_ref[var]]);
+    } else {
+        snprintf(note, size, "%svar_%04X+%X", where, var, addr - var);
+    }
+}
+
+/**
+ * @brief Writes the heatmap, a pixel per address scaled up
+ *
+ * @param path
+ * @return int 0 on success, -1 if it can't be written
+ */
+static int write_heatmap(const char* path){
+    FILE* out = fopen(path, "wb");
+    if(!out){
+        fprintf(stderr, "can't write %s\n", path);
+        return -1;
+    }
+    double top[HEAT_KINDS] = {0};
+    for(uint32_t addr = 0; addr < HEAT_ADDRS; addr++){
+        for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+            double level = log1p((double)totals.counts[addr][kind]);
+            top[kind] = level > top[kind] ? level : top[kind];
+        }
+    }
+    // Red writes, green fetches, blue reads
+    static const uint32_t channel[HEAT_KINDS] = {[HEAT_READ] = 2, [HEAT_WRITE] = 0, [HEAT_EXEC] = 1};
+    uint32_t side = 0x100 * HEATMAP_SCALE;
+    fprintf(out, "P6\n%u %u\n255\n", side, side);
+    uint8_t row[0x100 * HEATMAP_SCALE * 3];
+    for(uint32_t page = 0; page < 0x100; page++){
+        for(uint32_t low = 0; low < 0x100; low++){
+            uint8_t rgb[3] = {0};
+            for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+                if(top[kind] > 0){
+                    rgb[channel[kind]] = 255 * log1p((double)totals.counts[page << 8 | low][kind]) / top[kind];
+                }
+            }
+            for(uint32_t x = 0; x < HEATMAP_SCALE; x++){
+                memcpy(&row[(low * HEATMAP_SCALE + x) * 3], rgb, 3);
+            }
+        }
+        for(uint32_t y = 0; y < HEATMAP_SCALE; y++){
+            fwrite(row, 1, sizeof(row), out);
+        }
+    }
+    return fclose(out) ? -1 : 0;
+}
+
+/**
+ * @brief Prints each region's traffic, per frame on average and at the
+ * frame busiest for it
+ */
+static void print_regions(){
+    static const char* const kind_name[HEAT_KINDS] = {"reads", "writes", "fetches"};
+    printf("%u frames, %.0f addresses touched a frame, the busiest frame %u with %" PRIu64 " accesses\n\n",
+           totals.frames, (double)totals.touched / totals.frames, totals.busiest, totals.busiest_count);
+    printf("%-9s", "per frame");
+    for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+        printf(" %12s %8s", kind_name[kind], "peak");
+    }
+    printf("\n");
+    for(uint32_t region = 0; region < REGIONS; region++){
+        printf("%-9s", region_name[region]);
+        for(uint32_t kind = 0; kind < HEAT_KINDS; kind++){
+            printf(" %12.1f %8" PRIu64, (double)totals.region[region][kind] / totals.frames,
+                   totals.region_peak[region][kind]);
+        }
+        printf("\n");
+    }
+}
+
+/** Kind top_order sorts by */
+static uint32_t sort_kind;
+
+/**
+ * @brief qsort order, most counted first, then by address
+ */
+static int top_order(const void* a, const void* b){
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    uint64_t cx = totals.counts[x][sort_kind], cy = totals.counts[y][sort_kind];
+    return cx != cy ? (cx < cy ? 1 : -1) : (x > y) - (x < y);
+}
+
+/**
+ * @brief Prints the top addresses of a kind
+ *
+ * @param kind
+ * @param title
+ * @param top rows
+ */
+static void print_top(uint32_t kind, const char* title, uint32_t top){
+    static uint32_t order[HEAT_ADDRS];
+    uint64_t sum = 0;
+    for(uint32_t addr = 0; addr < HEAT_ADDRS; addr++){
+        order[addr] = addr;
+        sum += totals.counts[addr][kind];
+    }
+    sort_kind = kind;
+    qsort(order, HEAT_ADDRS, sizeof(order[0]), top_order);
+    printf("\ntop %u %s, %.1f a frame\n", top, title, (double)sum / totals.frames);
+    for(uint32_t i = 0; i < top && totals.counts[order[i]][kind]; i++){
+        char note[128];
+        annotate(order[i], note, sizeof(note));
+        printf("%4u  %04X %10.1f/frame %5.1f%%  %s\n", i + 1, order[i],
+               (double)totals.counts[order[i]][kind] / totals.frames,
+               100.0 * totals.counts[order[i]][kind] / sum, note);
+    }
+}
+
+/**
+ * @brief Prints the routines the most instruction bytes were fetched in,
+ * the candidates for HLE
+ *
+ * @param top rows
+ */
+static void print_routines(uint32_t top){
+    static uint64_t fetched[ROM_END];
+    static uint32_t order[ROM_END];
+    uint64_t sum = 0;
+    for(uint32_t addr = 0; addr < HEAT_ADDRS; addr++){
+        if((addr & RAM_MASK) < ROM_END){
+            fetched[routine_of(addr & RAM_MASK)] += totals.counts[addr][HEAT_EXEC];
+            sum += totals.counts[addr][HEAT_EXEC];
+        }
+    }
+    uint32_t count = 0;
+    for(uint32_t addr = 0; addr < ROM_END; addr++){
+        if(fetched[addr]){
+            order[count++] = addr;
+        }
+    }
+    // Few enough to insertion sort
+    for(uint32_t i = 1; i < count; i++){
+        uint32_t at = order[i], j = i;
+        for(; j && fetched[order[j - 1]] < fetched[at]; j--){
+            order[j] = order[j - 1];
+        }
+        order[j] = at;
+    }
+    printf("\ntop %u routines by bytes fetched\n", top);
+    for(uint32_t i = 0; i < top && i < count; i++){
+        printf("%4u  sub_%04X %10.1f/frame %5.1f%%  %s\n", i + 1, order[i], (double)fetched[order[i]] / totals.frames,
+               100.0 * fetched[order[i]] / sum, dis.text[dis.start[order[i]]]);
+    }
+}
+
+/**
+ * @brief heatmap_8080 driver.
+ * usage: heatmap_8080 <heat dump> <disassembly> <heatmap.ppm> [top]
+ *
+ * @return int 0 if success, else error code
+ */
+int main(int argc, char** argv){
+    if(argc < 4){
+        fprintf(stderr, "usage: %s <heat dump> <disassembly> <heatmap.ppm> [top]\n", argv[0]);
+        return -1;
+    }
+    uint32_t top = argc > 4 ? strtoul(argv[4], NULL, 0) : HEATMAP_TOP;
+    if(load_disassembly(argv[2]) || load_heat(argv[1])){
+        return -1;
+    }
+    if(!totals.frames){
+        fprintf(stderr, "%s has no frames\n", argv[1]);
+        return -1;
+    }
+    if(write_heatmap(argv[3])){
+        return -1;
+    }
+    printf("heatmap: %s, a row per page, red writes, green fetches, blue reads\n", argv[3]);
+    print_regions();
+    print_top(HEAT_READ, "addresses read", top);
+    print_top(HEAT_WRITE, "addresses written", top);
+    print_top(HEAT_EXEC, "addresses fetched", top);
+    print_routines(top);
+    return 0;
+}
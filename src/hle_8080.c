@@ -0,0 +1,754 @@
+/**
+ * @file hle_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief High level emulation of the invaders ROM's sprite, block copy
+ * and screen clearing routines. Each one is C doing exactly what the
+ * guest code would from its entry: the same memory writes (stack
+ * included), the same IN/OUT calls on the shift hardware, and the same
+ * registers, flags, cycles and instruction counts. The cycle costs are
+ * summed off the ROM image with opcode_cycles, so they follow the
+ * interpreter's table. Loops stop on their head before target, the
+ * guest code takes it from there, so a slice ends where it would have.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+
+#define HLE_ROM_SIZE    0x2000                  /** invaders.h, g, f and e */
+#define HLE_ROM_HASH    0xA02B653391170906ull   /** FNV-1a 64 of the ROM the routines were written against */
+#define HLE_MAX_SPANS   3                       /** Code ranges a routine runs through */
+
+/**
+ * @brief Cycles and instructions some stretch of guest code is charged
+ */
+typedef struct {
+    uint32_t cycles;
+    uint32_t instructions;
+} hle_cost;
+
+/**
+ * @brief A routine run natively
+ */
+typedef struct {
+    uint16_t entry;
+    uint8_t bit;        /**< HLE_* */
+    const char* name;   /**< Label in assets/text_disass.txt terms */
+    int (*run)(cpu_state* cpu, uint64_t target);
+    uint16_t spans[HLE_MAX_SPANS][2];  /**< [from, to) the code it stands in for, checked before each run */
+} hle_routine;
+
+/**
+ * @brief Costs of the pieces the routines are made of, off hle_image
+ */
+static struct {
+    hle_cost cnvt_pix;      /**< CALL CnvtPixNumber through ConvToScr's RET */
+    hle_cost nop;
+    hle_cost ret;
+    hle_cost shifted_row;   /**< DrawShiftedSprite loop pass */
+    hle_cost erase_row;     /**< EraseSimpleSprite loop pass */
+    hle_cost simple_row;    /**< DrawSimpleSprite loop pass */
+    hle_cost unshift_row;   /**< EraseShifted loop pass */
+    hle_cost collide_pre;   /**< DrawSprCollision's XRA A; STA 2061 */
+    hle_cost collide_row;   /**< DrawSprCollision loop pass, both MVI; STA taken */
+    hle_cost collide_hit;   /**< One MVI A,1; STA 2061 */
+    hle_cost small_row;     /**< ClearSmallSprite loop pass */
+    hle_cost xra;
+    hle_cost copy_row;      /**< BlockCopy loop pass */
+    hle_cost clear_pre;     /**< ClearScreen's LXI H,2400 */
+    hle_cost clear_row;     /**< ClearScreen loop pass */
+} hle_costs;
+
+/** The verified ROM, copied in on the first hle_enable that matched */
+static uint8_t hle_image[HLE_ROM_SIZE];
+static uint8_t hle_image_ready;
+
+///@{
+/** Guest memory and IO, through the same paths as the interpreter */
+#define RD8(addr)       mem_read(&cpu->mem, (addr))
+#define WR8(addr, val)  mem_write(&cpu->mem, (addr), (val))
+#define IN(port)        cpu->IN_Func(port)
+#define OUT(port, val)  cpu->OUT_Func((port), (val))
+///@}
+
+/**
+ * @brief Sums the straight line code in [from, to) of hle_image
+ *
+ * @param from
+ * @param to
+ * @return hle_cost
+ */
+static hle_cost hle_span(uint16_t from, uint16_t to){
+    hle_cost cost = {0, 0};
+    for(uint16_t pc = from; pc < to; pc += opcode_size(hle_image[pc])){
+        cost.cycles += opcode_cycles(hle_image[pc]);
+        cost.instructions++;
+    }
+    return cost;
+}
+
+/**
+ * @brief a + times * b
+ *
+ * @param a
+ * @param b
+ * @param times
+ * @return hle_cost
+ */
+static hle_cost hle_add(hle_cost a, hle_cost b, uint32_t times){
+    a.cycles += times * b.cycles;
+    a.instructions += times * b.instructions;
+    return a;
+}
+
+/**
+ * @brief Fills hle_costs in off hle_image
+ */
+static void hle_costs_init(){
+    // CALL 1474: MOV A,L; ANI 07; OUT 02; JMP 1A47, then ConvToScr's
+    // PUSH B; MVI B,03, its loop 3 times and MOV A,H .. RET
+    hle_cost cnvt = hle_add(hle_span(0x1401, 0x1404), hle_span(0x1474, 0x147C), 1);
+    cnvt = hle_add(cnvt, hle_span(0x1A47, 0x1A4A), 1);
+    cnvt = hle_add(cnvt, hle_span(0x1A4A, 0x1A54), 3);
+    hle_costs.cnvt_pix = hle_add(cnvt, hle_span(0x1A54, 0x1A5C), 1);
+    hle_costs.nop = hle_span(0x1400, 0x1401);
+    hle_costs.ret = hle_span(0x1421, 0x1422);
+    hle_costs.shifted_row = hle_span(0x1405, 0x1421);
+    hle_costs.erase_row = hle_span(0x1427, 0x1438);
+    hle_costs.simple_row = hle_span(0x1439, 0x1446);
+    hle_costs.unshift_row = hle_span(0x1455, 0x1473);
+    hle_costs.collide_pre = hle_span(0x1494, 0x1498);
+    hle_costs.collide_row = hle_span(0x1498, 0x14CA);
+    hle_costs.collide_hit = hle_span(0x14A4, 0x14A9);
+    hle_costs.small_row = hle_span(0x14CC, 0x14D7);
+    hle_costs.xra = hle_span(0x14CB, 0x14CC);
+    hle_costs.copy_row = hle_span(0x1A32, 0x1A3A);
+    hle_costs.clear_pre = hle_span(0x1A5C, 0x1A5F);
+    hle_costs.clear_row = hle_span(0x1A5F, 0x1A68);
+}
+
+/**
+ * @brief Charges a piece of code run natively
+ *
+ * @param cpu
+ * @param cost
+ */
+static inline void hle_charge(cpu_state* cpu, hle_cost cost){
+    cpu->cycles += cost.cycles;
+    cpu->instructions += cost.instructions;
+    cpu->skipped_instructions += cost.instructions;
+    cpu->hle_cycles += cost.cycles;
+}
+
+/**
+ * @brief Whether the next pass of cost still ends before target, in
+ * which case the guest code would have run all of it too
+ *
+ * @param cpu
+ * @param cost
+ * @param target
+ * @return int
+ */
+static inline int hle_fits(const cpu_state* cpu, hle_cost cost, uint64_t target){
+    return cpu->cycles + cost.cycles < target;
+}
+
+///@{
+/** Stack traffic, as PUSH and POP leave it */
+static inline void hle_push(cpu_state* cpu, uint16_t val){
+    cpu->SP -= 2;
+    short_mem_write(&cpu->mem, cpu->SP, val);
+}
+static inline uint16_t hle_pop(cpu_state* cpu){
+    uint16_t val = short_mem_read(&cpu->mem, cpu->SP);
+    cpu->SP += 2;
+    return val;
+}
+///@}
+
+/**
+ * @brief RET closing the routine
+ *
+ * @param cpu
+ */
+static inline void hle_ret(cpu_state* cpu){
+    hle_charge(cpu, hle_costs.ret);
+    cpu->PC = hle_pop(cpu);
+}
+
+/**
+ * @brief XRA A
+ *
+ * @param cpu
+ */
+static inline void hle_xra_a(cpu_state* cpu){
+    cpu->ACC = 0;
+    psw_set_szp(&cpu->PSW, 0);
+    psw_set_cy_res(&cpu->PSW, 0);
+    psw_set_aux(&cpu->PSW, 0);
+}
+
+/**
+ * @brief LXI B,0020; DAD B; POP B; DCR B which end every row loop, HL
+ * having been restored by the caller
+ *
+ * @param cpu
+ * @return uint8_t B, the JNZ goes round again while non zero
+ */
+static inline uint8_t hle_next_row(cpu_state* cpu){
+    uint32_t sum = (uint32_t)cpu->HL + 0x20;
+    cpu->HL = sum;
+    psw_set_cy_res(&cpu->PSW, sum >> 8);
+    cpu->BC = hle_pop(cpu);
+    uint8_t b = cpu->B--;
+    psw_set_szp(&cpu->PSW, cpu->B);
+    psw_set_aux_add(&cpu->PSW, b, 0xFF);
+    return cpu->B;
+}
+
+/**
+ * @brief CALL CnvtPixNumber (0x1474) and its tail jump into ConvToScr
+ * (0x1A47): the shift amount goes out on port 2 off L, and HL becomes
+ * the screen address of the pixel position it held
+ *
+ * @param cpu
+ * @param ret address the CALL pushes
+ */
+static void hle_cnvt_pix(cpu_state* cpu, uint16_t ret){
+    // CALL 1474; MOV A,L; ANI 07; OUT 02
+    hle_push(cpu, ret);
+    OUT(2, cpu->L & 0x07);
+    // PUSH B; MVI B,03; 3 x (MOV A,H; RAR; MOV H,A; MOV A,L; RAR; MOV L,A; DCR B)
+    // rotates CY:H:L right, ANI left CY clear. The flags are all
+    // overwritten by the ORI below.
+    hle_push(cpu, cpu->BC);
+    uint8_t carry = 0;
+    for(uint8_t i = 0; i < 3; i++){
+        uint8_t out = cpu->H & 1;
+        cpu->H = (cpu->H >> 1) | (carry << 7);
+        carry = out;
+        out = cpu->L & 1;
+        cpu->L = (cpu->L >> 1) | (carry << 7);
+        carry = out;
+    }
+    // MOV A,H; ANI 3F; ORI 20; MOV H,A; POP B; RET
+    cpu->H = (cpu->H & 0x3F) | 0x20;
+    cpu->ACC = cpu->H;
+    psw_set_szp(&cpu->PSW, cpu->ACC);
+    psw_set_cy_res(&cpu->PSW, cpu->ACC);
+    psw_set_aux(&cpu->PSW, 0);
+    cpu->BC = hle_pop(cpu);
+    hle_pop(cpu);
+}
+
+/**
+ * @brief Rows of DrawShiftedSprite (0x1405) or EraseShifted (0x1455):
+ * each sprite byte goes through the shift hardware and is ORed into, or
+ * its complement ANDed with, the two screen bytes it straddles
+ *
+ * @param cpu
+ * @param target
+ * @param erase 1 for EraseShifted
+ * @return int 1
+ */
+static int hle_shifted_rows(cpu_state* cpu, uint64_t target, uint8_t erase){
+    hle_cost row = erase ? hle_costs.unshift_row : hle_costs.shifted_row;
+    while(hle_fits(cpu, row, target)){
+        hle_charge(cpu, row);
+        // PUSH B; PUSH H; LDAX D; OUT 04; IN 03; [CMA; ANA M | ORA M]; MOV M,A; INX H; INX D
+        hle_push(cpu, cpu->BC);
+        hle_push(cpu, cpu->HL);
+        OUT(4, RD8(cpu->DE));
+        uint8_t a = IN(3);
+        a = erase ? (uint8_t)~a & RD8(cpu->HL) : a | RD8(cpu->HL);
+        WR8(cpu->HL, a);
+        cpu->HL++;
+        cpu->DE++;
+        // XRA A; OUT 04; IN 03; [CMA; ANA M | ORA M]; MOV M,A
+        OUT(4, 0);
+        a = IN(3);
+        a = erase ? (uint8_t)~a & RD8(cpu->HL) : a | RD8(cpu->HL);
+        WR8(cpu->HL, a);
+        cpu->ACC = a;
+        // POP H, the flags the ALU ops left are all overwritten
+        cpu->HL = hle_pop(cpu);
+        if(!hle_next_row(cpu)){
+            hle_ret(cpu);
+            return 1;
+        }
+    }
+    cpu->PC = erase ? 0x1455 : 0x1405;
+    return 1;
+}
+
+/**
+ * @brief 0x1400 DrawShiftedSprite: B rows of the sprite at DE, at pixel
+ * position HL
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_draw_shifted(cpu_state* cpu, uint64_t target){
+    hle_cost pre = hle_add(hle_add(hle_costs.nop, hle_costs.cnvt_pix, 1), hle_costs.nop, 1);
+    if(!hle_fits(cpu, pre, target)){
+        return 0;
+    }
+    // NOP; CALL 1474; NOP
+    hle_charge(cpu, pre);
+    hle_cnvt_pix(cpu, 0x1404);
+    return hle_shifted_rows(cpu, target, 0);
+}
+
+/**
+ * @brief 0x1452 EraseShifted: clears what DrawShiftedSprite drew
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_erase_shifted(cpu_state* cpu, uint64_t target){
+    if(!hle_fits(cpu, hle_costs.cnvt_pix, target)){
+        return 0;
+    }
+    hle_charge(cpu, hle_costs.cnvt_pix);
+    hle_cnvt_pix(cpu, 0x1455);
+    return hle_shifted_rows(cpu, target, 1);
+}
+
+/**
+ * @brief 0x1424 EraseSimpleSprite: zeroes two bytes on each of B rows
+ * at pixel position HL
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_erase_simple(cpu_state* cpu, uint64_t target){
+    if(!hle_fits(cpu, hle_costs.cnvt_pix, target)){
+        return 0;
+    }
+    hle_charge(cpu, hle_costs.cnvt_pix);
+    hle_cnvt_pix(cpu, 0x1427);
+    while(hle_fits(cpu, hle_costs.erase_row, target)){
+        hle_charge(cpu, hle_costs.erase_row);
+        // PUSH B; PUSH H; XRA A; MOV M,A; INX H; MOV M,A; INX H; POP H
+        hle_push(cpu, cpu->BC);
+        hle_push(cpu, cpu->HL);
+        hle_xra_a(cpu);
+        WR8(cpu->HL, 0);
+        WR8(cpu->HL + 1, 0);
+        cpu->HL = hle_pop(cpu);
+        if(!hle_next_row(cpu)){
+            hle_ret(cpu);
+            return 1;
+        }
+    }
+    cpu->PC = 0x1427;
+    return 1;
+}
+
+/**
+ * @brief 0x1439 DrawSimpleSprite: copies B bytes at DE down a screen
+ * column from HL. The entry is its own loop head.
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_draw_simple(cpu_state* cpu, uint64_t target){
+    if(!hle_fits(cpu, hle_costs.simple_row, target)){
+        return 0;
+    }
+    do {
+        hle_charge(cpu, hle_costs.simple_row);
+        // PUSH B; LDAX D; MOV M,A; INX D
+        hle_push(cpu, cpu->BC);
+        cpu->ACC = RD8(cpu->DE);
+        WR8(cpu->HL, cpu->ACC);
+        cpu->DE++;
+        if(!hle_next_row(cpu)){
+            hle_ret(cpu);
+            return 1;
+        }
+    } while(hle_fits(cpu, hle_costs.simple_row, target));
+    cpu->PC = 0x1439;
+    return 1;
+}
+
+/**
+ * @brief One half of a DrawSprCollision row: A through the shifter,
+ * flagging 2061 if it overlaps what's on screen, then ORed in
+ *
+ * @param cpu
+ * @param a sprite byte
+ * @return uint32_t 1 if the MVI A,1; STA 2061 was jumped over
+ */
+static inline uint32_t hle_collide_byte(cpu_state* cpu, uint8_t a){
+    // OUT 04; IN 03; PUSH PSW; ANA M; JZ
+    OUT(4, a);
+    a = IN(3);
+    hle_push(cpu, (a << 8) | compress_PSW(cpu->PSW));
+    uint8_t skipped = 1;
+    if(a & RD8(cpu->HL)){
+        // MVI A,01; STA 2061
+        WR8(0x2061, 1);
+        skipped = 0;
+    }
+    // POP PSW; ORA M; MOV M,A, the ORA sets every flag
+    a = hle_pop(cpu) >> 8;
+    a |= RD8(cpu->HL);
+    psw_set_szp(&cpu->PSW, a);
+    psw_set_cy_res(&cpu->PSW, a);
+    psw_set_aux(&cpu->PSW, 0);
+    WR8(cpu->HL, a);
+    cpu->ACC = a;
+    return skipped;
+}
+
+/**
+ * @brief 0x1491 DrawSprCollision: DrawShiftedSprite which also sets
+ * 2061 if any pixel was already lit
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_draw_collide(cpu_state* cpu, uint64_t target){
+    hle_cost pre = hle_add(hle_costs.cnvt_pix, hle_costs.collide_pre, 1);
+    if(!hle_fits(cpu, pre, target)){
+        return 0;
+    }
+    // CALL 1474; XRA A; STA 2061
+    hle_charge(cpu, pre);
+    hle_cnvt_pix(cpu, 0x1494);
+    hle_xra_a(cpu);
+    WR8(0x2061, 0);
+    while(hle_fits(cpu, hle_costs.collide_row, target)){
+        hle_charge(cpu, hle_costs.collide_row);
+        // PUSH B; PUSH H; LDAX D; ...; INX H; INX D; XRA A; ...; POP H
+        hle_push(cpu, cpu->BC);
+        hle_push(cpu, cpu->HL);
+        uint32_t skipped = hle_collide_byte(cpu, RD8(cpu->DE));
+        cpu->HL++;
+        cpu->DE++;
+        hle_xra_a(cpu);
+        skipped += hle_collide_byte(cpu, 0);
+        cpu->cycles -= skipped * hle_costs.collide_hit.cycles;
+        cpu->hle_cycles -= skipped * hle_costs.collide_hit.cycles;
+        cpu->instructions -= skipped * hle_costs.collide_hit.instructions;
+        cpu->skipped_instructions -= skipped * hle_costs.collide_hit.instructions;
+        cpu->HL = hle_pop(cpu);
+        if(!hle_next_row(cpu)){
+            hle_ret(cpu);
+            return 1;
+        }
+    }
+    cpu->PC = 0x1498;
+    return 1;
+}
+
+/**
+ * @brief 0x14CB ClearSmallSprite: zeroes B bytes down a screen column
+ * from HL
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_clear_small(cpu_state* cpu, uint64_t target){
+    if(!hle_fits(cpu, hle_costs.xra, target)){
+        return 0;
+    }
+    hle_charge(cpu, hle_costs.xra);
+    hle_xra_a(cpu);
+    while(hle_fits(cpu, hle_costs.small_row, target)){
+        hle_charge(cpu, hle_costs.small_row);
+        // PUSH B; MOV M,A
+        hle_push(cpu, cpu->BC);
+        WR8(cpu->HL, cpu->ACC);
+        if(!hle_next_row(cpu)){
+            hle_ret(cpu);
+            return 1;
+        }
+    }
+    cpu->PC = 0x14CC;
+    return 1;
+}
+
+/**
+ * @brief 0x1A32 BlockCopy: B bytes from DE to HL, upwards. The entry is
+ * its own loop head.
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_block_copy(cpu_state* cpu, uint64_t target){
+    if(!hle_fits(cpu, hle_costs.copy_row, target)){
+        return 0;
+    }
+    do {
+        // LDAX D; MOV M,A; INX H; INX D; DCR B; JNZ
+        hle_charge(cpu, hle_costs.copy_row);
+        cpu->ACC = RD8(cpu->DE);
+        WR8(cpu->HL, cpu->ACC);
+        cpu->HL++;
+        cpu->DE++;
+        uint8_t b = cpu->B--;
+        psw_set_szp(&cpu->PSW, cpu->B);
+        psw_set_aux_add(&cpu->PSW, b, 0xFF);
+        if(!cpu->B){
+            hle_ret(cpu);
+            return 1;
+        }
+    } while(hle_fits(cpu, hle_costs.copy_row, target));
+    cpu->PC = 0x1A32;
+    return 1;
+}
+
+/**
+ * @brief 0x1A5C ClearScreen: zeroes 2400 up to 4000. Takes about eight
+ * frames, so it mostly goes a slice's worth at a time.
+ *
+ * @param cpu
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_clear_screen(cpu_state* cpu, uint64_t target){
+    if(!hle_fits(cpu, hle_costs.clear_pre, target)){
+        return 0;
+    }
+    // LXI H,2400
+    hle_charge(cpu, hle_costs.clear_pre);
+    cpu->HL = 0x2400;
+    while(hle_fits(cpu, hle_costs.clear_row, target)){
+        // MVI M,00; INX H; MOV A,H; CPI 40; JNZ
+        hle_charge(cpu, hle_costs.clear_row);
+        WR8(cpu->HL, 0);
+        cpu->HL++;
+        cpu->ACC = cpu->H;
+        uint16_t diff = cpu->ACC - 0x40;
+        psw_set_szp(&cpu->PSW, diff);
+        psw_set_cy_res(&cpu->PSW, diff);
+        psw_set_aux_add(&cpu->PSW, cpu->ACC, (uint8_t)-0x40);
+        if(cpu->ACC == 0x40){
+            hle_ret(cpu);
+            return 1;
+        }
+    }
+    cpu->PC = 0x1A5F;
+    return 1;
+}
+
+/** Every routine, the spans list their own code and what they call */
+static const hle_routine hle_routines[] = {
+    {0x1400, HLE_DRAW_SHIFTED, "DrawShiftedSprite", hle_draw_shifted,
+     {{0x1400, 0x1422}, {0x1474, 0x147C}, {0x1A47, 0x1A5C}}},
+    {0x1424, HLE_ERASE_SIMPLE, "EraseSimpleSprite", hle_erase_simple,
+     {{0x1424, 0x1439}, {0x1474, 0x147C}, {0x1A47, 0x1A5C}}},
+    {0x1439, HLE_DRAW_SIMPLE, "DrawSimpleSprite", hle_draw_simple,
+     {{0x1439, 0x1447}}},
+    {0x1452, HLE_ERASE_SHIFTED, "EraseShifted", hle_erase_shifted,
+     {{0x1452, 0x1474}, {0x1474, 0x147C}, {0x1A47, 0x1A5C}}},
+    {0x1491, HLE_DRAW_COLLIDE, "DrawSprCollision", hle_draw_collide,
+     {{0x1491, 0x14CB}, {0x1474, 0x147C}, {0x1A47, 0x1A5C}}},
+    {0x14CB, HLE_CLEAR_SMALL, "ClearSmallSprite", hle_clear_small,
+     {{0x14CB, 0x14D8}}},
+    {0x1A32, HLE_BLOCK_COPY, "BlockCopy", hle_block_copy,
+     {{0x1A32, 0x1A3B}}},
+    {0x1A5C, HLE_CLEAR_SCREEN, "ClearScreen", hle_clear_screen,
+     {{0x1A5C, 0x1A69}}},
+};
+#define HLE_ROUTINES_COUNT  (sizeof(hle_routines) / sizeof(hle_routines[0]))
+
+/**
+ * @brief Whether guest memory still holds the code a routine stands in for
+ *
+ * @param cpu
+ * @param routine
+ * @return int 1 if untouched
+ */
+static int hle_code_intact(cpu_state* cpu, const hle_routine* routine){
+    for(uint32_t i = 0; i < HLE_MAX_SPANS && routine->spans[i][1]; i++){
+        uint16_t from = routine->spans[i][0];
+        if(memcmp(mem_ref(&cpu->mem, from), hle_image + from, routine->spans[i][1] - from)){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#ifdef HLE_VERIFY
+#define HLE_IO_LOG  4096    /** IN/OUT calls a routine may make */
+
+/**
+ * @brief An IN or OUT the native routine made
+ */
+typedef struct {
+    uint8_t out;    /**< 1 for OUT */
+    uint8_t port;
+    uint8_t data;   /**< Read or written */
+} hle_io;
+
+///@{
+/** IO of the routine being verified. The native run calls the real
+ * handlers and logs them, the guest run is fed the log back. */
+static hle_io hle_io_log[HLE_IO_LOG];
+static uint32_t hle_io_len;
+static uint32_t hle_io_pos;
+static uint8_t (*hle_real_in)(uint8_t);
+static void (*hle_real_out)(uint8_t, uint8_t);
+static const hle_routine* hle_verifying;
+///@}
+
+/**
+ * @brief Reports a routine which didn't match its guest code and stops
+ *
+ * @param what differed
+ */
+static void hle_mismatch(const char* what){
+    fprintf(stderr, "hle: %s (%04X) differs from the ROM's code: %s\n",
+            hle_verifying->name, hle_verifying->entry, what);
+    abort();
+}
+
+static uint8_t hle_log_in(uint8_t port){
+    uint8_t data = hle_real_in(port);
+    if(hle_io_len == HLE_IO_LOG){
+        hle_mismatch("IO log full");
+    }
+    hle_io_log[hle_io_len++] = (hle_io){0, port, data};
+    return data;
+}
+
+static void hle_log_out(uint8_t port, uint8_t data){
+    hle_real_out(port, data);
+    if(hle_io_len == HLE_IO_LOG){
+        hle_mismatch("IO log full");
+    }
+    hle_io_log[hle_io_len++] = (hle_io){1, port, data};
+}
+
+static uint8_t hle_replay_in(uint8_t port){
+    if(hle_io_pos == hle_io_len || hle_io_log[hle_io_pos].out || hle_io_log[hle_io_pos].port != port){
+        hle_mismatch("IN");
+    }
+    return hle_io_log[hle_io_pos++].data;
+}
+
+static void hle_replay_out(uint8_t port, uint8_t data){
+    if(hle_io_pos == hle_io_len || !hle_io_log[hle_io_pos].out ||
+       hle_io_log[hle_io_pos].port != port || hle_io_log[hle_io_pos].data != data){
+        hle_mismatch("OUT");
+    }
+    hle_io_pos++;
+}
+
+/**
+ * @brief Runs the routine natively on a copy of the cpu and its memory,
+ * then the guest code on the cpu for as many instructions, and checks
+ * they ended up the same. The cpu keeps the guest code's results.
+ *
+ * @param cpu
+ * @param routine
+ * @param target
+ * @return int 1 if it ran, 0 if declined
+ */
+static int hle_verify(cpu_state* cpu, const hle_routine* routine, uint64_t target){
+    static v_memory shadow_mem;
+    if(!shadow_mem.base && !mem_init(&shadow_mem)){
+        return 0;
+    }
+    mem_map_copy(&shadow_mem, &cpu->mem);
+    memcpy(shadow_mem.base, cpu->mem.base, MEM_SIZE);
+    mem_hash_reset(&shadow_mem);
+    cpu_state shadow = *cpu;
+    shadow.mem = shadow_mem;
+    shadow.IN_Func = &hle_log_in;
+    shadow.OUT_Func = &hle_log_out;
+    hle_real_in = cpu->IN_Func;
+    hle_real_out = cpu->OUT_Func;
+    hle_verifying = routine;
+    hle_io_len = 0;
+    if(!routine->run(&shadow, target)){
+        return 0;
+    }
+
+    cpu->IN_Func = &hle_replay_in;
+    cpu->OUT_Func = &hle_replay_out;
+    hle_io_pos = 0;
+    while(cpu->instructions < shadow.instructions && exec_inst(cpu) == 1){
+    }
+    cpu->IN_Func = hle_real_in;
+    cpu->OUT_Func = hle_real_out;
+
+    if(hle_io_pos != hle_io_len){
+        hle_mismatch("IO count");
+    }
+    if(cpu->BC != shadow.BC || cpu->DE != shadow.DE || cpu->HL != shadow.HL ||
+       cpu->ACC != shadow.ACC || compress_PSW(cpu->PSW) != compress_PSW(shadow.PSW) ||
+       cpu->SP != shadow.SP || cpu->PC != shadow.PC){
+        fprintf(stderr, "hle: guest BC:%04X DE:%04X HL:%04X A:%02X PSW:%02X SP:%04X PC:%04X\n",
+                cpu->BC, cpu->DE, cpu->HL, cpu->ACC, compress_PSW(cpu->PSW), cpu->SP, cpu->PC);
+        fprintf(stderr, "hle: hle   BC:%04X DE:%04X HL:%04X A:%02X PSW:%02X SP:%04X PC:%04X\n",
+                shadow.BC, shadow.DE, shadow.HL, shadow.ACC, compress_PSW(shadow.PSW), shadow.SP, shadow.PC);
+        hle_mismatch("registers");
+    }
+    if(cpu->cycles != shadow.cycles || cpu->instructions != shadow.instructions){
+        hle_mismatch("cycles");
+    }
+    if(memcmp(cpu->mem.base, shadow_mem.base, MEM_SIZE)){
+        hle_mismatch("memory");
+    }
+    cpu->hle_cycles = shadow.hle_cycles;
+    return 1;
+}
+#endif
+
+int hle_call(cpu_state* cpu, uint64_t target){
+    const hle_routine* routine = NULL;
+    for(uint32_t i = 0; i < HLE_ROUTINES_COUNT; i++){
+        if(hle_routines[i].entry == cpu->PC){
+            routine = &hle_routines[i];
+            break;
+        }
+    }
+    // Interrupts are only taken outside the routines, as in the guest code
+    if(!routine || !(cpu->hle_mask & routine->bit) || (cpu->intt && cpu->pend_intt) ||
+       !hle_code_intact(cpu, routine)){
+        return 0;
+    }
+#ifdef HLE_VERIFY
+    return hle_verify(cpu, routine, target);
+#else
+    return routine->run(cpu, target);
+#endif
+}
+
+uint8_t hle_enable(cpu_state* cpu, uint8_t mask){
+    cpu->hle_mask = 0;
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for(uint16_t addr = 0; addr < HLE_ROM_SIZE; addr++){
+        hash = (hash ^ mem_read(&cpu->mem, addr)) * 0x100000001B3ull;
+    }
+    if(hash != HLE_ROM_HASH){
+        return 0;
+    }
+    if(!hle_image_ready){
+        memcpy(hle_image, mem_ref(&cpu->mem, 0), HLE_ROM_SIZE);
+        hle_costs_init();
+        hle_image_ready = 1;
+    }
+    cpu->hle_mask = mask;
+    // Translations may have linked calls straight into the routines
+    flush_code_cache(cpu);
+    return mask;
+}
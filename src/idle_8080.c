@@ -0,0 +1,123 @@
+/**
+ * @file idle_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Idle loop fast forwarding. A short loop without stores, IO or
+ * stack traffic which comes back to its head with every register and
+ * flag as it left them is stuck until an interrupt changes memory, and
+ * interrupts only arrive between run_cycles slices. Every engine calls
+ * idle_skip on a jump back to such a head, which charges the remaining
+ * whole iterations of the slice without running them. Loops which do
+ * store are handed to loop_skip first.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+
+#define IDLE_MAX_OPS    16  /** Longest loop body tried */
+#define IDLE_MAX_MISSES 2   /** Iterations at one head which changed state before giving up on it */
+
+uint8_t idle_op_pure(uint8_t op_code){
+    switch (op_code & 0xC7)
+    {
+    case 0x02:  // STAX, SHLD, STA (LDAX, LHLD, LDA are 0x0A)
+        return op_code & 0x08;
+    case 0x04: case 0x05: case 0x06:    // INR, DCR, MVI
+        return (op_code & 0x38) != 0x30;
+    case 0xC2:  // Jcc
+        return 1;
+    case 0xC6:  // ADI..CPI
+        return 1;
+    default:
+        break;
+    }
+    if(op_code >= 0x40 && op_code < 0x80){  // MOV, not into M nor HLT
+        return (op_code & 0xF8) != 0x70;
+    }
+    if(op_code >= 0x80 && op_code < 0xC0){  // ADD..CMP
+        return 1;
+    }
+    if(op_code < 0x40){ // The rest of the first quarter only touches registers
+        return 1;
+    }
+    return op_code == 0xC3 || op_code == 0xEB;  // JMP, XCHG
+}
+
+/**
+ * @brief Runs one pass of the loop at probe->PC on the probe
+ *
+ * @param probe scratch copy of the cpu
+ * @param branch address of the jump back closing the loop
+ * @return int 1 if it came back to the head, 0 if it left, -1 if the
+ * loop isn't pure or too long
+ */
+static int idle_probe(cpu_state* probe, uint16_t branch){
+    uint16_t head = probe->PC;
+    for(uint32_t i = 0; i < IDLE_MAX_OPS; i++){
+        uint16_t pc = probe->PC;
+        uint8_t op_code = mem_read(&probe->mem, pc);
+        if(!idle_op_pure(op_code)){
+            return -1;
+        }
+        // Same steps as exec_inst, less its pair profile
+        probe->PC += opcode_size(op_code);
+        probe->cycles += opcode_cycles(op_code);
+        probe->instructions++;
+        if(opcode_func(op_code)(probe, pc, op_code) != 1){
+            return -1;
+        }
+        if(probe->PC == head){
+            return 1;
+        }
+        if((uint16_t)(probe->PC - head) > (uint16_t)(branch - head)){
+            return 0;   // Left the loop
+        }
+    }
+    return -1;
+}
+
+void idle_skip(cpu_state* cpu, uint16_t branch, uint64_t target){
+    uint16_t head = cpu->PC;
+    if(cpu->idle_reject == (0x10000u | head) || cpu->cycles >= target ||
+       (cpu->intt && cpu->pend_intt)){
+        return;
+    }
+#ifdef LOOP_IDIOMS
+    if(loop_skip(cpu, branch, target)){
+        return;
+    }
+#endif
+    if(cpu->idle_head != head){
+        cpu->idle_head = head;
+        cpu->idle_misses = 0;
+    }
+
+    cpu_state probe = *cpu;
+    int ret = idle_probe(&probe, branch);
+    if(ret == 1 && (probe.BC != cpu->BC || probe.DE != cpu->DE || probe.HL != cpu->HL ||
+                    probe.SP != cpu->SP || probe.ACC != cpu->ACC ||
+                    compress_PSW(probe.PSW) != compress_PSW(cpu->PSW))){
+        ret = 0;
+    }
+    if(ret != 1){
+        if(ret < 0 || ++cpu->idle_misses >= IDLE_MAX_MISSES){
+            cpu->idle_reject = 0x10000u | head;
+        }
+        return;
+    }
+
+    cpu->idle_misses = 0;
+    // Whole passes only, the slice still ends on the interpreter's instruction
+    uint64_t pass_cycles = probe.cycles - cpu->cycles;
+    uint64_t passes = (target - 1 - cpu->cycles) / pass_cycles;
+    cpu->cycles += passes * pass_cycles;
+    uint64_t skipped = passes * (probe.instructions - cpu->instructions);
+    cpu->instructions += skipped;
+    cpu->skipped_instructions += skipped;
+    cpu->idle_cycles += passes * pass_cycles;
+}
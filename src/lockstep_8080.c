@@ -0,0 +1,323 @@
+/**
+ * @file lockstep_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Lockstep validation of the engine against the interpreter, see
+ * lockstep_8080.h
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "lockstep_8080.h"
+
+#define LOCKSTEP_MEM_SIZE   (1<<16) /** Guest memory, 64KB aligned */
+#define LOCKSTEP_TRACE      16      /** Interpreter instructions the report shows */
+#define LOCKSTEP_IO         256     /** IN/OUT calls logged before the log grows */
+#define LOCKSTEP_MEM_DIFFS  8       /** Differing bytes the report lists */
+
+/**
+ * @brief An IN or OUT the engine made
+ */
+typedef struct {
+    uint8_t out;    /**< 1 for OUT */
+    uint8_t port;
+    uint8_t data;   /**< Read or written */
+} lockstep_io;
+
+/**
+ * @brief The shadow kept for a cpu
+ */
+typedef struct {
+    cpu_state* ref;             /**< Run by exec_inst, owns its own memory */
+    lockstep_io* io;            /**< The engine's IO over the stretch being checked */
+    uint32_t io_len;
+    uint32_t io_cap;
+    uint32_t io_pos;            /**< Next entry the interpreter is fed */
+    uint8_t io_bad;             /**< The interpreter's IO didn't follow the log */
+    uint8_t (*real_in)(uint8_t);
+    void (*real_out)(uint8_t, uint8_t);
+    uint16_t trace[LOCKSTEP_TRACE];  /**< PCs the interpreter ran, a ring */
+    uint32_t traced;            /**< Instructions put on trace since the last sync */
+} lockstep;
+
+/** IN/OUT handlers get no context, the shadow being run */
+static lockstep* lockstep_current;
+
+/**
+ * @brief Appends an entry to the IO log
+ *
+ * @param ls
+ * @param entry
+ */
+static void lockstep_log(lockstep* ls, lockstep_io entry){
+    if(ls->io_len == ls->io_cap){
+        uint32_t cap = ls->io_cap ? ls->io_cap * 2 : LOCKSTEP_IO;
+        lockstep_io* io = realloc(ls->io, cap * sizeof(lockstep_io));
+        if(!io){
+            ls->io_bad = 1;
+            return;
+        }
+        ls->io = io;
+        ls->io_cap = cap;
+    }
+    ls->io[ls->io_len++] = entry;
+}
+
+static uint8_t lockstep_log_in(uint8_t port){
+    uint8_t data = lockstep_current->real_in(port);
+    lockstep_log(lockstep_current, (lockstep_io){0, port, data});
+    return data;
+}
+
+static void lockstep_log_out(uint8_t port, uint8_t data){
+    lockstep_current->real_out(port, data);
+    lockstep_log(lockstep_current, (lockstep_io){1, port, data});
+}
+
+static uint8_t lockstep_replay_in(uint8_t port){
+    lockstep* ls = lockstep_current;
+    if(ls->io_pos == ls->io_len || ls->io[ls->io_pos].out || ls->io[ls->io_pos].port != port){
+        ls->io_bad = 1;
+        return 0;
+    }
+    return ls->io[ls->io_pos++].data;
+}
+
+static void lockstep_replay_out(uint8_t port, uint8_t data){
+    lockstep* ls = lockstep_current;
+    if(ls->io_pos == ls->io_len || !ls->io[ls->io_pos].out ||
+       ls->io[ls->io_pos].port != port || ls->io[ls->io_pos].data != data){
+        ls->io_bad = 1;
+        return;
+    }
+    ls->io_pos++;
+}
+
+void lockstep_sync(cpu_state* cpu){
+    lockstep* ls = cpu->lockstep_state;
+    if(!ls){
+        return;
+    }
+    v_memory mem = ls->ref->mem;
+    mem_map_copy(&mem, &cpu->mem);
+    memcpy(mem.base, cpu->mem.base, LOCKSTEP_MEM_SIZE);
+    mem_hash_reset(&mem);
+    *ls->ref = *cpu;
+    ls->ref->mem = mem;
+    ls->ref->engine_state = NULL;
+    ls->ref->lockstep_state = NULL;
+    ls->ref->hle_mask = 0;
+    ls->ref->IN_Func = &lockstep_replay_in;
+    ls->ref->OUT_Func = &lockstep_replay_out;
+    ls->traced = 0;
+}
+
+/**
+ * @brief Makes the cpu's shadow
+ *
+ * @param cpu
+ * @return lockstep* NULL if out of memory
+ */
+static lockstep* lockstep_init(cpu_state* cpu){
+    lockstep* ls = calloc(1, sizeof(lockstep));
+    if(!ls){
+        return NULL;
+    }
+    ls->ref = calloc(1, sizeof(cpu_state));
+    if(!ls->ref || !mem_init(&ls->ref->mem)){
+        free(ls->ref);
+        free(ls);
+        return NULL;
+    }
+    cpu->lockstep_state = ls;
+    lockstep_sync(cpu);
+    return ls;
+}
+
+void lockstep_free(cpu_state* cpu){
+    lockstep* ls = cpu->lockstep_state;
+    if(!ls){
+        return;
+    }
+    mem_free(&ls->ref->mem);
+    free(ls->ref);
+    free(ls->io);
+    free(ls);
+    cpu->lockstep_state = NULL;
+}
+
+/**
+ * @brief Runs the interpreter up to the cycle count stop, as
+ * interp_run_cycles would without its shortcuts
+ *
+ * @param ls
+ * @param stop
+ * @return int as run_cycles
+ */
+static int lockstep_reference(lockstep* ls, uint64_t stop){
+    cpu_state* ref = ls->ref;
+    while(ref->cycles < stop){
+        if(ref->halt){
+            return 0;
+        }
+        ls->trace[ls->traced++ % LOCKSTEP_TRACE] = ref->PC;
+        if(exec_inst(ref) != 1){
+            return -1;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Prints a line of the state comparison, flagged if they differ
+ *
+ * @param name
+ * @param engine
+ * @param interp
+ * @param width hex digits, 0 for a signed decimal
+ */
+static void lockstep_row(const char* name, int64_t engine, int64_t interp, int width){
+    const char* flag = engine != interp ? "  <--" : "";
+    if(width){
+        fprintf(stderr, "  %-12s %*s%0*" PRIX64 "  %*s%0*" PRIX64 "%s\n", name,
+                20 - width, "", width, (uint64_t)engine, 20 - width, "", width, (uint64_t)interp, flag);
+    } else {
+        fprintf(stderr, "  %-12s %20" PRId64 "  %20" PRId64 "%s\n", name, engine, interp, flag);
+    }
+}
+
+/**
+ * @brief Prints the instruction at pc, bytes off the interpreter's memory
+ *
+ * @param ref
+ * @param pc
+ * @param mark
+ */
+static void lockstep_inst(cpu_state* ref, uint16_t pc, const char* mark){
+    uint8_t op_code = mem_read(&ref->mem, pc);
+    fprintf(stderr, "  %s %04X:", mark, pc);
+    for(uint8_t i = 0; i < opcode_size(op_code); i++){
+        fprintf(stderr, " %02X", mem_read(&ref->mem, pc + i));
+    }
+    fprintf(stderr, "\n");
+}
+
+/**
+ * @brief Reports where the engine and the interpreter parted ways
+ *
+ * @param ls
+ * @param cpu
+ * @param from cycle count the stretch started at
+ * @param ret what the engine returned
+ * @param ref_ret what the interpreter returned
+ */
+static void lockstep_report(lockstep* ls, cpu_state* cpu, uint64_t from, int ret, int ref_ret){
+    cpu_state* ref = ls->ref;
+    fprintf(stderr, "lockstep: %s engine diverged from the interpreter between cycles %" PRIu64
+            " and %" PRIu64 "\n", engine_name(), from, ref->cycles);
+    fprintf(stderr, "  %-12s %20s  %20s\n", "", engine_name(), "interp");
+    lockstep_row("PC", cpu->PC, ref->PC, 4);
+    lockstep_row("SP", cpu->SP, ref->SP, 4);
+    lockstep_row("BC", cpu->BC, ref->BC, 4);
+    lockstep_row("DE", cpu->DE, ref->DE, 4);
+    lockstep_row("HL", cpu->HL, ref->HL, 4);
+    lockstep_row("A", cpu->ACC, ref->ACC, 2);
+    lockstep_row("PSW", compress_PSW(cpu->PSW), compress_PSW(ref->PSW), 2);
+    lockstep_row("intt", cpu->intt, ref->intt, 1);
+    lockstep_row("pend_intt", cpu->pend_intt, ref->pend_intt, 1);
+    lockstep_row("halt", cpu->halt, ref->halt, 1);
+    lockstep_row("cycles", cpu->cycles, ref->cycles, 0);
+    lockstep_row("instructions", cpu->instructions, ref->instructions, 0);
+    lockstep_row("returned", ret, ref_ret, 0);
+    if(ls->io_bad || ls->io_pos != ls->io_len){
+        fprintf(stderr, "  IO: the interpreter used %" PRIu32 " of the engine's %" PRIu32
+                " IN/OUT calls%s\n", ls->io_pos, ls->io_len,
+                ls->io_bad ? ", then one which didn't match" : "");
+    }
+
+    const uint8_t* mem = cpu->mem.base;
+    const uint8_t* ref_mem = ref->mem.base;
+    uint32_t diffs = 0;
+    for(uint32_t offset = 0; offset < LOCKSTEP_MEM_SIZE; offset++){
+        if(mem[offset] != ref_mem[offset]){
+            if(diffs < LOCKSTEP_MEM_DIFFS){
+                char name[16];
+                snprintf(name, sizeof(name), "mem %04" PRIX32, offset);
+                lockstep_row(name, mem[offset], ref_mem[offset], 2);
+            }
+            diffs++;
+        }
+    }
+    if(diffs){
+        fprintf(stderr, "  %" PRIu32 " bytes of memory differ\n", diffs);
+    }
+
+    fprintf(stderr, "  last instructions the interpreter ran:\n");
+    uint32_t shown = ls->traced < LOCKSTEP_TRACE ? ls->traced : LOCKSTEP_TRACE;
+    for(uint32_t i = ls->traced - shown; i < ls->traced; i++){
+        lockstep_inst(ref, ls->trace[i % LOCKSTEP_TRACE], " ");
+    }
+    lockstep_inst(ref, ref->PC, ">");
+}
+
+/**
+ * @brief Whether the engine's cpu and the shadow agree
+ *
+ * @param ls
+ * @param cpu
+ * @return int 1 if they do
+ */
+static int lockstep_same(lockstep* ls, cpu_state* cpu){
+    cpu_state* ref = ls->ref;
+    return cpu->PC == ref->PC && cpu->SP == ref->SP && cpu->BC == ref->BC && cpu->DE == ref->DE &&
+           cpu->HL == ref->HL && cpu->ACC == ref->ACC &&
+           compress_PSW(cpu->PSW) == compress_PSW(ref->PSW) &&
+           cpu->intt == ref->intt && cpu->pend_intt == ref->pend_intt && cpu->halt == ref->halt &&
+           cpu->cycles == ref->cycles && cpu->instructions == ref->instructions &&
+           !ls->io_bad && ls->io_pos == ls->io_len &&
+           !memcmp(cpu->mem.base, ref->mem.base, LOCKSTEP_MEM_SIZE);
+}
+
+int lockstep_run_cycles(cpu_state* cpu, uint32_t budget){
+    lockstep* ls = cpu->lockstep_state;
+    if(!ls && !(ls = lockstep_init(cpu))){
+        return engine_run_cycles(cpu, budget);
+    }
+    // Raised by the caller since the last check
+    ls->ref->pend_intt = cpu->pend_intt;
+
+    uint64_t target = cpu->cycles + budget;
+    int ret = 1;
+    while(ret == 1 && cpu->cycles < target){
+        uint64_t from = cpu->cycles;
+        uint64_t stop = target;
+        if(LOCKSTEP_CYCLES && stop - from > LOCKSTEP_CYCLES){
+            stop = from + LOCKSTEP_CYCLES;
+        }
+
+        lockstep_current = ls;
+        ls->io_len = ls->io_pos = 0;
+        ls->io_bad = 0;
+        ls->real_in = cpu->IN_Func;
+        ls->real_out = cpu->OUT_Func;
+        cpu->IN_Func = &lockstep_log_in;
+        cpu->OUT_Func = &lockstep_log_out;
+        ret = engine_run_cycles(cpu, stop - from);
+        cpu->IN_Func = ls->real_in;
+        cpu->OUT_Func = ls->real_out;
+
+        int ref_ret = lockstep_reference(ls, stop);
+        if(ret != ref_ret || !lockstep_same(ls, cpu)){
+            lockstep_report(ls, cpu, from, ret, ref_ret);
+            return -1;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,430 @@
+/**
+ * @file loop_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Loop idiom acceleration. Hand written memcpy, memset and
+ * memcmp/memchr loops are recognised off their code on a jump back to
+ * the loop head, whatever ROM they are in, and the passes left are done
+ * with one host memmove/memset or byte scan. All but one of them that
+ * is, the last pass done is stepped on the cpu, which leaves A and the
+ * flags exactly as the guest code would. Passes only run while they
+ * fit in the slice, so interrupts still land where they would have.
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+
+#define LOOP_MAX_OPS    12  /** Longest loop body recognised */
+
+/**
+ * @brief What the loop does to memory
+ */
+typedef enum {
+    LOOP_COPY,  /**< Loads through one pair, stores A through another */
+    LOOP_FILL,  /**< Stores a register the loop doesn't touch, or an MVI immediate */
+    LOOP_SCAN,  /**< CMP M against a loaded byte or a fixed A, leaving on JZ/JNZ */
+} loop_kind;
+
+/**
+ * @brief How the loop counts its passes, always closed by a JNZ back
+ */
+typedef enum {
+    LOOP_DCR,   /**< DCR r */
+    LOOP_DCX,   /**< DCX rp; MOV A,x; ORA y with x, y its halves */
+    LOOP_CPI,   /**< MOV A,h; CPI n with h the high half of a pointer going up */
+} loop_count;
+
+/**
+ * @brief A recognised loop
+ */
+typedef struct {
+    loop_kind kind;
+    loop_count count;
+    uint8_t counter;        /**< Register code for LOOP_DCR, pair otherwise */
+    uint8_t limit;          /**< LOOP_CPI's operand */
+    int8_t src;             /**< Pair loaded through, -1 if none */
+    int8_t dst;             /**< Pair stored through, HL for LOOP_SCAN's CMP M */
+    int8_t step;            /**< 1 if the pointers go up (INX), -1 if down (DCX) */
+    uint16_t value;         /**< LOOP_FILL's register code, or 0x100 | the immediate */
+    uint8_t exit_on_zero;   /**< LOOP_SCAN leaves on JZ, else on JNZ */
+    uint32_t cycles;        /**< Of one pass */
+    uint32_t instructions;  /**< Of one pass */
+} loop_idiom;
+
+/**
+ * @brief Register code bits of both halves of a pair
+ *
+ * @param rp
+ * @return uint8_t
+ */
+static inline uint8_t loop_halves(uint8_t rp){
+    return 3u << (rp * 2);
+}
+
+/**
+ * @brief Reads the 16 bit operand at offset
+ *
+ * @param mem
+ * @param offset
+ * @return uint16_t
+ */
+static inline uint16_t loop_imm16(v_memory* mem, uint16_t offset){
+    return mem_read(mem, offset) | (mem_read(mem, offset + 1) << 8);
+}
+
+/**
+ * @brief Whether the pieces loop_decode found make up one of the idioms
+ *
+ * @param idiom
+ * @param written register codes the pass writes, a bit each
+ * @param used pairs the pass loads, stores or compares through, a bit each
+ * @param stepped pairs the pass steps, a bit each
+ * @return int 1 if it does
+ */
+static int loop_check(const loop_idiom* idiom, uint8_t written, uint8_t used, uint8_t stepped){
+    if(used != stepped){
+        return 0;   // Every pointer moves once a pass, nothing else does
+    }
+    uint8_t pointers = 0;
+    for(uint8_t rp = 0; rp < 3; rp++){
+        if(used & (1u << rp)){
+            pointers |= loop_halves(rp);
+        }
+    }
+    switch (idiom->count)
+    {
+    case LOOP_DCR:
+        if(idiom->counter == 7 || (pointers & (1u << idiom->counter))){
+            return 0;
+        }
+        break;
+    case LOOP_DCX:
+        if(used & (1u << idiom->counter)){
+            return 0;
+        }
+        break;
+    case LOOP_CPI:
+        if(!(used & (1u << idiom->counter)) || idiom->step != 1){
+            return 0;
+        }
+        break;
+    }
+    switch (idiom->kind)
+    {
+    case LOOP_COPY:
+        return 1;
+    case LOOP_FILL:
+        return idiom->src < 0 && (idiom->value & 0x100 || !(written & (1u << idiom->value)));
+    case LOOP_SCAN:
+        return idiom->src >= 0 || !(written & 0x80);
+    }
+    return 0;
+}
+
+/**
+ * @brief Works out whether the code from head to the JNZ at branch is
+ * one of the idioms, and which registers it uses for what
+ *
+ * @param mem
+ * @param head loop head
+ * @param branch address of the jump back to head
+ * @param idiom filled in
+ * @return int 1 if it is one
+ */
+static int loop_decode(v_memory* mem, uint16_t head, uint16_t branch, loop_idiom* idiom){
+    uint8_t written = 0, used = 0, stepped = 0;
+    uint8_t have_store = 0, have_cmp = 0, have_count = 0, a_loaded = 0;
+    *idiom = (loop_idiom){ .kind = LOOP_FILL, .src = -1, .dst = -1 };
+
+    uint16_t pc = head;
+    for(uint32_t i = 0; i < LOOP_MAX_OPS; i++){
+        uint16_t left = branch - pc;    // Bytes up to the jump back
+        if(left > (uint16_t)(branch - head)){
+            return 0;
+        }
+        uint8_t op_code = mem_read(mem, pc);
+        idiom->cycles += opcode_cycles(op_code);
+        idiom->instructions++;
+        if(left == 0){
+            return op_code == 0xC2 && loop_imm16(mem, pc + 1) == head && have_count &&
+                   (have_store || have_cmp) && loop_check(idiom, written, used, stepped);
+        }
+        if(have_count){
+            return 0;   // The counter goes right before the jump back
+        }
+        pc += opcode_size(op_code);
+
+        uint8_t next = mem_read(mem, pc);
+        uint8_t after = mem_read(mem, pc + 1);
+        uint8_t rp = (op_code >> 4) & 3;
+        if(op_code == 0x0A || op_code == 0x1A || op_code == 0x7E){         // LDAX, MOV A,M
+            rp = op_code == 0x7E ? 2 : rp;
+            if(idiom->src >= 0 || (used & (1u << rp)) || (stepped & (1u << rp))){
+                return 0;
+            }
+            used |= 1u << rp;
+            idiom->src = rp;
+            written |= 0x80;
+            a_loaded = 1;
+        } else if(op_code == 0x02 || op_code == 0x12 || op_code == 0x36 ||    // STAX, MVI M
+                  ((op_code & 0xF8) == 0x70 && op_code != 0x76)){             // MOV M,r
+            rp = op_code < 0x30 ? rp : 2;
+            if(have_store || have_cmp || (used & (1u << rp)) || (stepped & (1u << rp))){
+                return 0;
+            }
+            used |= 1u << rp;
+            idiom->dst = rp;
+            have_store = 1;
+            uint8_t code = op_code == 0x36 ? 0xFF : (op_code < 0x70 ? 7 : op_code & 7);
+            if(code == 0xFF){
+                idiom->value = 0x100 | mem_read(mem, pc - 1);
+            } else if(code == 7 && a_loaded){
+                idiom->kind = LOOP_COPY;
+            } else {
+                idiom->value = code;
+            }
+        } else if(op_code == 0xBE && (next == 0xC2 || next == 0xCA)){       // CMP M; JNZ/JZ out
+            uint16_t out = loop_imm16(mem, pc + 1);
+            if(have_store || have_cmp || (used & 0x4) || (stepped & 0x4) ||
+               (uint16_t)(out - head) <= (uint16_t)(branch - head)){
+                return 0;
+            }
+            used |= 0x4;
+            idiom->dst = 2;
+            idiom->kind = LOOP_SCAN;
+            idiom->exit_on_zero = next == 0xCA;
+            have_cmp = 1;
+            if(!a_loaded && (written & 0x80)){
+                return 0;
+            }
+            // The Jcc is part of the pass, not taken
+            idiom->cycles += opcode_cycles(next);
+            idiom->instructions++;
+            pc += 3;
+            i++;
+        } else if((op_code & 0xCF) == 0x0B && rp < 3 && left == 3 &&        // DCX rp; MOV A,x; ORA y
+                  (next & 0xF8) == 0x78 && (after & 0xF8) == 0xB0 &&
+                  ((1u << (next & 7)) | (1u << (after & 7))) == loop_halves(rp)){
+            idiom->count = LOOP_DCX;
+            idiom->counter = rp;
+            idiom->cycles += opcode_cycles(next) + opcode_cycles(after);
+            idiom->instructions += 2;
+            written |= loop_halves(rp) | 0x80;
+            have_count = 1;
+            pc += 2;
+            i += 2;
+        } else if((op_code & 0xC7) == 0x03 && rp < 3){                     // INX, DCX
+            int8_t step = op_code & 0x08 ? -1 : 1;
+            if((stepped & (1u << rp)) || (idiom->step && idiom->step != step)){
+                return 0;
+            }
+            stepped |= 1u << rp;
+            idiom->step = step;
+            written |= loop_halves(rp);
+        } else if((op_code & 0xC7) == 0x05 && op_code != 0x35 && left == 1){ // DCR r
+            idiom->count = LOOP_DCR;
+            idiom->counter = (op_code >> 3) & 7;
+            written |= 1u << idiom->counter;
+            have_count = 1;
+        } else if((op_code & 0xF9) == 0x78 && (op_code & 7) <= 4 &&         // MOV A,B/D/H; CPI n
+                  left == 3 && next == 0xFE){
+            idiom->count = LOOP_CPI;
+            idiom->counter = (op_code & 7) / 2;
+            idiom->limit = after;
+            idiom->cycles += opcode_cycles(next);
+            idiom->instructions++;
+            written |= 0x80;
+            have_count = 1;
+            pc += 2;
+            i++;
+        } else {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Passes left at the loop head, the one which drops out included
+ *
+ * @param cpu
+ * @param idiom
+ * @return uint32_t
+ */
+static uint32_t loop_passes_left(const cpu_state* cpu, const loop_idiom* idiom){
+    switch (idiom->count)
+    {
+    case LOOP_DCR: {
+        uint8_t count = cpu->reg[REG_SLOT(idiom->counter)];
+        return count ? count : 0x100;
+    }
+    case LOOP_DCX: {
+        uint16_t count = cpu->pair[idiom->counter];
+        return count ? count : 0x10000;
+    }
+    case LOOP_CPI: {
+        // The pointer is compared after its step
+        uint16_t ptr = cpu->pair[idiom->counter];
+        if((uint16_t)(ptr + 1) >> 8 == idiom->limit){
+            return 1;
+        }
+        return (uint16_t)((idiom->limit << 8) - ptr);
+    }
+    }
+    return 0;
+}
+
+/**
+ * @brief Whether the passes bytes a pointer starting at ptr steps over
+ * are on pages with none of flags, see mem_plain
+ *
+ * @param mem
+ * @param passes
+ * @param ptr
+ * @param step
+ * @param flags
+ * @return int
+ */
+static inline int loop_plain(v_memory* mem, uint32_t passes, uint16_t ptr, int8_t step, uint8_t flags){
+    return !passes || mem_plain(mem, step > 0 ? ptr : ptr - (passes - 1), passes, flags);
+}
+
+/**
+ * @brief Caps passes so a pointer starting at ptr doesn't wrap round
+ * the address space
+ *
+ * @param passes
+ * @param ptr
+ * @param step
+ * @return uint32_t
+ */
+static inline uint32_t loop_no_wrap(uint32_t passes, uint16_t ptr, int8_t step){
+    uint32_t room = step > 0 ? 0x10000u - ptr : ptr + 1u;
+    return passes < room ? passes : room;
+}
+
+/**
+ * @brief Whether stores to [lo, lo + len) would land on code: the loop
+ * itself or a page an engine decoded code out of
+ *
+ * @param mem
+ * @param lo
+ * @param len
+ * @param head loop head
+ * @param end just past the jump back
+ * @return int 1 if they would
+ */
+static int loop_hits_code(v_memory* mem, uint16_t lo, uint32_t len, uint16_t head, uint32_t end){
+    if(lo < end && lo + len > head){
+        return 1;
+    }
+    if(mem->watch_pages){
+        for(uint32_t page = lo >> 8; page <= (lo + len - 1) >> 8; page++){
+            if(mem->watch_pages[page]){
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int loop_skip(cpu_state* cpu, uint16_t branch, uint64_t target){
+    uint16_t head = cpu->PC;
+    loop_idiom idiom;
+    if(!loop_decode(&cpu->mem, head, branch, &idiom)){
+        return 0;
+    }
+
+    // The last pass is left to the guest code, it's the one dropping out
+    uint32_t passes = loop_passes_left(cpu, &idiom) - 1;
+    uint64_t fit = (target - 1 - cpu->cycles) / idiom.cycles;
+    passes = passes < fit ? passes : fit;
+    uint16_t src = idiom.src >= 0 ? cpu->pair[idiom.src] : 0;
+    uint16_t dst = cpu->pair[idiom.dst];
+    if(idiom.src >= 0){
+        passes = loop_no_wrap(passes, src, idiom.step);
+    }
+    passes = loop_no_wrap(passes, dst, idiom.step);
+    // Bulk access needs the host bytes contiguous, and stores landing on
+    // ROM or a mirror go the slow way
+    uint8_t dst_flags = idiom.kind == LOOP_SCAN ? MEM_MMIO | MEM_MIRROR : MEM_WRITE_TRAP | MEM_MIRROR;
+    if((idiom.src >= 0 && !loop_plain(&cpu->mem, passes, src, idiom.step, MEM_MMIO | MEM_MIRROR)) ||
+       !loop_plain(&cpu->mem, passes, dst, idiom.step, dst_flags)){
+        return 0;
+    }
+
+    const uint8_t* from = mem_ref(&cpu->mem, src);
+    uint8_t* to = mem_ref(&cpu->mem, dst);
+    switch (idiom.kind)
+    {
+    case LOOP_COPY: {
+        // Byte by byte copies read what they wrote once the store side
+        // runs ahead of the load side, stop short of that
+        uint16_t ahead = idiom.step > 0 ? dst - src : src - dst;
+        if(ahead && ahead < passes){
+            passes = ahead;
+        }
+        break;
+    }
+    case LOOP_SCAN: {
+        uint8_t a = cpu->ACC;
+        for(uint32_t i = 0; i < passes; i++){
+            if(idiom.src >= 0){
+                a = from[idiom.step * (int32_t)i];
+            }
+            if((a == to[idiom.step * (int32_t)i]) == idiom.exit_on_zero){
+                passes = i;     // Pass i drops out
+                break;
+            }
+        }
+        break;
+    }
+    case LOOP_FILL:
+        break;
+    }
+    // One more is stepped below
+    if(passes < 2){
+        return 1;
+    }
+    uint32_t bulk = passes - 1;
+    uint16_t lo = idiom.step > 0 ? dst : dst - (bulk - 1);
+    if(idiom.kind != LOOP_SCAN){
+        if(loop_hits_code(&cpu->mem, lo, bulk, head, branch + 3u)){
+            return 1;
+        }
+        if(idiom.kind == LOOP_COPY){
+            memmove(mem_ref(&cpu->mem, lo), mem_ref(&cpu->mem, idiom.step > 0 ? src : src - (bulk - 1)), bulk);
+        } else {
+            uint8_t value = idiom.value & 0x100 ? idiom.value & 0xFF : cpu->reg[REG_SLOT(idiom.value)];
+            memset(mem_ref(&cpu->mem, lo), value, bulk);
+        }
+    }
+
+    if(idiom.src >= 0){
+        cpu->pair[idiom.src] += idiom.step * (int32_t)bulk;
+    }
+    cpu->pair[idiom.dst] += idiom.step * (int32_t)bulk;
+    if(idiom.count == LOOP_DCR){
+        cpu->reg[REG_SLOT(idiom.counter)] -= bulk;
+    } else if(idiom.count == LOOP_DCX){
+        cpu->pair[idiom.counter] -= bulk;
+    }
+    cpu->cycles += (uint64_t)bulk * idiom.cycles;
+    cpu->instructions += (uint64_t)bulk * idiom.instructions;
+    cpu->skipped_instructions += (uint64_t)bulk * idiom.instructions;
+    cpu->loop_cycles += (uint64_t)bulk * idiom.cycles;
+
+    // A and the flags come out of the last pass, step it
+    for(uint32_t i = 0; i < idiom.instructions; i++){
+        if(exec_inst(cpu) != 1){
+            break;
+        }
+    }
+    return 1;
+}
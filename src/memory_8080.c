@@ -4,31 +4,430 @@
  * @brief Memory wrapper codebase
  * @version 0.1
  * @date 2020-12-24
- * 
+ *
  */
+#define _GNU_SOURCE
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "memory_8080.h"
 
-void* mem_ref(v_memory* mem, uint16_t offset){
-    return (void *)((uintptr_t)mem->base | offset);
+/**
+ * @brief Pages of the window mmap can alias at once, a host page's worth
+ *
+ * @return uint32_t
+ */
+static uint32_t mem_host_pages(){
+    long size = sysconf(_SC_PAGESIZE);
+    return size > MEM_PAGE_SIZE ? size / MEM_PAGE_SIZE : 1;
+}
+
+/**
+ * @brief Page the window shows at page, as mapped by mem_map_mirror
+ *
+ * @param mem
+ * @param page
+ * @return uint8_t
+ */
+static uint8_t mem_target(const v_memory* mem, uint32_t page){
+    return (mem_host(mem->pages[page]) - (uint8_t*)mem->base) / MEM_PAGE_SIZE;
+}
+
+/**
+ * @brief Works out mem->direct off the page table
+ *
+ * @param mem
+ */
+static void mem_update_direct(v_memory* mem){
+    mem->direct = 1;
+    for(uint32_t page = 0; page < MEM_PAGES; page++){
+        if(mem->pages[page] & (MEM_MMIO | MEM_UNALIASED)){
+            mem->direct = 0;
+        }
+    }
+}
+
+/**
+ * @brief MEM_WATCH if the watch flags page
+ *
+ * @param mem
+ * @param page
+ * @return uint8_t
+ */
+static uint8_t mem_watched(const v_memory* mem, uint32_t page){
+    return mem->watch_pages && mem->watch_pages[page] ? MEM_WATCH : 0;
+}
+
+/**
+ * @brief Points page at the window's target page, with flags
+ *
+ * @param mem
+ * @param page
+ * @param target
+ * @param flags
+ */
+static void mem_set_page(v_memory* mem, uint32_t page, uint32_t target, uint8_t flags){
+    mem->pages[page] = ((uintptr_t)mem->base + target * MEM_PAGE_SIZE) | flags | mem_watched(mem, page) | MEM_HASHED;
+#ifdef MEM_HASH
+    mem->home[page] = target;
+#endif
+}
+
+uint8_t mem_init(v_memory* mem){
+    mem->base = NULL;
+    mem->fd = -1;
+    mem->file_fd = -1;
+    int fd = memfd_create("i8080", MFD_CLOEXEC);
+    if(fd == -1){
+        return 0;
+    }
+    uint32_t wrap = mem_host_pages() * MEM_PAGE_SIZE;
+    if(ftruncate(fd, MEM_SIZE) == -1){
+        close(fd);
+        return 0;
+    }
+    // Reserve twice over to find a 64KB aligned window in, the wrap page after it
+    size_t reserve = 2 * MEM_SIZE + wrap;
+    uint8_t* area = mmap(NULL, reserve, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(area == MAP_FAILED){
+        close(fd);
+        return 0;
+    }
+    uint8_t* base = (uint8_t*)(((uintptr_t)area + MEM_SIZE - 1) & ~(uintptr_t)(MEM_SIZE - 1));
+    if(base > area){
+        munmap(area, base - area);
+    }
+    munmap(base + MEM_SIZE + wrap, area + reserve - (base + MEM_SIZE + wrap));
+    if(mmap(base, MEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+       mmap(base + MEM_SIZE, wrap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED){
+        munmap(base, MEM_SIZE + wrap);
+        close(fd);
+        return 0;
+    }
+    mem_map_flat(mem, base);
+    mem->fd = fd;
+    return 1;
+}
+
+void mem_free(v_memory* mem){
+    if(mem->fd >= 0){
+        munmap(mem->base, MEM_SIZE + mem_host_pages() * MEM_PAGE_SIZE);
+        close(mem->fd);
+    }
+    if(mem->file_fd >= 0){
+        close(mem->file_fd);
+    }
+    mem->fd = -1;
+    mem->file_fd = -1;
+    mem->base = NULL;
+}
+
+void mem_map_flat(v_memory* mem, void* base){
+    mem->base = base;
+    mem->fd = -1;
+    mem->watch_pages = NULL;
+    mem->watch_hit = NULL;
+    mem->watch_ctx = NULL;
+    mem->file_fd = -1;
+    for(uint32_t page = 0; page < MEM_PAGES; page++){
+        mem_set_page(mem, page, page, 0);
+    }
+    mem->direct = 1;
+#ifdef MEM_HEAT
+    mem->heat = NULL;
+#endif
+    mem_hash_reset(mem);
+}
+
+/** What mem_init_compact pages show until mapped, reads as 0 */
+static uint8_t mem_unmapped[MEM_PAGE_SIZE] __attribute__((aligned(MEM_PAGE_SIZE)));
+
+void mem_init_compact(v_memory* mem){
+    mem->base = NULL;
+    mem->fd = -1;
+    mem->file_fd = -1;
+#ifdef MEM_HEAT
+    mem->heat = NULL;
+#endif
+    mem->watch_pages = NULL;
+    mem->watch_hit = NULL;
+    mem->watch_ctx = NULL;
+    mem_map_host(mem, 0x00, MEM_PAGES, NULL, MEM_RO);
+}
+
+void mem_map_host(v_memory* mem, uint8_t first, uint16_t count, uint8_t* bytes, uint8_t flags){
+    for(uint32_t i = 0; i < count && first + i < MEM_PAGES; i++){
+        uint8_t* host = bytes ? bytes + i * MEM_PAGE_SIZE : mem_unmapped;
+        mem->pages[first + i] = (uintptr_t)host | (flags & MEM_STORE_TRAP) | mem_watched(mem, first + i) | MEM_UNALIASED | MEM_HASHED;
+#ifdef MEM_HASH
+        mem->home[first + i] = first + i;
+#endif
+    }
+    mem->direct = 0;
+    mem_hash_reset(mem);
+}
+
+/**
+ * @brief Whether the window's page shows the file's bytes
+ *
+ * @param mem
+ * @param page as mem_target gives
+ * @return uint8_t
+ */
+static uint8_t mem_in_file(const v_memory* mem, uint32_t page){
+    return mem->file_fd >= 0 && page >= mem->file_first && page < (uint32_t)mem->file_first + mem->file_pages;
+}
+
+void mem_map_flags(v_memory* mem, uint8_t first, uint16_t count, uint8_t flags){
+    for(uint32_t page = first; page < first + count && page < MEM_PAGES; page++){
+        // The file's pages aren't writable in the window, keep them trapped
+        uint8_t keep = mem->file_fd >= 0 && mem_in_file(mem, mem_target(mem, page)) ? MEM_RO : 0;
+        mem->pages[page] = (mem->pages[page] & ~(uintptr_t)MEM_STORE_TRAP) | ((flags | keep) & MEM_STORE_TRAP) | MEM_HASHED;
+    }
+    mem_update_direct(mem);
+    mem_hash_reset(mem);
+}
+
+/**
+ * @brief Points the window's host pages from page at the backing of
+ * target (the memfd's, or the file's read only), or back at their own
+ * with target == page
+ *
+ * @param mem
+ * @param page first of a host page
+ * @param target first of a host page
+ * @return uint8_t 1 if aliased
+ */
+static uint8_t mem_alias(v_memory* mem, uint32_t page, uint32_t target){
+    uint32_t size = mem_host_pages() * MEM_PAGE_SIZE;
+    uint8_t* at = (uint8_t*)mem->base + page * MEM_PAGE_SIZE;
+    int prot = PROT_READ | PROT_WRITE;
+    int fd = mem->fd;
+    off_t offset = target * MEM_PAGE_SIZE;
+    if(mem_in_file(mem, target)){
+        prot = PROT_READ;
+        fd = mem->file_fd;
+        offset = (target - mem->file_first) * MEM_PAGE_SIZE;
+    }
+    if(mmap(at, size, prot, MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED){
+        return 0;
+    }
+    // The wrap page after the window follows the window's first
+    if(page == 0){
+        mmap((uint8_t*)mem->base + MEM_SIZE, size, prot, MAP_SHARED | MAP_FIXED, fd, offset);
+    }
+    return 1;
+}
+
+uint8_t mem_map_file(v_memory* mem, uint8_t first, int fd, uint32_t size){
+    uint32_t host = mem_host_pages();
+    uint32_t pages = size / MEM_PAGE_SIZE;
+    if(mem->fd < 0 || mem->file_fd >= 0 || !size || first % host || pages % host ||
+       size % MEM_PAGE_SIZE || first + pages > MEM_PAGES){
+        return 0;
+    }
+    for(uint32_t page = first; page < first + pages; page++){
+        if(mem->pages[page] & (MEM_FLAGS & ~MEM_WATCH)){
+            return 0;
+        }
+    }
+    mem->file_fd = dup(fd);
+    if(mem->file_fd == -1){
+        return 0;
+    }
+    mem->file_first = first;
+    mem->file_pages = pages;
+    for(uint32_t page = first; page < first + pages; page += host){
+        if(!mem_alias(mem, page, page)){
+            // Back to the memfd for what got mapped
+            close(mem->file_fd);
+            mem->file_fd = -1;
+            for(uint32_t undo = first; undo < page; undo += host){
+                mem_alias(mem, undo, undo);
+            }
+            return 0;
+        }
+    }
+    mem_map_flags(mem, first, pages, MEM_RO);
+    return 1;
+}
+
+/**
+ * @brief Whether the window aliases the host page starting at page
+ * elsewhere, which mem_map_mirror only does host page by host page
+ *
+ * @param mem
+ * @param page first of a host page
+ * @return uint8_t
+ */
+static uint8_t mem_aliased(const v_memory* mem, uint32_t page){
+    return (mem->pages[page] & (MEM_MIRROR | MEM_UNALIASED)) == MEM_MIRROR;
 }
 
-uint8_t mem_read(v_memory* mem, uint16_t offset){
-    uint8_t *target_addr = (uint8_t *)mem_ref(mem, offset);
-    return *target_addr;
+void mem_map_mirror(v_memory* mem, uint8_t first, uint16_t count, uint8_t target){
+    uint32_t host = mem_host_pages();
+    for(uint32_t i = 0; i < count && first + i < MEM_PAGES; i++){
+        uint32_t page = first + i;
+        uintptr_t bytes = mem->pages[(uint8_t)(target + i)] & ~(uintptr_t)MEM_FLAGS;
+        uint8_t flags = mem->pages[(uint8_t)(target + i)] & MEM_STORE_TRAP;
+        uint32_t group = page - page % host;
+        uint8_t whole = page == group && count - i >= host && mem->fd >= 0;
+        uint32_t shown = whole ? mem_target(mem, (uint8_t)(target + i)) : 0;
+        if(!whole && mem->fd >= 0 && mem_aliased(mem, group)){
+            // Changing part of an aliased host page, its other pages keep
+            // their host bytes but lose the window
+            mem_alias(mem, group, group);
+            for(uint32_t j = group; j < group + host; j++){
+                mem->pages[j] |= MEM_UNALIASED;
+            }
+        }
+        if(whole && shown % host == 0 && mem_alias(mem, page, shown)){
+            // Whole host pages are aliased in the window in one go
+            for(uint32_t j = 0; j < host; j++){
+                mem_set_page(mem, page + j, shown + j, shown == page ? flags : flags | MEM_MIRROR);
+            }
+            i += host - 1;
+            continue;
+        }
+        flags |= mem_watched(mem, page);
+        if(mem->base && bytes == (uintptr_t)mem->base + page * MEM_PAGE_SIZE){
+            mem->pages[page] = bytes | flags;
+        } else {
+            mem->pages[page] = bytes | flags | MEM_MIRROR | MEM_UNALIASED;
+        }
+#ifdef MEM_HASH
+        mem->home[page] = mem->home[(uint8_t)(target + i)];
+#endif
+    }
+    mem_update_direct(mem);
+    mem_hash_reset(mem);
 }
 
-uint16_t short_mem_read(v_memory* mem, uint16_t offset){
-    uint16_t *target_addr = (uint16_t *)mem_ref(mem, offset);
-    return *target_addr;
+void mem_map_copy(v_memory* dst, const v_memory* src){
+    uint32_t host = mem_host_pages();
+    for(uint32_t group = 0; group < MEM_PAGES; group += host){
+        uint8_t same = 1;
+        for(uint32_t j = group; j < group + host; j++){
+            same &= mem_target(dst, j) == mem_target(src, j) &&
+                    ((dst->pages[j] ^ src->pages[j]) & (MEM_FLAGS & ~(MEM_UNALIASED | MEM_WATCH))) == 0;
+        }
+        if(same){
+            continue;
+        }
+        if(mem_aliased(src, group)){
+            mem_map_mirror(dst, group, host, mem_target(src, group));
+        } else {
+            for(uint32_t j = group; j < group + host; j++){
+                mem_map_mirror(dst, j, 1, mem_target(src, j));
+            }
+        }
+        for(uint32_t j = group; j < group + host; j++){
+            mem_map_flags(dst, j, 1, src->pages[j] & MEM_STORE_TRAP);
+        }
+    }
+    dst->mmio_read = src->mmio_read;
+    dst->mmio_write = src->mmio_write;
+    dst->mmio_ctx = src->mmio_ctx;
+    mem_update_direct(dst);
 }
 
-void mem_write(v_memory* mem, uint16_t offset, uint8_t val){
-    uint8_t *target_addr = (uint8_t *)mem_ref(mem, offset);
-    *target_addr = val;
+uint8_t mem_plain(const v_memory* mem, uint16_t offset, uint32_t count, uint8_t flags){
+    if(!count){
+        return 1;
+    }
+    for(uint32_t page = offset >> 8; page <= (offset + count - 1u) >> 8 && page < MEM_PAGES; page++){
+        if(mem->pages[page] & flags){
+            return 0;
+        }
+        if(page > offset >> 8 && mem_host(mem->pages[page]) != mem_host(mem->pages[page - 1]) + MEM_PAGE_SIZE){
+            return 0;
+        }
+    }
+    return 1;
 }
 
-void short_mem_write(v_memory* mem, uint16_t offset, uint16_t val){
-    uint16_t *target_addr = (uint16_t *)mem_ref(mem, offset);
-    *target_addr = val;
-}
\ No newline at end of file
+uint8_t mem_read_slow(v_memory* mem, uint16_t offset){
+    uintptr_t page = mem->pages[offset >> 8];
+    if(page & MEM_MMIO){
+        return mem->mmio_read ? mem->mmio_read(mem->mmio_ctx, offset) : 0xFF;
+    }
+    return mem_host(page)[offset & 0xFF];
+}
+
+uint16_t short_mem_read_slow(v_memory* mem, uint16_t offset){
+    return mem_read_slow(mem, offset) | mem_read_slow(mem, offset + 1) << 8;
+}
+
+void mem_write_slow(v_memory* mem, uint16_t offset, uint8_t val){
+    uintptr_t page = mem->pages[offset >> 8];
+    if(page & MEM_MMIO){
+        if(mem->mmio_write){
+            mem->mmio_write(mem->mmio_ctx, offset, val);
+        }
+        return;
+    }
+    if(page & MEM_RO){
+        return;
+    }
+#ifdef MEM_HASH
+    uint64_t key = (uint64_t)(mem->home[offset >> 8] << 8 | (offset & 0xFF)) << 8;
+    mem->hash ^= mem_mix(key | mem_host(page)[offset & 0xFF]) ^ mem_mix(key | val);
+#endif
+    mem_host(page)[offset & 0xFF] = val;
+    mem_watch(mem, offset);
+}
+
+void short_mem_write_slow(v_memory* mem, uint16_t offset, uint16_t val){
+    mem_write_slow(mem, offset, val & 0xFF);
+    mem_write_slow(mem, offset + 1, val >> 8);
+}
+
+void mem_watch_set(v_memory* mem, const uint8_t* pages, void (*hit)(void* ctx, uint16_t offset), void* ctx){
+    mem->watch_pages = pages;
+    mem->watch_hit = hit;
+    mem->watch_ctx = ctx;
+    mem_watch_sync(mem, 0, MEM_PAGES);
+}
+
+void mem_watch_sync(v_memory* mem, uint8_t first, uint16_t count){
+    for(uint32_t page = first; page < first + count && page < MEM_PAGES; page++){
+        mem->pages[page] = (mem->pages[page] & ~(uintptr_t)MEM_WATCH) | mem_watched(mem, page);
+    }
+}
+
+#ifdef MEM_HASH
+uint64_t mem_hash_full(const v_memory* mem){
+    // Each home page once, off the bytes of the first page showing them
+    uint8_t seen[MEM_PAGES] = {0};
+    uint64_t hash = 0;
+    for(uint32_t page = 0; page < MEM_PAGES; page++){
+        uint8_t home = mem->home[page];
+        if((mem->pages[page] & MEM_MMIO) || seen[home]){
+            continue;
+        }
+        seen[home] = 1;
+        const uint8_t* bytes = mem_host(mem->pages[page]);
+        for(uint32_t i = 0; i < MEM_PAGE_SIZE; i++){
+            hash ^= mem_mix((uint64_t)(home << 8 | i) << 8 | bytes[i]);
+        }
+    }
+    return hash;
+}
+
+uint64_t mem_hash(v_memory* mem){
+    if(mem->hash_stale){
+        mem->hash = mem_hash_full(mem);
+        mem->hash_stale = 0;
+    }
+#ifdef MEM_HASH_VERIFY
+    uint64_t full = mem_hash_full(mem);
+    if(mem->hash != full){
+        fprintf(stderr, "mem: hash %016" PRIx64 " kept by the stores, %016" PRIx64 " worked out\n", mem->hash, full);
+        abort();
+    }
+#endif
+    return mem->hash;
+}
+#endif
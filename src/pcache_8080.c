@@ -0,0 +1,173 @@
+/**
+ * @file pcache_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Persistent code cache file, see pcache_8080.h. The file is a
+ * pcache_header followed by count records whose layout is the engine's
+ * own (block_cache_save, jit_cache_save).
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "engine_8080.h"
+#include "pcache_8080.h"
+
+#define PCACHE_MAGIC    0x48434350u     /** "PCCH" */
+#define PCACHE_VERSION  1               /** Bump when the header changes */
+#define PCACHE_PATH_MAX 512             /** Room for the temporary file's name */
+
+///@{
+/** The engine's side of the file */
+#if defined(ENGINE_BLOCK)
+#define PCACHE_KEY()                        block_cache_key()
+#define PCACHE_SAVE(cpu, out, end, count)   block_cache_save(cpu, out, end, count)
+#define PCACHE_LOAD(cpu, in, size, count)   block_cache_load(cpu, in, size, count)
+#elif defined(PCACHE_ENGINE)
+#define PCACHE_KEY()                        jit_cache_key()
+#define PCACHE_SAVE(cpu, out, end, count)   jit_cache_save(cpu, out, end, count)
+#define PCACHE_LOAD(cpu, in, size, count)   jit_cache_load(cpu, in, size, count)
+#endif
+///@}
+
+/**
+ * @brief Start of every code cache file. Everything up to count has to
+ * match for the file to be used.
+ */
+typedef struct {
+    uint32_t magic;         /**< PCACHE_MAGIC */
+    uint32_t version;       /**< PCACHE_VERSION */
+    char engine[16];        /**< engine_name() of the engine which saved it */
+    uint64_t engine_key;    /**< The engine's record layout and decode rules, *_cache_key */
+    uint64_t rom_hash;      /**< FNV-1a 64 of the rom_size bytes from 0 */
+    uint32_t rom_size;
+    uint32_t count;         /**< Records after the header */
+    uint64_t body_size;     /**< Bytes of records */
+    uint64_t body_hash;     /**< FNV-1a 64 of them, catches torn or damaged files */
+} pcache_header;
+
+#ifdef PCACHE_ENGINE
+
+/**
+ * @brief FNV-1a 64
+ *
+ * @param data
+ * @param size
+ * @return uint64_t
+ */
+static uint64_t pcache_hash(const uint8_t* data, size_t size){
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for(size_t i = 0; i < size; i++){
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Fills in the fields identifying what the cpu's cache is good for
+ *
+ * @param cpu
+ * @param head
+ */
+static void pcache_identify(cpu_state* cpu, pcache_header* head){
+    memset(head, 0, sizeof(pcache_header));
+    head->magic = PCACHE_MAGIC;
+    head->version = PCACHE_VERSION;
+    strncpy(head->engine, engine_name(), sizeof(head->engine) - 1);
+    head->engine_key = PCACHE_KEY();
+    head->rom_hash = pcache_hash(cpu->mem.base, cpu->rom_size);
+    head->rom_size = cpu->rom_size;
+}
+
+uint8_t pcache_load(cpu_state* cpu, const char* path){
+    int fd = open(path, O_RDONLY);
+    if(fd == -1){
+        return 0;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(pcache_header)){
+        close(fd);
+        return 0;
+    }
+    const uint8_t* file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(file == MAP_FAILED){
+        return 0;
+    }
+
+    pcache_header want;
+    pcache_identify(cpu, &want);
+    const pcache_header* head = (const pcache_header*)file;
+    const uint8_t* body = file + sizeof(pcache_header);
+    uint8_t loaded = 0;
+    if(!memcmp(head, &want, offsetof(pcache_header, count)) &&
+       head->body_size == st.st_size - sizeof(pcache_header) &&
+       head->body_hash == pcache_hash(body, head->body_size)){
+        loaded = PCACHE_LOAD(cpu, body, head->body_size, head->count);
+        if(!loaded){
+            // Drop whatever made it in before the bad record
+            flush_code_cache(cpu);
+        }
+    } else {
+        DEBUG_PRINT("%s is stale, starting cold\n", path);
+    }
+    munmap((void*)file, st.st_size);
+    return loaded;
+}
+
+uint8_t pcache_save(cpu_state* cpu, const char* path){
+    if(!cpu->rom_size){
+        return 0;
+    }
+    pcache_header head;
+    pcache_identify(cpu, &head);
+    size_t size = PCACHE_SAVE(cpu, NULL, cpu->rom_size, &head.count);
+    if(!head.count){
+        return 0;
+    }
+    uint8_t* body = malloc(size);
+    if(!body){
+        return 0;
+    }
+    PCACHE_SAVE(cpu, body, cpu->rom_size, &head.count);
+    head.body_size = size;
+    head.body_hash = pcache_hash(body, size);
+
+    char tmp_path[PCACHE_PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld", path, (long)getpid());
+    FILE* file = fopen(tmp_path, "wb");
+    uint8_t saved = 0;
+    if(file){
+        saved = fwrite(&head, sizeof(head), 1, file) == 1 && fwrite(body, size, 1, file) == 1;
+        saved &= fclose(file) == 0;
+        saved = saved && rename(tmp_path, path) == 0;
+        if(!saved){
+            WARN(0, "Couldn't write the code cache %s\n", path);
+            unlink(tmp_path);
+        }
+    }
+    free(body);
+    return saved;
+}
+
+#else
+
+uint8_t pcache_load(UNUSED cpu_state* cpu, UNUSED const char* path){
+    return 0;
+}
+
+uint8_t pcache_save(UNUSED cpu_state* cpu, UNUSED const char* path){
+    return 0;
+}
+
+#endif /* PCACHE_ENGINE */
@@ -0,0 +1,92 @@
+/**
+ * @file sched_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Emulated time event scheduler, see sched_8080.h
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "debug.h"
+#include "cpu_8080.h"
+#include "sched_8080.h"
+
+/**
+ * @brief Bucket an event due at when lives in
+ *
+ * @param when
+ * @return uint32_t
+ */
+static inline uint32_t sched_slot(uint64_t when){
+    return (when / SCHED_SLOT_CYCLES) % SCHED_SLOTS;
+}
+
+/**
+ * @brief Works out sched->next again off the bucket heads
+ *
+ * @param sched
+ */
+static void sched_update_next(scheduler* sched){
+    sched->next = SCHED_NEVER;
+    for(uint32_t slot = 0; slot < SCHED_SLOTS; slot++){
+        if(sched->wheel[slot] && sched->wheel[slot]->when < sched->next){
+            sched->next = sched->wheel[slot]->when;
+        }
+    }
+}
+
+void sched_init(scheduler* sched){
+    for(uint32_t slot = 0; slot < SCHED_SLOTS; slot++){
+        sched->wheel[slot] = NULL;
+    }
+    sched->next = SCHED_NEVER;
+}
+
+void sched_at(scheduler* sched, sched_event* event, uint64_t when){
+    event->when = when;
+    sched_event** link = &sched->wheel[sched_slot(when)];
+    while(*link && (*link)->when <= when){
+        link = &(*link)->next;
+    }
+    event->next = *link;
+    *link = event;
+    if(when < sched->next){
+        sched->next = when;
+    }
+}
+
+/**
+ * @brief Fires every event due by the cpu's cycle count, earliest first
+ *
+ * @param sched
+ * @param cpu
+ */
+static void sched_fire(scheduler* sched, cpu_state* cpu){
+    while(sched->next <= cpu->cycles){
+        sched_event** head = &sched->wheel[sched_slot(sched->next)];
+        sched_event* event = *head;
+        *head = event->next;
+        event->next = NULL;
+        sched_update_next(sched);
+        event->cb(sched, cpu, event);
+    }
+}
+
+int sched_run(scheduler* sched, cpu_state* cpu, uint64_t until){
+    sched_fire(sched, cpu);
+    while(cpu->cycles < until){
+        uint64_t stop = sched->next < until ? sched->next : until;
+        // run_cycles takes a 32 bit budget
+        if(stop - cpu->cycles > UINT32_MAX){
+            stop = cpu->cycles + UINT32_MAX;
+        }
+        int ret = run_cycles(cpu, stop - cpu->cycles);
+        if(ret != 1){
+            return ret;
+        }
+        sched_fire(sched, cpu);
+    }
+    return 1;
+}
@@ -0,0 +1,283 @@
+/**
+ * @file snap_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Content addressed snapshot store, see snap_8080.h
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "cpu_8080.h"
+#include "lockstep_8080.h"
+#include "snap_8080.h"
+
+#define SNAP_MIN_PAGES  0x100       /** Page slots the store starts with */
+#define SNAP_MIN_SNAPS  0x10        /** Snapshot slots the store starts with */
+/** Pages that aren't state of their own */
+#define SNAP_SKIP       (MEM_MIRROR | MEM_RO | MEM_MMIO)
+
+/**
+ * @brief Hash of a page's bytes, a word at a time
+ *
+ * @param bytes
+ * @return uint64_t
+ */
+static uint64_t snap_page_hash(const uint8_t* bytes){
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for(uint32_t i = 0; i < MEM_PAGE_SIZE; i += sizeof(uint64_t)){
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ull;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+void snap_init(snap_store* store){
+    memset(store, 0, sizeof(snap_store));
+    store->page_free = SNAP_NONE;
+    store->snap_free = SNAP_NONE;
+    store->last = SNAP_NONE;
+}
+
+void snap_free(snap_store* store){
+    free(store->pages);
+    free(store->buckets);
+    free(store->snaps);
+    snap_init(store);
+}
+
+/**
+ * @brief Doubles the page slots, and the buckets with them
+ *
+ * @param store
+ * @return uint8_t 1 if grown, 0 if out of memory
+ */
+static uint8_t snap_grow_pages(snap_store* store){
+    uint32_t cap = store->page_cap ? store->page_cap * 2 : SNAP_MIN_PAGES;
+    snap_page* pages = realloc(store->pages, (size_t)cap * sizeof(snap_page));
+    if(!pages){
+        return 0;
+    }
+    store->pages = pages;
+    uint32_t* buckets = malloc((size_t)cap * sizeof(uint32_t));
+    if(!buckets){
+        return 0;
+    }
+    free(store->buckets);
+    store->buckets = buckets;
+    store->page_cap = cap;
+    store->bucket_mask = cap - 1;
+    memset(buckets, 0xFF, (size_t)cap * sizeof(uint32_t));
+    // Rechain the pages held, the free list stays as it is
+    for(uint32_t id = 0; id < store->page_count; id++){
+        snap_page* page = &store->pages[id];
+        if(page->refs){
+            page->next = buckets[page->hash & store->bucket_mask];
+            buckets[page->hash & store->bucket_mask] = id;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Finds the page holding bytes, adding it if there's none
+ *
+ * @param store
+ * @param bytes
+ * @return uint32_t its id, SNAP_NONE if out of memory. The caller takes
+ * the reference.
+ */
+static uint32_t snap_intern(snap_store* store, const uint8_t* bytes){
+    uint64_t hash = snap_page_hash(bytes);
+    if(store->page_cap){
+        for(uint32_t id = store->buckets[hash & store->bucket_mask]; id != SNAP_NONE; id = store->pages[id].next){
+            if(store->pages[id].hash == hash && !memcmp(store->pages[id].bytes, bytes, MEM_PAGE_SIZE)){
+                return id;
+            }
+        }
+    }
+    uint32_t id = store->page_free;
+    if(id != SNAP_NONE){
+        store->page_free = store->pages[id].next;
+    } else {
+        if(store->page_count == store->page_cap && !snap_grow_pages(store)){
+            return SNAP_NONE;
+        }
+        id = store->page_count++;
+    }
+    snap_page* page = &store->pages[id];
+    page->hash = hash;
+    page->refs = 0;
+    memcpy(page->bytes, bytes, MEM_PAGE_SIZE);
+    page->next = store->buckets[hash & store->bucket_mask];
+    store->buckets[hash & store->bucket_mask] = id;
+    store->live_pages++;
+    return id;
+}
+
+/**
+ * @brief Drops a reference to page id, freeing it with the last
+ *
+ * @param store
+ * @param id
+ */
+static void snap_unref(snap_store* store, uint32_t id){
+    snap_page* page = &store->pages[id];
+    if(--page->refs){
+        return;
+    }
+    uint32_t* link = &store->buckets[page->hash & store->bucket_mask];
+    while(*link != id){
+        link = &store->pages[*link].next;
+    }
+    *link = page->next;
+    page->next = store->page_free;
+    store->page_free = id;
+    store->live_pages--;
+}
+
+uint32_t snap_take(snap_store* store, cpu_state* cpu){
+    uint32_t id = store->snap_free;
+    if(id != SNAP_NONE){
+        store->snap_free = store->snaps[id].next_free;
+    } else {
+        if(store->snap_count == store->snap_cap){
+            uint32_t cap = store->snap_cap ? store->snap_cap * 2 : SNAP_MIN_SNAPS;
+            snap_state* snaps = realloc(store->snaps, (size_t)cap * sizeof(snap_state));
+            if(!snaps){
+                return SNAP_NONE;
+            }
+            store->snaps = snaps;
+            store->snap_cap = cap;
+        }
+        id = store->snap_count++;
+    }
+    snap_state* snap = &store->snaps[id];
+    const snap_state* last = store->last != SNAP_NONE ? &store->snaps[store->last] : NULL;
+    snap->used = 1;
+    store->live_snaps++;
+
+    for(uint32_t p = 0; p < MEM_PAGES; p++){
+        snap->pages[p] = SNAP_NONE;
+    }
+    for(uint32_t p = 0; p < MEM_PAGES; p++){
+        if(cpu->mem.pages[p] & SNAP_SKIP){
+            continue;
+        }
+        const uint8_t* bytes = mem_host(cpu->mem.pages[p]);
+        // Most pages are what they were at the last snapshot
+        uint32_t page = last ? last->pages[p] : SNAP_NONE;
+        if(page == SNAP_NONE || memcmp(store->pages[page].bytes, bytes, MEM_PAGE_SIZE)){
+            page = snap_intern(store, bytes);
+        }
+        if(page == SNAP_NONE){
+            snap_drop(store, id);
+            return SNAP_NONE;
+        }
+        store->pages[page].refs++;
+        snap->pages[p] = page;
+    }
+
+    snap_cpu* regs = &snap->cpu;
+    memcpy(regs->reg, cpu->reg, sizeof(regs->reg));
+    regs->SP = cpu->SP;
+    regs->PC = cpu->PC;
+    regs->PSW = cpu->PSW;
+    regs->intt = cpu->intt;
+    regs->pend_intt = cpu->pend_intt;
+    regs->halt = cpu->halt;
+    regs->cycles = cpu->cycles;
+    regs->instructions = cpu->instructions;
+    regs->skipped_instructions = cpu->skipped_instructions;
+    regs->idle_cycles = cpu->idle_cycles;
+    regs->hle_cycles = cpu->hle_cycles;
+    regs->loop_cycles = cpu->loop_cycles;
+    store->last = id;
+    return id;
+}
+
+uint8_t snap_restore(snap_store* store, uint32_t id, cpu_state* cpu){
+    if(id >= store->snap_count || !store->snaps[id].used){
+        return 0;
+    }
+    const snap_state* snap = &store->snaps[id];
+    uint8_t changed[MEM_PAGES] = {0};
+    uint8_t any = 0;
+    for(uint32_t p = 0; p < MEM_PAGES; p++){
+        if(snap->pages[p] == SNAP_NONE){
+            continue;
+        }
+        uint8_t* bytes = mem_host(cpu->mem.pages[p]);
+        const uint8_t* kept = store->pages[snap->pages[p]].bytes;
+        if(memcmp(bytes, kept, MEM_PAGE_SIZE)){
+            memcpy(bytes, kept, MEM_PAGE_SIZE);
+            store->pages_copied++;
+            changed[p] = any = 1;
+        }
+    }
+
+    const snap_cpu* regs = &snap->cpu;
+    memcpy(cpu->reg, regs->reg, sizeof(regs->reg));
+    cpu->SP = regs->SP;
+    cpu->PC = regs->PC;
+    cpu->PSW = regs->PSW;
+    cpu->intt = regs->intt;
+    cpu->pend_intt = regs->pend_intt;
+    cpu->halt = regs->halt;
+    cpu->cycles = regs->cycles;
+    cpu->instructions = regs->instructions;
+    cpu->skipped_instructions = regs->skipped_instructions;
+    cpu->idle_cycles = regs->idle_cycles;
+    cpu->hle_cycles = regs->hle_cycles;
+    cpu->loop_cycles = regs->loop_cycles;
+    cpu->idle_reject = 0;
+    cpu->idle_misses = 0;
+
+    // Code decoded out of a changed page (or a mirror of one) is stale
+    uint8_t flush = 0;
+    for(uint32_t p = 0; any && cpu->mem.watch_pages && p < MEM_PAGES; p++){
+        if(cpu->mem.watch_pages[p] && (changed[p] || (cpu->mem.pages[p] & MEM_MIRROR))){
+            flush = 1;
+            break;
+        }
+    }
+    if(flush){
+        flush_code_cache(cpu);
+    } else {
+        if(any){
+            mem_hash_reset(&cpu->mem);
+        }
+#ifdef LOCKSTEP
+        lockstep_sync(cpu);
+#endif
+    }
+    store->last = id;
+    return 1;
+}
+
+void snap_drop(snap_store* store, uint32_t id){
+    if(id >= store->snap_count || !store->snaps[id].used){
+        return;
+    }
+    snap_state* snap = &store->snaps[id];
+    for(uint32_t p = 0; p < MEM_PAGES; p++){
+        if(snap->pages[p] != SNAP_NONE){
+            snap_unref(store, snap->pages[p]);
+        }
+    }
+    snap->used = 0;
+    snap->next_free = store->snap_free;
+    store->snap_free = id;
+    store->live_snaps--;
+    if(store->last == id){
+        store->last = SNAP_NONE;
+    }
+}
+
+size_t snap_bytes(const snap_store* store){
+    return (size_t)store->live_pages * sizeof(snap_page) + (size_t)store->live_snaps * sizeof(snap_state) +
+           (size_t)store->page_cap * sizeof(uint32_t);
+}
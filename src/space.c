@@ -16,12 +16,41 @@
 #include <sys/stat.h>
 #include <assert.h>
 #include <signal.h>
+#include <time.h>
 
 #include "debug.h"
 #include "space.h"
 
 static port_IO space_docks;
 
+/**
+ * @brief Host monotonic clock
+ * 
+ * @return uint64_t nanoseconds
+ */
+static uint64_t now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Sleeps until the host clock catches up with the emulated
+ * one, so the game runs at CPU_CLOCK_HZ however fast the core is
+ * 
+ * @param cpu cpu emulating the game
+ * @param start_ns host time emulated cycle 0 maps to
+ */
+static void pace_host(cpu_state *cpu, uint64_t start_ns){
+    uint64_t due = start_ns + cpu->cycles * NS_PER_CYCLE;
+    uint64_t now = now_ns();
+    if(due > now){
+        struct timespec ts = {.tv_sec = (due - now) / 1000000000ull,
+                              .tv_nsec = (due - now) % 1000000000ull};
+        nanosleep(&ts, NULL);
+    }
+}
+
 /**
  * @brief main emulator driver. Creates the vCPU 
  * and game window instances
@@ -52,11 +81,18 @@ int main(){
 
     // memory Map the ROM
     char* rom_path = "./invaders_rom";
-    int rom_FD;
-    if ((rom_FD = copy_invaders_rom(rom_path, cpu)) == -1){
+    if (!copy_invaders_rom(rom_path, cpu)){
         fprintf(stderr, "Critical Error: Rom Load Failed.\n");
         exit(-1);
     }
+#ifdef HLE
+    if(!hle_enable(cpu, HLE_ROUTINES)){
+        DEBUG_PRINT("%s\n", "Unknown ROM, running every routine on the cpu");
+    }
+#endif
+    if(!pcache_load(cpu, CODE_CACHE_PATH)){
+        DEBUG_PRINT("%s\n", "No code cache to start from, starting cold");
+    }
 
     // Init the screen to white color
     uint32_t *pixels = game_window->surf->pixels;
@@ -67,37 +103,62 @@ int main(){
     }
     SDL_UpdateWindowSurface(game_window->window);
 
-    // Setup the Diplay Update Timer with CB
-    game_window->vram_timer = SDL_AddTimer(VRAM_DELAY, update_vram_cb, NULL);
+    // Setup the display interrupts on the emulated clock
+    sched_init(&game_window->sched);
+    game_window->half_event.cb = half_frame_cb;
+    game_window->full_event.cb = full_frame_cb;
+    game_window->full_event.ctx = game_window;
+    sched_at(&game_window->sched, &game_window->half_event, CYCLES_PER_FRAME / 2);
+    sched_at(&game_window->sched, &game_window->full_event, CYCLES_PER_FRAME);
 
+    uint64_t start_ns = now_ns();
     while(!game_window->quit_event){
-        if(!cpu->halt && exec_inst(cpu) == 1){
-            // Stuff to do on successful exec
-        } else {
+        // Run a slice of cycles inside the core, pay for the
+        // event polling once per slice
+        if(!cpu->halt &&
+           sched_run(&game_window->sched, cpu, cpu->cycles + CYCLES_PER_SLICE) == -1){
+            fprintf(stderr, "Critical Error: cpu stopped at PC:%x\n", cpu->PC);
+            print_state(*cpu);
             cpu->halt = 1;  // Explicity halt the CPU incase something 
                             // fails
         }
+        pace_host(cpu, start_ns);
 
         // Check if there have been any events
-        if(SDL_PollEvent(&(game_window->event))){
+        while(SDL_PollEvent(&(game_window->event))){
             process_SDL_event(cpu, game_window);
         }
     }
 
     DEBUG_PRINT("Do I have to lock: %x\n", SDL_MUSTLOCK(game_window->surf));
 
+    pcache_save(cpu, CODE_CACHE_PATH);
+
+    vram_tracker* vt = &game_window->vram;
+    if(vt->frames){
+        printf("vram: %.1f%% of lines, %.1f%% of bytes redrawn per frame over %" PRIu64 " frames\n",
+               100.0 * vt->lines_drawn / (vt->frames * VRAM_LINES),
+               100.0 * vt->bytes_drawn / (vt->frames * VRAM_SIZE), vt->frames);
+    }
+
     // free the buffers.
     DEBUG_PRINT("%s\n", "Freeing SDL Mem");
     destroy_game_window(game_window);
-    close(rom_FD);
     DEBUG_PRINT("%s\n", "Freeing RAM");
-    free(cpu->mem.base);
+    mem_free(&cpu->mem);
     DEBUG_PRINT("%s\n", "Freeing Cpu");
-    free(cpu);
+    free_cpu_8080(cpu);
     return 0;
 }
 
 // Helper Functions
+void map_invaders(v_memory* mem){
+    mem_map_flags(mem, ROM_OFFSET >> 8, ROM_PAGES, MEM_RO);
+    for(uint32_t page = MIRROR_PAGE; page < MEM_PAGES; page += MIRROR_PAGE){
+        mem_map_mirror(mem, page, MIRROR_PAGE, 0x00);
+    }
+}
+
 int copy_invaders_rom(char *path, cpu_state* cpu){
     assert(cpu!=NULL);
     assert(path!=NULL);
@@ -119,13 +180,25 @@ int copy_invaders_rom(char *path, cpu_state* cpu){
    }
 
     // Memory mapping
-    cpu->mem.base = aligned_alloc(ALIGNED_PREFIX, UINT16_MAX);
-    if (read(FD, cpu->mem.base + ROM_OFFSET, cpu->rom_size) == 0){
+    if (!mem_init(&cpu->mem)){
+        WARN(0, "%s\n", "Out of memory.\n");
+        close(FD);
+        return 0;
+    }
+    // The ROM's pages straight from the page cache, one copy for every
+    // process; read in a copy if it isn't whole host pages
+    if (!mem_map_file(&cpu->mem, ROM_OFFSET >> 8, FD, cpu->rom_size) &&
+        read(FD, (uint8_t*)cpu->mem.base + ROM_OFFSET, cpu->rom_size) != (ssize_t)cpu->rom_size){
         WARN(0, "%s\n", "ROM_LOAD_FAILED.\n");
+        close(FD);
+        mem_free(&cpu->mem);
         return 0;
-    }// Map invaders.efgh
-    
-    return FD;
+    }
+    close(FD);
+    // Map invaders.efgh
+    map_invaders(&cpu->mem);
+
+    return 1;
 }
 
 uint8_t space_IN(uint8_t port){
@@ -248,24 +321,12 @@ void process_key_event(SDL_KeyboardEvent key_event){
 
 /***** SDL Helpers ***/
 
-void process_SDL_event(cpu_state *cpu, invaders_window *game_window){
+void process_SDL_event(UNUSED cpu_state *cpu, invaders_window *game_window){
     switch (game_window->event.type)
     {
     case SDL_QUIT:
         game_window->quit_event = 1;
         break;
-    case SDL_USEREVENT:
-        /* and now we can call the function we wanted to call in the timer but couldn't because of the multithreading problems */
-        if(game_window->event.user.code == 0){
-            // Pend the Intt based on event
-            cpu->pend_intt |= (uintptr_t)(game_window->event.user.data1);
-            // Update App window at Every Full update
-            if((uintptr_t)(game_window->event.user.data1) == full_2){
-                render_vram(cpu, game_window->pixels);
-                SDL_UpdateWindowSurface(game_window->window);
-            }
-        }
-        break;
     case SDL_KEYDOWN:
         DEBUG_PRINT("Key: %c pressed, isfake: %d.\n", game_window->event.key.keysym.sym, game_window->event.key.repeat);
         if(!game_window->event.key.repeat){
@@ -276,56 +337,40 @@ void process_SDL_event(cpu_state *cpu, invaders_window *game_window){
         DEBUG_PRINT("Key: %c Released.\n", game_window->event.key.keysym.sym);
         process_key_event(game_window->event.key);
         break;
+    case SDL_WINDOWEVENT:
+        // The window lost what was drawn, redraw all of it next frame
+        if(game_window->event.window.event == SDL_WINDOWEVENT_EXPOSED){
+            vram_invalidate(&game_window->vram);
+        }
+        break;
     default:
         DEBUG_PRINT("%s\n", "Unhandled Event!");
     }
 }
 
-uint32_t update_vram_cb(uint32_t interval, UNUSED void *param){
-    static uintptr_t update_state = half_1;
-
-    SDL_Event event;
-    SDL_UserEvent userevent;
-
-    userevent.type = SDL_USEREVENT;
-    userevent.code = 0;
-    userevent.data1 = (void*)update_state;
-
-    event.type = SDL_USEREVENT;
-    event.user = userevent;
-
-    SDL_PushEvent(&event);
+void half_frame_cb(scheduler* sched, cpu_state* cpu, sched_event* event){
+    cpu->pend_intt |= half_1;
+    sched_at(sched, event, event->when + CYCLES_PER_FRAME);
+}
 
-    update_state = update_state == half_1 ? full_2 : half_1; // Toggling state
-    return(interval);
+void full_frame_cb(scheduler* sched, cpu_state* cpu, sched_event* event){
+    invaders_window *game_window = event->ctx;
+    cpu->pend_intt |= full_2;
+    // Update App window at Every Full update
+    render_vram(cpu, game_window);
+    sched_at(sched, event, event->when + CYCLES_PER_FRAME);
 }
 
-void render_vram(cpu_state *cpu, uint32_t *pixels){
-    uint32_t pix_index = 0;
-    uintptr_t vram_start = (uintptr_t)mem_ref(&cpu->mem, VRAM_OFFSET);
-    uintptr_t vram_end = vram_start + VRAM_SIZE;
-    uint8_t vram_data;
-    
-    // Inflate
-    static uint32_t temp_buff[WINDOW_WIDTH*WINDOW_HEIGHT];
-    for(;vram_start < vram_end; vram_start++){
-        vram_data = *(uint8_t*)(vram_start);
-        temp_buff[pix_index++] = (vram_data & 0x1) ? GREEN_PIXEL : BLACK_PIXEL;
-        temp_buff[pix_index++] = (vram_data & 0x2) >> 1 ? GREEN_PIXEL : BLACK_PIXEL;
-        temp_buff[pix_index++] = (vram_data & 0x4) >> 2 ? GREEN_PIXEL : BLACK_PIXEL;
-        temp_buff[pix_index++] = (vram_data & 0x8) >> 3 ? GREEN_PIXEL : BLACK_PIXEL;
-        temp_buff[pix_index++] = (vram_data & 0x16) >> 4 ? GREEN_PIXEL : BLACK_PIXEL;
-        temp_buff[pix_index++] = (vram_data & 0x32) >> 5 ? GREEN_PIXEL : BLACK_PIXEL;
-        temp_buff[pix_index++] = (vram_data & 0x64) >> 6 ? GREEN_PIXEL : BLACK_PIXEL;
-        temp_buff[pix_index++] = (vram_data & 0x128) >> 7 ? GREEN_PIXEL : BLACK_PIXEL;
+void render_vram(cpu_state *cpu, invaders_window *game_window){
+    vram_rect rects[VRAM_LINES / 2 + 1];
+    SDL_Rect sdl_rects[VRAM_LINES / 2 + 1];
+    uint32_t count = vram_render(&game_window->vram, mem_ref(&cpu->mem, VRAM_OFFSET),
+                                 game_window->pixels, rects);
+    for(uint32_t i = 0; i < count; i++){
+        sdl_rects[i] = (SDL_Rect){.x = rects[i].x, .y = rects[i].y, .w = rects[i].w, .h = rects[i].h};
     }
-
-    // Rotate
-    pix_index = 0;
-    for(int16_t x = (WINDOW_WIDTH - 1); x >= 0 ; x--){
-        for(uint16_t y = 0; y < WINDOW_HEIGHT; y++){
-            pixels[pix_index++] = temp_buff[x + (y * WINDOW_WIDTH)];
-        }
+    if(count){
+        SDL_UpdateWindowSurfaceRects(game_window->window, sdl_rects, count);
     }
 }
 
@@ -337,8 +382,8 @@ invaders_window* init_game_window(){
     
     invaders_window* game_window = (invaders_window*)calloc(1, sizeof(invaders_window));    // Game Window
 
-    // attempt to initialize graphics and timer system
-    if (SDL_Init(SDL_INIT_VIDEO|SDL_INIT_TIMER) != 0)
+    // attempt to initialize graphics system
+    if (SDL_Init(SDL_INIT_VIDEO) != 0)
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "error initializing SDL: %s\n", SDL_GetError());
         return 0x0;
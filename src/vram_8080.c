@@ -0,0 +1,97 @@
+/**
+ * @file vram_8080.c
+ * @author Pranay Garg (pranayga@andrew.cmu.edu)
+ * @brief Incremental renderer for the invaders frame buffer, see vram_8080.h
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+
+#include <string.h>
+#include "vram_8080.h"
+
+void vram_invalidate(vram_tracker* vt){
+    vt->primed = 0;
+}
+
+uint32_t vram_mark(vram_tracker* vt, const uint8_t* vram){
+    uint32_t marked = 0;
+    for(uint32_t line = 0; line < VRAM_LINES; line++){
+        uint32_t at = line * VRAM_LINE_SIZE;
+        if(!vt->primed || memcmp(&vram[at], &vt->shown[at], VRAM_LINE_SIZE)){
+            vt->dirty[line >> 3] |= 1 << (line & 7);
+            marked++;
+        }
+    }
+    return marked;
+}
+
+/**
+ * @brief Expands bytes lo to hi of a scan line into its column of the
+ * upright pixels, bit 0 of byte 0 at the bottom
+ *
+ * @param pixels
+ * @param line
+ * @param bytes the scan line
+ * @param lo
+ * @param hi
+ */
+static void vram_draw(uint32_t* pixels, uint32_t line, const uint8_t* bytes, uint32_t lo, uint32_t hi){
+    for(uint32_t b = lo; b <= hi; b++){
+        for(uint32_t bit = 0; bit < 8; bit++){
+            uint32_t row = VRAM_LINE_BITS - 1 - (b * 8 + bit);
+            pixels[row * VRAM_LINES + line] = (bytes[b] >> bit) & 1 ? GREEN_PIXEL : BLACK_PIXEL;
+        }
+    }
+}
+
+uint32_t vram_render(vram_tracker* vt, const uint8_t* vram, uint32_t* pixels, vram_rect* rects){
+    vram_mark(vt, vram);
+    uint32_t count = 0;
+    vram_rect* run = NULL;
+    for(uint32_t line = 0; line < VRAM_LINES; line++){
+        uint8_t bit = 1 << (line & 7);
+        if(!(vt->dirty[line >> 3] & bit)){
+            run = NULL;
+            continue;
+        }
+        vt->dirty[line >> 3] &= ~bit;
+
+        // Only the span of bytes which changed, all of them on a first draw
+        const uint8_t* bytes = &vram[line * VRAM_LINE_SIZE];
+        uint8_t* shown = &vt->shown[line * VRAM_LINE_SIZE];
+        uint32_t lo = 0, hi = VRAM_LINE_SIZE - 1;
+        if(vt->primed){
+            while(lo < VRAM_LINE_SIZE && bytes[lo] == shown[lo]){
+                lo++;
+            }
+            if(lo == VRAM_LINE_SIZE){
+                // Marked, then changed back
+                run = NULL;
+                continue;
+            }
+            while(bytes[hi] == shown[hi]){
+                hi--;
+            }
+        }
+        vram_draw(pixels, line, bytes, lo, hi);
+        memcpy(&shown[lo], &bytes[lo], hi - lo + 1);
+        vt->lines_drawn++;
+        vt->bytes_drawn += hi - lo + 1;
+
+        int32_t top = VRAM_LINE_BITS - (hi + 1) * 8;
+        int32_t bottom = VRAM_LINE_BITS - lo * 8;
+        if(run){
+            int32_t run_bottom = run->y + run->h;
+            run->y = top < run->y ? top : run->y;
+            run->h = (bottom > run_bottom ? bottom : run_bottom) - run->y;
+            run->w++;
+        } else {
+            run = &rects[count++];
+            *run = (vram_rect){.x = line, .y = top, .w = 1, .h = bottom - top};
+        }
+    }
+    vt->primed = 1;
+    vt->frames++;
+    return count;
+}